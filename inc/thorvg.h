@@ -3,7 +3,7 @@
  *
  * The main APIs enabling the TVG initialization, preparation of the canvas and provisioning of its content:
  * - drawing shapes such as line, curve, arc, rectangle, circle or user-defined
- * - drawing pictures - SVG, PNG, RAW
+ * - drawing pictures - SVG, PNG, JPG, RAW
  * - solid or gradient filling
  * - continuous and dashed stroking
  * - clipping and masking
@@ -806,6 +806,24 @@ public:
      */
     Result stroke(const float* dashPattern, uint32_t cnt) noexcept;
 
+    /**
+     * @brief Sets the dash pattern of the stroke and the distance into the pattern at which the dashing starts.
+     *
+     * @param[in] dashPattern The array of consecutive pair values of the dash length and the gap length.
+     * @param[in] cnt The length of the @p dashPattern array.
+     * @param[in] offset The distance into the dash pattern at which each sub-path starts. It can be negative.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::FailedAllocation An internal error with a memory allocation for an object to be dashed.
+     * @retval Result::InvalidArguments In case a @c nullptr is passed as the @p dashPattern,
+     *         the given length of the array is less than two or any of the @p dashPattern values is zero or less.
+     *
+     * @note Changing the @p offset over the frames moves the dashes along the path, only the stroke is updated.
+     *
+     * @BETA_API
+     */
+    Result stroke(const float* dashPattern, uint32_t cnt, float offset) noexcept;
+
     /**
      * @brief Sets the cap style of the stroke in the open sub-paths.
      *
@@ -943,6 +961,18 @@ public:
      */
     uint32_t strokeDash(const float** dashPattern) const noexcept;
 
+    /**
+     * @brief Gets the dash pattern of the stroke and its offset.
+     *
+     * @param[out] dashPattern The pointer to the memory, where the dash pattern array is stored.
+     * @param[out] offset The distance into the dash pattern at which each sub-path starts.
+     *
+     * @return The length of the @p dashPattern array.
+     *
+     * @BETA_API
+     */
+    uint32_t strokeDash(const float** dashPattern, float* offset) const noexcept;
+
     /**
      * @brief Gets the cap style used for stroking the path.
      *
@@ -971,7 +1001,7 @@ public:
 /**
  * @class Picture
  *
- * @brief A class representing an image read in one of the supported formats: raw, svg, png and etc.
+ * @brief A class representing an image read in one of the supported formats: raw, svg, png, jpg and etc.
  * Besides the methods inherited from the Paint, it provides  methods to load & draw images on the canvas.
  *
  * @note Supported formats are depended on the available TVG loaders.
@@ -996,6 +1026,48 @@ public:
      */
     Result load(const std::string& path) noexcept;
 
+    /**
+     * @brief Loads a picture data from a file asynchronously and notifies when it's done.
+     *
+     * The function returns right after the file header is verified. The picture data is loaded in a worker thread,
+     * then @p func is called from that thread with the loading result.
+     * The picture can be drawn without waiting for the callback, but the first update will block until the loading is finished.
+     *
+     * @param[in] path A path to the picture file.
+     * @param[in] func The function called once the loading is finished.
+     *                 The result is Result::Success on success, Result::InsufficientCondition if it's canceled, Result::Unknown otherwise.
+     * @param[in] data The user data passed to @p func.
+     *
+     * @retval Result::Success When the loading is started.
+     * @retval Result::InvalidArguments In case the @p path is empty or no @p func is given.
+     * @retval Result::NonSupport When trying to load a file with an unknown extension.
+     * @retval Result::Unknown If an error occurs at a later stage.
+     *
+     * @note If no thread is assigned, the loading is done in place and @p func is called before this function returns.
+     * @warning Don't load another data or destroy the picture in @p func.
+     * @see Initializer::init()
+     * @see cancel()
+     *
+     * @BETA_API
+     */
+    Result load(const std::string& path, void (*func)(Picture* picture, Result result, void* data), void* data = nullptr) noexcept;
+
+    /**
+     * @brief Requests to stop the ongoing loading.
+     *
+     * The loading stops at the next element of the document, the callback of the loading is called with Result::InsufficientCondition.
+     * This function doesn't wait for the loading to stop, the picture stays empty.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition If nothing is loaded or the loading can't be canceled.
+     *
+     * @note Only the SVG and TVG loadings can be canceled, the images are decoded at once.
+     *       The pictures loaded by load(const std::string&) share their result and can't be canceled.
+     *
+     * @BETA_API
+     */
+    Result cancel() noexcept;
+
     /**
      * @brief Loads a picture data from a memory block of a given size.
      *
@@ -1046,6 +1118,21 @@ public:
      */
     const uint32_t* data() const noexcept;
 
+    /**
+     * @brief Gets the pixels information of the picture and the size of the pixel buffer.
+     *
+     * The pixels are always in the full image size. A picture drawn downscaled may hold its pixels in a reduced level of detail,
+     * then the full size pixels are decoded again on this request.
+     *
+     * @param[out] w The width of the pixel buffer, the image width.
+     * @param[out] h The height of the pixel buffer, the image height.
+     *
+     * @warning Please do not use it, this API is not official one. It could be modified in the next version.
+     *
+     * @BETA_API
+     */
+    const uint32_t* data(uint32_t* w, uint32_t* h) const noexcept;
+
     /**
      * @brief Set paint for the picture.
      *
@@ -1191,6 +1278,19 @@ public:
         Individual   ///< Allocate designated memory pool that is only used by current instance.
     };
 
+    /**
+     * @brief Enumeration specifying the coverage engines of the rasterizer.
+     *
+     * @BETA_API
+     */
+    enum RasterizerPolicy
+    {
+        Auto = 0,    ///< The engine is chosen for each path by the density of its edges.
+        Cells,       ///< Sparse cells of the edges, swept row by row. It's the fastest for the simple paths.
+        Accumulation, ///< An accumulation buffer of the path region, summed row by row. It suits the complex paths with many overlapping edges.
+        Aliased       ///< No anti-aliasing. Every pixel the path touches is fully covered, as the binary masks and the hit-test maps need.
+    };
+
     /**
      * @brief Sets the target buffer for the rasterization.
      *
@@ -1236,6 +1336,49 @@ public:
     */
     Result mempool(MempoolPolicy policy) noexcept;
 
+    /**
+     * @brief Sets the flatness tolerance of the curves in the canvas.
+     *
+     * The curves are approximated with the lines and the pieces of the strokes before the rasterization.
+     * The tolerance is the distance in pixels of the output the approximation may deviate from the exact curves,
+     * so the small drawings need less pieces than the big ones. A bigger value is faster but less smooth.
+     *
+     * @param[in] tolerance The maximum deviation in pixels. The default value is 1/6.
+     *                      The values finer than 1/64, the sub-pixel precision, are clamped to it.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InvalidArguments In case the @p tolerance is not a positive finite number.
+     * @retval Result::MemoryCorruption When casting in the internal function implementation failed.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @note The paints of the canvas are updated with the new tolerance by the next Canvas::update().
+     *
+     * @BETA_API
+    */
+    Result flatness(float tolerance) noexcept;
+
+    /**
+     * @brief Sets the coverage engine of the rasterizer in the canvas.
+     *
+     * Both engines produce the same coverages within the rounding error, they differ in the speed only.
+     * The cells are cheap for the simple paths, but they get slow when many edges cross the same rows.
+     * The accumulation buffer costs the area of the path region, regardless of the number of the edges.
+     * The aliased engine skips the coverages: it fills the pixels the paths touch, the clip paths and the masks
+     * of the canvas included, and it's faster than the others.
+     *
+     * @param[in] policy The coverage engine. The default value is RasterizerPolicy::Auto.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InvalidArguments In case the @p policy is not one of the RasterizerPolicy.
+     * @retval Result::MemoryCorruption When casting in the internal function implementation failed.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @note The paints of the canvas are updated with the new engine by the next Canvas::update().
+     *
+     * @BETA_API
+    */
+    Result rasterizer(RasterizerPolicy policy) noexcept;
+
     /**
      * @brief Creates a new SwCanvas object.
      * @return A new SwCanvas object.
@@ -1328,6 +1471,60 @@ public:
      */
     static Result term(CanvasEngine engine) noexcept;
 
+    /**
+     * @brief Sets the memory budget of the cache sharing the files loaded by Picture::load(const std::string&).
+     *
+     * Pictures loading the same unmodified file share its loaded result. The least recently used results are released
+     * once their estimated memory usage exceeds the budget. The default budget is 32 MB.
+     *
+     * @param[in] bytes The budget in bytes. Zero disables the cache, every picture loads its own file.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition In case the engines are not initialized.
+     *
+     * @warning Please do not use it, this API is not official one. It could be modified in the next version.
+     *
+     * @BETA_API
+     */
+    static Result cache(size_t bytes) noexcept;
+
+    /**
+     * @brief Gets the statistics of the cache sharing the loaded files.
+     *
+     * @param[out] hits The number of loads served by the cache.
+     * @param[out] misses The number of loads that read the file.
+     * @param[out] bytes The estimated memory usage of the cached results in bytes.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition In case the engines are not initialized.
+     *
+     * @note Any of the arguments can be @c nullptr if not needed.
+     * @warning Please do not use it, this API is not official one. It could be modified in the next version.
+     *
+     * @BETA_API
+     */
+    static Result cache(uint32_t* hits, uint32_t* misses, size_t* bytes) noexcept;
+
+    /**
+     * @brief Sets the directory keeping the parsed SVG documents for their next loadings.
+     *
+     * An SVG document loaded again, in this or in a later process, skips the parsing and the styling by reading
+     * its resolved document from the directory. The entries of the other versions or the broken ones are ignored,
+     * the document is parsed and written again. The cache is disabled by default.
+     *
+     * @param[in] path An existing directory to keep the files in. An empty path disables the cache.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition In case the engines are not initialized.
+     * @retval Result::NonSupport In case the SVG loader is not supported.
+     *
+     * @note The files are not protected against tampering, the directory must be trusted.
+     * @warning Please do not use it, this API is not official one. It could be modified in the next version.
+     *
+     * @BETA_API
+     */
+    static Result cache(const std::string& path) noexcept;
+
     _TVG_DISABLE_CTOR(Initializer);
 };
 
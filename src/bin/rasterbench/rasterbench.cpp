@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <thorvg.h>
+
+using namespace std;
+
+#define WIDTH 1024
+#define HEIGHT 1024
+
+
+struct Bench
+{
+    uint32_t buffer[WIDTH * HEIGHT];
+
+    //Draws the same picture with each coverage engine of the rasterizer, and reports the best times of them.
+    //The aliased one has no anti-aliasing, it shows the cost of the binary masks.
+    bool run(const char* path, uint32_t iterations)
+    {
+        const tvg::SwCanvas::RasterizerPolicy policies[] = {tvg::SwCanvas::Cells, tvg::SwCanvas::Accumulation, tvg::SwCanvas::Auto, tvg::SwCanvas::Aliased};
+        double best[4] = {0, 0, 0, 0};
+
+        for (uint32_t i = 0; i < iterations; ++i) {
+            for (uint32_t p = 0; p < 4; ++p) {
+                auto canvas = tvg::SwCanvas::gen();
+                if (canvas->target(buffer, WIDTH, WIDTH, HEIGHT, tvg::SwCanvas::ARGB8888) != tvg::Result::Success) return false;
+                if (canvas->rasterizer(policies[p]) != tvg::Result::Success) return false;
+
+                auto picture = tvg::Picture::gen();
+                if (picture->load(path) != tvg::Result::Success) {
+                    cout << "Failed to load : " << path << endl;
+                    return false;
+                }
+                picture->size(WIDTH, HEIGHT);
+
+                auto begin = chrono::steady_clock::now();
+                canvas->push(move(picture));
+                canvas->draw();
+                canvas->sync();
+                auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+                if (i == 0 || elapsed < best[p]) best[p] = elapsed;
+            }
+        }
+
+        printf("%-40s cells %9.3f ms  accumulation %9.3f ms  auto %9.3f ms  aliased %9.3f ms\n", path, best[0] * 1000.0, best[1] * 1000.0, best[2] * 1000.0, best[3] * 1000.0);
+
+        return true;
+    }
+};
+
+
+static int help()
+{
+    cout << "Usage: \n   rasterbench [-n iterations] [svgFileName...]\n\nExamples: \n    $ rasterbench input.svg\n    $ rasterbench -n 10 tiger.svg gallardo.svg\n\n";
+    return 1;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 5;
+    int first = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        iterations = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || iterations == 0) return help();
+
+    if (tvg::Initializer::init(tvg::CanvasEngine::Sw, 0) != tvg::Result::Success) {
+        cout << "engine is not supported" << endl;
+        return 1;
+    }
+
+    auto bench = static_cast<Bench*>(malloc(sizeof(Bench)));
+    auto ret = 0;
+
+    for (int i = first; i < argc; ++i) {
+        if (!bench->run(argv[i], iterations)) ret = 1;
+    }
+
+    free(bench);
+
+    tvg::Initializer::term(tvg::CanvasEngine::Sw);
+
+    return ret;
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <thorvg.h>
+
+using namespace std;
+
+#define WIDTH 1024
+#define HEIGHT 1024
+
+
+struct Bench
+{
+    uint32_t buffer[WIDTH * HEIGHT];
+
+    //Draws the same path with the thin line rasterizer and the general stroker, and reports the best times of each.
+    //The thin lines are drawn by the stroker if the join is miter, so that is the only difference of the two.
+    bool run(const char* name, uint32_t scene, uint32_t segments, float width, uint32_t iterations)
+    {
+        auto canvas = tvg::SwCanvas::gen();
+        if (canvas->target(buffer, WIDTH, WIDTH, HEIGHT, tvg::SwCanvas::ARGB8888) != tvg::Result::Success) return false;
+
+        double best[2] = {0, 0};
+
+        for (uint32_t i = 0; i < 2 * iterations; ++i) {
+            auto stroker = (i % 2 == 1);
+            auto shape = tvg::Shape::gen();
+            path(shape.get(), scene, segments);
+            shape->stroke(width);
+            shape->stroke(255, 255, 255, 255);
+            shape->stroke(tvg::StrokeCap::Butt);
+            shape->stroke(stroker ? tvg::StrokeJoin::Miter : tvg::StrokeJoin::Bevel);
+
+            auto begin = chrono::steady_clock::now();
+            canvas->push(move(shape));
+            canvas->draw();
+            canvas->sync();
+            auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+            canvas->clear();
+
+            if (i < 2 || elapsed < best[stroker]) best[stroker] = elapsed;
+        }
+
+        printf("%-10s %8u segs  width %4.2f  thin %9.3f ms  stroker %9.3f ms  x%.1f\n", name, segments, width, best[0] * 1000.0, best[1] * 1000.0, best[1] / best[0]);
+
+        return true;
+    }
+
+private:
+    void path(tvg::Shape* shape, uint32_t scene, uint32_t segments)
+    {
+        srand(segments);
+
+        switch (scene) {
+            //Lines from the center
+            case 0: {
+                for (uint32_t i = 0; i < segments; ++i) {
+                    auto angle = i * 6.2831853f / segments;
+                    shape->moveTo(WIDTH / 2, HEIGHT / 2);
+                    shape->lineTo(WIDTH / 2 + (WIDTH / 2 - 16) * cosf(angle), HEIGHT / 2 + (HEIGHT / 2 - 16) * sinf(angle));
+                }
+                break;
+            }
+            //A chart like polyline
+            case 1: {
+                shape->moveTo(0, HEIGHT / 2);
+                for (uint32_t i = 1; i <= segments; ++i) {
+                    shape->lineTo(float(i * WIDTH) / segments, HEIGHT / 2 + (rand() % (HEIGHT / 2)) - HEIGHT / 4);
+                }
+                break;
+            }
+            //Curves
+            default: {
+                for (uint32_t i = 0; i < segments; ++i) {
+                    shape->moveTo(rand() % WIDTH, rand() % HEIGHT);
+                    shape->cubicTo(rand() % WIDTH, rand() % HEIGHT, rand() % WIDTH, rand() % HEIGHT, rand() % WIDTH, rand() % HEIGHT);
+                }
+                break;
+            }
+        }
+    }
+};
+
+
+static int help()
+{
+    cout << "Usage: \n   strokebench [-n iterations] [segments...]\n\nExamples: \n    $ strokebench\n    $ strokebench -n 10 500 5000\n\n";
+    return 1;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 5;
+    int first = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        iterations = atoi(argv[2]);
+        first = 3;
+    }
+    if (iterations == 0) return help();
+
+    vector<uint32_t> segments;
+    for (int i = first; i < argc; ++i) {
+        auto cnt = atoi(argv[i]);
+        if (cnt <= 0) return help();
+        segments.push_back(cnt);
+    }
+    if (segments.empty()) segments = {1000, 10000};
+
+    if (tvg::Initializer::init(tvg::CanvasEngine::Sw, 0) != tvg::Result::Success) {
+        cout << "engine is not supported" << endl;
+        return 1;
+    }
+
+    auto bench = static_cast<Bench*>(malloc(sizeof(Bench)));
+    const char* names[] = {"lines", "polyline", "curves"};
+    auto ret = 0;
+
+    for (auto cnt : segments) {
+        for (uint32_t scene = 0; scene < 3; ++scene) {
+            for (auto width : {0.5f, 1.0f, 1.5f}) {
+                //The curves are a lot longer than the lines.
+                if (!bench->run(names[scene], scene, (scene == 2) ? (cnt / 10 + 1) : cnt, width, iterations)) ret = 1;
+            }
+        }
+    }
+
+    free(bench);
+
+    tvg::Initializer::term(tvg::CanvasEngine::Sw);
+
+    return ret;
+}
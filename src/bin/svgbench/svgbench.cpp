@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020-2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <thorvg.h>
+
+using namespace std;
+
+
+struct Bench
+{
+    //Loads the file over and over and reports the loading throughput.
+    //The engine runs without worker threads so that the whole parsing is done inside Picture::load().
+    bool run(const char* path, uint32_t iterations)
+    {
+        auto size = fileSize(path);
+        if (size == 0) {
+            cout << "Failed to open : " << path << endl;
+            return false;
+        }
+
+        double total = 0, best = 0;
+
+        for (uint32_t i = 0; i < iterations; ++i) {
+            auto picture = tvg::Picture::gen();
+
+            auto begin = chrono::steady_clock::now();
+            if (picture->load(path) != tvg::Result::Success) {
+                cout << "Failed to load : " << path << endl;
+                return false;
+            }
+            auto elapsed = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+
+            total += elapsed;
+            if (i == 0 || elapsed < best) best = elapsed;
+        }
+
+        auto mb = size / (1024.0 * 1024.0);
+        printf("%-40s %10.1f KB  avg %8.3f ms %8.1f MB/s  best %8.3f ms %8.1f MB/s\n", path, size / 1024.0, total * 1000.0 / iterations, mb * iterations / total, best * 1000.0, mb / best);
+
+        return true;
+    }
+
+private:
+    long fileSize(const char* path)
+    {
+        auto fp = fopen(path, "rb");
+        if (!fp) return 0;
+        fseek(fp, 0, SEEK_END);
+        auto size = ftell(fp);
+        fclose(fp);
+        return size > 0 ? size : 0;
+    }
+};
+
+
+static int help()
+{
+    cout << "Usage: \n   svgbench [-n iterations] [svgFileName...]\n\nExamples: \n    $ svgbench input.svg\n    $ svgbench -n 100 tiger.svg gallardo.svg\n\n";
+    return 1;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = 20;
+    int first = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-n")) {
+        iterations = atoi(argv[2]);
+        first = 3;
+    }
+    if (first >= argc || iterations == 0) return help();
+
+    if (tvg::Initializer::init(tvg::CanvasEngine::Sw, 0) != tvg::Result::Success) {
+        cout << "engine is not supported" << endl;
+        return 1;
+    }
+
+    Bench bench;
+    auto ret = 0;
+    for (int i = first; i < argc; ++i) {
+        if (!bench.run(argv[i], iterations)) ret = 1;
+    }
+
+    tvg::Initializer::term(tvg::CanvasEngine::Sw);
+
+    return ret;
+}
@@ -11,7 +11,7 @@
 * - scene graph & affine transformation (translation, rotation, scale, ...)
 * - stroking: width, join, cap, dash
 * - composition: blending, masking, path clipping
-* - pictures: SVG, PNG, bitmap
+* - pictures: SVG, PNG, JPG, bitmap
 *
 * @BETA_API
 */
@@ -1219,6 +1219,41 @@ TVG_EXPORT Tvg_Result tvg_shape_set_stroke_dash(Tvg_Paint* paint, const float* d
 TVG_EXPORT Tvg_Result tvg_shape_get_stroke_dash(const Tvg_Paint* paint, const float** dashPattern, uint32_t* cnt);
 
 
+/*!
+* \brief Sets the distance into the dash pattern at which each sub-path of the stroke starts.
+*
+* Changing the offset over the frames moves the dashes along the path, only the stroke is updated.
+*
+* \param[in] paint A Tvg_Paint pointer to the shape object.
+* \param[in] offset The distance into the dash pattern. It can be negative.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INVALID_ARGUMENT An invalid Tvg_Paint pointer.
+* \retval TVG_RESULT_INSUFFICIENT_CONDITION No dash pattern is set.
+*
+* \see tvg_shape_set_stroke_dash()
+*
+* @BETA_API
+*/
+TVG_EXPORT Tvg_Result tvg_shape_set_stroke_dash_offset(Tvg_Paint* paint, float offset);
+
+
+/*!
+* \brief Gets the distance into the dash pattern at which each sub-path of the stroke starts.
+*
+* \param[in] paint A Tvg_Paint pointer to the shape object.
+* \param[out] offset The distance into the dash pattern.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INVALID_ARGUMENT An invalid pointer passed as an argument.
+*
+* @BETA_API
+*/
+TVG_EXPORT Tvg_Result tvg_shape_get_stroke_dash_offset(const Tvg_Paint* paint, float* offset);
+
+
 /*!
 * \brief Sets the cap style used for stroking the path.
 *
@@ -1626,7 +1661,7 @@ TVG_EXPORT Tvg_Result tvg_gradient_del(Tvg_Gradient* grad);
 /**
 * \defgroup ThorVGCapi_Picture Picture
 *
-* \brief A module enabling to create and to load an image in one of the supported formats: svg, png and raw.
+* \brief A module enabling to create and to load an image in one of the supported formats: svg, png, jpg and raw.
 *
 *
 * \{
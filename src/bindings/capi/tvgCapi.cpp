@@ -358,6 +358,25 @@ TVG_EXPORT Tvg_Result tvg_shape_get_stroke_dash(const Tvg_Paint* paint, const fl
 }
 
 
+TVG_EXPORT Tvg_Result tvg_shape_set_stroke_dash_offset(Tvg_Paint* paint, float offset)
+{
+    if (!paint) return TVG_RESULT_INVALID_ARGUMENT;
+    auto shape = reinterpret_cast<Shape*>(paint);
+    const float* dashPattern = nullptr;
+    auto cnt = shape->strokeDash(&dashPattern);
+    if (cnt == 0) return TVG_RESULT_INSUFFICIENT_CONDITION;
+    return (Tvg_Result) shape->stroke(dashPattern, cnt, offset);
+}
+
+
+TVG_EXPORT Tvg_Result tvg_shape_get_stroke_dash_offset(const Tvg_Paint* paint, float* offset)
+{
+    if (!paint || !offset) return TVG_RESULT_INVALID_ARGUMENT;
+    reinterpret_cast<Shape*>(CCP(paint))->strokeDash(nullptr, offset);
+    return TVG_RESULT_SUCCESS;
+}
+
+
 TVG_EXPORT Tvg_Result tvg_shape_set_stroke_cap(Tvg_Paint* paint, Tvg_Stroke_Cap cap)
 {
     if (!paint) return TVG_RESULT_INVALID_ARGUMENT;
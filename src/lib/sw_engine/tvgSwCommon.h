@@ -45,10 +45,14 @@ static double timeStamp()
 #define SW_ANGLE_2PI (SW_ANGLE_PI << 1)
 #define SW_ANGLE_PI2 (SW_ANGLE_PI >> 1)
 #define SW_ANGLE_PI4 (SW_ANGLE_PI >> 2)
+#define SW_FLATNESS (1.0f / 6.0f)
 
-using SwCoord = signed long;
+using SwCoord = int32_t;
 using SwFixed = signed long long;
 
+//The coordinates are saturated in this range(26.6), so the rasterizer's upscaled ones and their differences stay in 32 bits.
+#define SW_COORD_LIMIT (1 << 26)
+
 struct SwPoint
 {
     SwCoord x, y;
@@ -95,6 +99,15 @@ struct SwPoint
 
 };
 
+//Coverage engines of the rasterizer
+enum class SwRasterizer : uint8_t
+{
+    Auto = 0,       //picked by the density of the edges
+    Cells,          //sparse cells of the edges, for the simple paths
+    Accumulation,   //accumulation buffer of the region, for the complex paths
+    Aliased         //no coverages, the touched pixels are filled. for the binary masks and the hit maps
+};
+
 struct SwSize
 {
     SwCoord w, h;
@@ -193,6 +206,9 @@ struct SwStroke
 
     float sx, sy;
 
+    float flatness;         //curve flatness tolerance in pixels
+    SwFixed angleLimit;     //turn of the curve pieces offset at once
+
     bool firstPt;
     bool openSubPath;
     bool handleWideStrokes;
@@ -206,6 +222,8 @@ struct SwDashStroke
     Point ptStart;
     Point ptCur;
     float* pattern;
+    float period;
+    float tolerance;        //curve flatness tolerance in the user space
     uint32_t cnt;
     bool curOpGap;
 };
@@ -220,6 +238,7 @@ struct SwShape
     SwBBox       bbox;   //keep it boundary without stroke region. Using for optimal filling.
 
     bool         rect;   //Fast Track: Othogonal rectangle?
+    bool         clipped;   //The outline is pre-clipped for filling, not for stroking.
 };
 
 struct SwImage
@@ -228,6 +247,7 @@ struct SwImage
     SwRleData*   rle = nullptr;
     uint32_t*    data = nullptr;
     uint32_t     w, h;
+    float        scale = 1.0f;      //pixels per a picture unit, below 1 for a reduced level of detail
 };
 
 struct SwBlender
@@ -257,12 +277,19 @@ struct SwMpool
 {
     SwOutline* outline = nullptr;
     SwOutline* strokeOutline = nullptr;
+    SwOutline* dashOutline = nullptr;
     unsigned allocSize = 0;
 };
 
+static inline SwCoord SATURATE_SWCOORD(float val)
+{
+    if (val > -SW_COORD_LIMIT && val < SW_COORD_LIMIT) return SwCoord(val);
+    return (val > 0) ? SW_COORD_LIMIT : -SW_COORD_LIMIT;   //nan as well
+}
+
 static inline SwCoord TO_SWCOORD(float val)
 {
-    return SwCoord(val * 64);
+    return SATURATE_SWCOORD(val * 64);
 }
 
 static inline uint32_t ALPHA_BLEND(uint32_t c, uint32_t a)
@@ -299,18 +326,19 @@ SwFixed mathSin(SwFixed angle);
 void mathSplitCubic(SwPoint* base);
 SwFixed mathDiff(SwFixed angle1, SwFixed angle2);
 SwFixed mathLength(const SwPoint& pt);
-bool mathSmallCubic(const SwPoint* base, SwFixed& angleIn, SwFixed& angleMid, SwFixed& angleOut);
+bool mathSmallCubic(const SwPoint* base, SwFixed& angleIn, SwFixed& angleMid, SwFixed& angleOut, SwFixed limit);
 SwFixed mathMean(SwFixed angle1, SwFixed angle2);
 SwPoint mathTransform(const Point* to, const Matrix* transform);
+bool mathTransformPoints(const Point* pts, uint32_t cnt, const Matrix* transform, const SwBBox& box, SwPoint* out);
 bool mathUpdateOutlineBBox(const SwOutline* outline, const SwBBox& clipRegion, SwBBox& renderRegion);
 
 void shapeReset(SwShape* shape);
 bool shapePrepare(SwShape* shape, const Shape* sdata, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid);
 bool shapePrepared(const SwShape* shape);
-bool shapeGenRle(SwShape* shape, const Shape* sdata, bool antiAlias, bool hasComposite);
+bool shapeGenRle(SwShape* shape, const Shape* sdata, const RenderPrimitive* primitive, const Matrix* transform, bool antiAlias, bool hasComposite, float flatness, SwRasterizer rasterizer);
 void shapeDelOutline(SwShape* shape, SwMpool* mpool, uint32_t tid);
-void shapeResetStroke(SwShape* shape, const Shape* sdata, const Matrix* transform);
-bool shapeGenStrokeRle(SwShape* shape, const Shape* sdata, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid);
+void shapeResetStroke(SwShape* shape, const Shape* sdata, const Matrix* transform, float flatness);
+bool shapeGenStrokeRle(SwShape* shape, const Shape* sdata, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid, SwRasterizer rasterizer);
 void shapeFree(SwShape* shape);
 void shapeDelStroke(SwShape* shape);
 bool shapeGenFillColors(SwShape* shape, const Fill* fill, const Matrix* transform, SwSurface* surface, uint32_t opacity, bool ctable);
@@ -320,7 +348,7 @@ void shapeResetStrokeFill(SwShape* shape);
 void shapeDelFill(SwShape* shape);
 void shapeDelStrokeFill(SwShape* shape);
 
-void strokeReset(SwStroke* stroke, const Shape* shape, const Matrix* transform);
+void strokeReset(SwStroke* stroke, const Shape* shape, const Matrix* transform, float flatness);
 bool strokeParseOutline(SwStroke* stroke, const SwOutline& outline);
 SwOutline* strokeExportOutline(SwStroke* stroke, SwMpool* mpool, unsigned tid);
 void strokeFree(SwStroke* stroke);
@@ -338,7 +366,9 @@ void fillFree(SwFill* fill);
 void fillFetchLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len);
 void fillFetchRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len);
 
-SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias);
+SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias, float flatness, SwRasterizer rasterizer);
+SwRleData* rleRenderRoundRect(SwRleData* rle, const Point& min, const Point& max, float rx, float ry, const SwBBox& renderRegion);
+SwRleData* rleRenderHairline(SwRleData* rle, const SwOutline* outline, const SwStroke* stroke, const SwBBox& renderRegion);
 void rleFree(SwRleData* rle);
 void rleReset(SwRleData* rle);
 void rleClipPath(SwRleData *rle, const SwRleData *clip);
@@ -352,6 +382,8 @@ SwOutline* mpoolReqOutline(SwMpool* mpool, unsigned idx);
 void mpoolRetOutline(SwMpool* mpool, unsigned idx);
 SwOutline* mpoolReqStrokeOutline(SwMpool* mpool, unsigned idx);
 void mpoolRetStrokeOutline(SwMpool* mpool, unsigned idx);
+SwOutline* mpoolReqDashOutline(SwMpool* mpool, unsigned idx);
+void mpoolRetDashOutline(SwMpool* mpool, unsigned idx);
 
 bool rasterCompositor(SwSurface* surface);
 bool rasterGradientShape(SwSurface* surface, SwShape* shape, unsigned id);
@@ -59,8 +59,6 @@ static bool _genOutline(SwImage* image, const Picture* pdata, const Matrix* tran
     outline->opened = false;
 
     image->outline = outline;
-    image->w = w;
-    image->h = h;
 
     return true;
 }
@@ -86,7 +84,7 @@ bool imagePrepared(const SwImage* image)
 
 bool imageGenRle(SwImage* image, TVG_UNUSED const Picture* pdata, const SwBBox& renderRegion, bool antiAlias)
 {
-    if ((image->rle = rleRender(image->rle, image->outline, renderRegion, antiAlias))) return true;
+    if ((image->rle = rleRender(image->rle, image->outline, renderRegion, antiAlias, SW_FLATNESS, SwRasterizer::Cells))) return true;
 
     return false;
 }
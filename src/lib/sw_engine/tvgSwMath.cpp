@@ -20,8 +20,13 @@
  * SOFTWARE.
  */
 #include <math.h>
+#include <float.h>
 #include "tvgSwCommon.h"
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 
 /************************************************************************/
 /* Internal Class Implementation                                        */
@@ -207,7 +212,7 @@ SwFixed mathMean(SwFixed angle1, SwFixed angle2)
 }
 
 
-bool mathSmallCubic(const SwPoint* base, SwFixed& angleIn, SwFixed& angleMid, SwFixed& angleOut)
+bool mathSmallCubic(const SwPoint* base, SwFixed& angleIn, SwFixed& angleMid, SwFixed& angleOut, SwFixed limit)
 {
     auto d1 = base[2] - base[3];
     auto d2 = base[1] - base[2];
@@ -253,7 +258,7 @@ bool mathSmallCubic(const SwPoint* base, SwFixed& angleIn, SwFixed& angleMid, Sw
     auto theta1 = abs(mathDiff(angleIn, angleMid));
     auto theta2 = abs(mathDiff(angleMid, angleOut));
 
-    if ((theta1 < (SW_ANGLE_PI / 8)) && (theta2 < (SW_ANGLE_PI / 8))) return true;
+    if ((theta1 < limit) && (theta2 < limit)) return true;
     return false;
 }
 
@@ -442,6 +447,73 @@ SwPoint mathTransform(const Point* to, const Matrix* transform)
 }
 
 
+//Transforms the points at once. False if any of them is beyond the box, then the output is meaningless.
+bool mathTransformPoints(const Point* pts, uint32_t cnt, const Matrix* transform, const SwBBox& box, SwPoint* out)
+{
+    if (cnt == 0) return true;
+
+    //Scaled to the 26.6 in advance, this is exact as the power of two.
+    float m[6] = {64, 0, 0, 0, 64, 0};
+    if (transform) {
+        m[0] = transform->e11 * 64; m[1] = transform->e12 * 64; m[2] = transform->e13 * 64;
+        m[3] = transform->e21 * 64; m[4] = transform->e22 * 64; m[5] = transform->e23 * 64;
+    }
+
+    auto minX = FLT_MAX, minY = FLT_MAX;
+    auto maxX = -FLT_MAX, maxY = -FLT_MAX;
+    auto valid = true;
+    uint32_t i = 0;
+
+#if defined(__SSE2__)
+    //Two points per a round, as (x0, y0, x1, y1)
+    auto c1 = _mm_setr_ps(m[0], m[3], m[0], m[3]);
+    auto c2 = _mm_setr_ps(m[1], m[4], m[1], m[4]);
+    auto c3 = _mm_setr_ps(m[2], m[5], m[2], m[5]);
+    auto vmin = _mm_set1_ps(FLT_MAX);
+    auto vmax = _mm_set1_ps(-FLT_MAX);
+    auto vnan = _mm_setzero_ps();
+
+    for (; i + 2 <= cnt; i += 2) {
+        auto v = _mm_loadu_ps(&pts[i].x);
+        auto xs = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+        auto ys = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+        auto t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, c1), _mm_mul_ps(ys, c2)), c3);
+        vmin = _mm_min_ps(vmin, t);
+        vmax = _mm_max_ps(vmax, t);
+        vnan = _mm_or_ps(vnan, _mm_cmpunord_ps(t, t));
+        //Truncated as the scalar one does. The values beyond the limit are rejected below.
+        _mm_storeu_si128((__m128i*)(out + i), _mm_cvttps_epi32(t));
+    }
+
+    float lo[4], hi[4];
+    _mm_storeu_ps(lo, vmin);
+    _mm_storeu_ps(hi, vmax);
+    minX = lo[0] < lo[2] ? lo[0] : lo[2];
+    minY = lo[1] < lo[3] ? lo[1] : lo[3];
+    maxX = hi[0] > hi[2] ? hi[0] : hi[2];
+    maxY = hi[1] > hi[3] ? hi[1] : hi[3];
+    valid = (_mm_movemask_ps(vnan) == 0);
+#endif
+
+    for (; i < cnt; ++i) {
+        auto tx = pts[i].x * m[0] + pts[i].y * m[1] + m[2];
+        auto ty = pts[i].x * m[3] + pts[i].y * m[4] + m[5];
+        if (tx < minX) minX = tx;
+        if (tx > maxX) maxX = tx;
+        if (ty < minY) minY = ty;
+        if (ty > maxY) maxY = ty;
+        valid &= (tx == tx && ty == ty);
+        if (tx >= -SW_COORD_LIMIT && tx <= SW_COORD_LIMIT && ty >= -SW_COORD_LIMIT && ty <= SW_COORD_LIMIT) out[i] = {SwCoord(tx), SwCoord(ty)};
+    }
+
+    //Not a number, or to be saturated
+    if (!valid || minX < -SW_COORD_LIMIT || minY < -SW_COORD_LIMIT || maxX > SW_COORD_LIMIT || maxY > SW_COORD_LIMIT) return false;
+
+    //The truncation keeps the order, so do the extremes.
+    return (SwCoord(minX) >= box.min.x && SwCoord(maxX) <= box.max.x && SwCoord(minY) >= box.min.y && SwCoord(maxY) <= box.max.y);
+}
+
+
 bool mathUpdateOutlineBBox(const SwOutline* outline, const SwBBox& clipRegion, SwBBox& renderRegion)
 {
     if (!outline) return false;
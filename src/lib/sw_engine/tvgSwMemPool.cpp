@@ -57,6 +57,19 @@ void mpoolRetStrokeOutline(SwMpool* mpool, unsigned idx)
 }
 
 
+SwOutline* mpoolReqDashOutline(SwMpool* mpool, unsigned idx)
+{
+    return &mpool->dashOutline[idx];
+}
+
+
+void mpoolRetDashOutline(SwMpool* mpool, unsigned idx)
+{
+    mpool->dashOutline[idx].cntrsCnt = 0;
+    mpool->dashOutline[idx].ptsCnt = 0;
+}
+
+
 SwMpool* mpoolInit(unsigned threads)
 {
     auto mpool = new SwMpool;
@@ -70,6 +83,9 @@ SwMpool* mpoolInit(unsigned threads)
     mpool->strokeOutline = static_cast<SwOutline*>(calloc(1, sizeof(SwOutline) * threads));
     if (!mpool->strokeOutline) goto err;
 
+    mpool->dashOutline = static_cast<SwOutline*>(calloc(1, sizeof(SwOutline) * threads));
+    if (!mpool->dashOutline) goto err;
+
     mpool->allocSize = threads;
 
     return mpool;
@@ -84,6 +100,11 @@ err:
         free(mpool->strokeOutline);
         mpool->strokeOutline = nullptr;
     }
+
+    if (mpool->dashOutline) {
+        free(mpool->dashOutline);
+        mpool->dashOutline = nullptr;
+    }
     delete(mpool);
     return nullptr;
 }
@@ -128,6 +149,23 @@ bool mpoolClear(SwMpool* mpool)
         }
         p->cntrsCnt = p->reservedCntrsCnt = 0;
         p->ptsCnt = p->reservedPtsCnt = 0;
+
+        p = &mpool->dashOutline[i];
+
+        if (p->cntrs) {
+            free(p->cntrs);
+            p->cntrs = nullptr;
+        }
+        if (p->pts) {
+            free(p->pts);
+            p->pts = nullptr;
+        }
+        if (p->types) {
+            free(p->types);
+            p->types = nullptr;
+        }
+        p->cntrsCnt = p->reservedCntrsCnt = 0;
+        p->ptsCnt = p->reservedPtsCnt = 0;
     }
 
     return true;
@@ -150,6 +188,11 @@ bool mpoolTerm(SwMpool* mpool)
         mpool->strokeOutline = nullptr;
     }
 
+    if (mpool->dashOutline) {
+        free(mpool->dashOutline);
+        mpool->dashOutline = nullptr;
+    }
+
     delete(mpool);
 
     return true;
@@ -1206,11 +1206,22 @@ bool rasterImage(SwSurface* surface, SwImage* image, const Matrix* transform, co
     }
     else invTransform = {1, 0, 0, 0, 1, 0, 0, 0, 1};
 
+    //Reduced level of detail, map into the smaller pixels.
+    auto reduced = (image->scale < 1.0f);
+    if (reduced) {
+        invTransform.e11 *= image->scale;
+        invTransform.e12 *= image->scale;
+        invTransform.e13 *= image->scale;
+        invTransform.e21 *= image->scale;
+        invTransform.e22 *= image->scale;
+        invTransform.e23 *= image->scale;
+    }
+
     auto translucent = _translucent(surface, opacity);
 
     if (image->rle) {
         //Fast track
-        if (_identify(transform)) {
+        if (_identify(transform) && !reduced) {
             //OPTIMIZE ME: Support non transformed image. Only shifted image can use these routines.
             if (translucent) return _rasterTranslucentImageRle(surface, image->rle, image->data, image->w, image->h, opacity);
             return _rasterImageRle(surface, image->rle, image->data, image->w, image->h);
@@ -1221,7 +1232,7 @@ bool rasterImage(SwSurface* surface, SwImage* image, const Matrix* transform, co
     }
     else {
         //Fast track
-        if (_identify(transform)) {
+        if (_identify(transform) && !reduced) {
             //OPTIMIZE ME: Support non transformed image. Only shifted image can use these routines.
             if (translucent) return _rasterTranslucentImage(surface, image->data, image->w, image->h, opacity, bbox);
             else return _rasterImage(surface, image->data, image->w, image->h, bbox);
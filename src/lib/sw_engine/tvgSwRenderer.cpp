@@ -37,6 +37,8 @@ struct SwTask : Task
     Matrix* transform = nullptr;
     SwSurface* surface = nullptr;
     SwMpool* mpool = nullptr;
+    float flatness;                       //curve flatness tolerance in pixels
+    SwRasterizer rasterizer;              //coverage engine of the rasterizer
     RenderUpdateFlag flags = RenderUpdateFlag::None;
     Array<RenderData> clips;
     uint32_t opacity;
@@ -63,6 +65,7 @@ struct SwShapeTask : SwTask
 {
     SwShape shape;
     const Shape* sdata = nullptr;
+    const RenderPrimitive* primitive = nullptr;
     bool cmpStroking;
 
     void run(unsigned tid) override
@@ -101,7 +104,7 @@ struct SwShapeTask : SwTask
                        Thus it turns off antialising in that condition.
                        Also, it shouldn't be dash style. */
                     auto antiAlias = (strokeAlpha == 255 && strokeWidth > 2 && sdata->strokeDash(nullptr) == 0) ? false : true;
-                    if (!shapeGenRle(&shape, sdata, antiAlias, clips.count > 0 ? true : false)) goto err;
+                    if (!shapeGenRle(&shape, sdata, primitive, transform, antiAlias, clips.count > 0 ? true : false, flatness, rasterizer)) goto err;
                     ++addStroking;
                 }
             }
@@ -123,8 +126,8 @@ struct SwShapeTask : SwTask
         //Stroke
         if (flags & (RenderUpdateFlag::Stroke | RenderUpdateFlag::Transform)) {
             if (validStroke) {
-                shapeResetStroke(&shape, sdata, transform);
-                if (!shapeGenStrokeRle(&shape, sdata, transform, clipRegion, bbox, mpool, tid)) goto err;
+                shapeResetStroke(&shape, sdata, transform, flatness);
+                if (!shapeGenStrokeRle(&shape, sdata, transform, clipRegion, bbox, mpool, tid, rasterizer)) goto err;
                 ++addStroking;
 
                 if (auto fill = sdata->strokeFill()) {
@@ -174,10 +177,19 @@ struct SwShapeTask : SwTask
 struct SwImageTask : SwTask
 {
     SwImage image;
+    RenderImage* source = nullptr;
     const Picture* pdata = nullptr;
 
     void run(unsigned tid) override
     {
+        //Decoded here in the level of detail for the transform, off the thread updating the canvas.
+        source->decode(transform);
+        image.data = const_cast<uint32_t*>(source->data);
+        image.w = source->w;
+        image.h = source->h;
+        image.scale = 1.0f / static_cast<float>(1 << source->level);
+        if (!image.data) return;
+
         auto clipRegion = bbox;
 
         //Invisible shape turned to visible by alpha.
@@ -200,7 +212,6 @@ struct SwImageTask : SwTask
                 }
             }
         }
-        image.data = const_cast<uint32_t*>(pdata->data());
     end:
         imageDelOutline(&image, mpool, tid);
     }
@@ -325,6 +336,7 @@ bool SwRenderer::renderImage(RenderData data)
     auto task = static_cast<SwImageTask*>(data);
     task->done();
 
+    if (!task->image.data) return false;
     if (task->opacity == 0) return true;
 
     return rasterImage(surface, &task->image, task->transform, task->bbox, task->opacity);
@@ -423,6 +435,23 @@ bool SwRenderer::mempool(bool shared)
 }
 
 
+bool SwRenderer::flatness(float tolerance)
+{
+    //Finer than the sub-pixel precision is meaningless.
+    if (!(tolerance > 0.0f) || isinf(tolerance)) return false;
+    this->tolerance = (tolerance < 1.0f / 64.0f) ? 1.0f / 64.0f : tolerance;
+    return true;
+}
+
+
+bool SwRenderer::rasterizer(uint32_t policy)
+{
+    if (policy > static_cast<uint32_t>(SwRasterizer::Aliased)) return false;
+    rasterPolicy = policy;
+    return true;
+}
+
+
 Compositor* SwRenderer::target(const RenderRegion& region)
 {
     auto x = region.x;
@@ -566,6 +595,8 @@ void* SwRenderer::prepareCommon(SwTask* task, const RenderTransform* transform,
     task->opacity = opacity;
     task->surface = surface;
     task->mpool = mpool;
+    task->flatness = tolerance;
+    task->rasterizer = static_cast<SwRasterizer>(rasterPolicy);
     task->flags = flags;
     task->bbox.min.x = max(static_cast<SwCoord>(0), static_cast<SwCoord>(vport.x));
     task->bbox.min.y = max(static_cast<SwCoord>(0), static_cast<SwCoord>(vport.y));
@@ -579,20 +610,21 @@ void* SwRenderer::prepareCommon(SwTask* task, const RenderTransform* transform,
 }
 
 
-RenderData SwRenderer::prepare(const Picture& pdata, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags)
+RenderData SwRenderer::prepare(const Picture& pdata, RenderImage* image, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags)
 {
     //prepare task
     auto task = static_cast<SwImageTask*>(data);
     if (!task) {
         task = new SwImageTask;
         if (!task) return nullptr;
+        task->source = image;
         task->pdata = &pdata;
     }
     return prepareCommon(task, transform, opacity, clips, flags);
 }
 
 
-RenderData SwRenderer::prepare(const Shape& sdata, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags)
+RenderData SwRenderer::prepare(const Shape& sdata, const RenderPrimitive* primitive, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags)
 {
     //prepare task
     auto task = static_cast<SwShapeTask*>(data);
@@ -600,12 +632,13 @@ RenderData SwRenderer::prepare(const Shape& sdata, RenderData data, const Render
         task = new SwShapeTask;
         if (!task) return nullptr;
         task->sdata = &sdata;
+        task->primitive = primitive;
     }
     return prepareCommon(task, transform, opacity, clips, flags);
 }
 
 
-SwRenderer::SwRenderer():mpool(globalMpool)
+SwRenderer::SwRenderer():mpool(globalMpool), tolerance(SW_FLATNESS)
 {
 }
 
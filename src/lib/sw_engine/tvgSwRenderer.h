@@ -35,8 +35,8 @@ namespace tvg
 class SwRenderer : public RenderMethod
 {
 public:
-    RenderData prepare(const Shape& shape, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) override;
-    RenderData prepare(const Picture& picture, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) override;
+    RenderData prepare(const Shape& shape, const RenderPrimitive* primitive, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) override;
+    RenderData prepare(const Picture& picture, RenderImage* image, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) override;
     bool preRender() override;
     bool renderShape(RenderData data) override;
     bool renderImage(RenderData data) override;
@@ -50,6 +50,8 @@ public:
     bool sync() override;
     bool target(uint32_t* buffer, uint32_t stride, uint32_t w, uint32_t h, uint32_t cs);
     bool mempool(bool shared);
+    bool flatness(float tolerance);
+    bool rasterizer(uint32_t policy);
 
     Compositor* target(const RenderRegion& region) override;
     bool beginComposite(Compositor* cmp, CompositeMethod method, uint32_t opacity) override;
@@ -68,6 +70,8 @@ private:
     RenderRegion         vport;                       //viewport
 
     bool                 sharedMpool = true;          //memory-pool behavior policy
+    float                tolerance;                   //curve flatness tolerance in pixels
+    uint32_t             rasterPolicy = 0;            //coverage engine of the rasterizer, SwRasterizer
 
     SwRenderer();
     ~SwRenderer();
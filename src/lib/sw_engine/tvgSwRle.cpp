@@ -20,26 +20,40 @@
  * SOFTWARE.
  */
 #include <setjmp.h>
+#include <math.h>
 #include <limits.h>
 #include <memory.h>
 #include <iostream>
 #include "tvgSwCommon.h"
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
+
 /************************************************************************/
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
 constexpr auto MAX_SPANS = 256;
+constexpr auto BAND_SIZE = 40;
 constexpr auto PIXEL_BITS = 8;   //must be at least 6 bits!
 constexpr auto ONE_PIXEL = (1L << PIXEL_BITS);
 
-using Area = long;
+using Area = int32_t;
 
 struct Band
 {
     SwCoord min, max;
 };
 
+//A segment of the outline from pts[from] to pts[to], the cubics have their controls in between.
+struct Edge
+{
+    uint32_t from, to;
+    uint8_t first, last;    //the bands it touches
+    bool cubic;
+};
+
 struct Cell
 {
     SwCoord x;
@@ -72,6 +86,10 @@ struct RleWorker
 
     SwOutline* outline;
 
+    Edge* edges;                //all of the outline is decomposed if null
+    const uint32_t* bandEdges;  //the edges of the current band
+    uint32_t bandEdgesCnt;
+
     SwSpan spans[MAX_SPANS];
     int spansCnt;
     int ySpan;
@@ -87,14 +105,17 @@ struct RleWorker
     Cell** yCells;
     SwCoord yCnt;
 
+    SwCoord flatness;
+
     bool invalid;
     bool antiAlias;
 };
 
 
+//The points off the region may be negative, they are not shifted.
 static inline SwPoint UPSCALE(const SwPoint& pt)
 {
-    return {pt.x << (PIXEL_BITS - 6), pt.y << (PIXEL_BITS - 6)};
+    return {pt.x * (1 << (PIXEL_BITS - 6)), pt.y * (1 << (PIXEL_BITS - 6))};
 }
 
 
@@ -112,13 +133,13 @@ static inline SwCoord TRUNC(const SwCoord x)
 
 static inline SwPoint SUBPIXELS(const SwPoint& pt)
 {
-    return {pt.x << PIXEL_BITS, pt.y << PIXEL_BITS};
+    return {pt.x * (1 << PIXEL_BITS), pt.y * (1 << PIXEL_BITS)};
 }
 
 
 static inline SwCoord SUBPIXELS(const SwCoord x)
 {
-    return (x << PIXEL_BITS);
+    return x * (1 << PIXEL_BITS);
 }
 
 /*
@@ -360,6 +381,13 @@ static void _moveTo(RleWorker& rw, const SwPoint& to)
 }
 
 
+static inline int64_t _floorDiv(int64_t a, int64_t b)
+{
+    auto q = a / b;
+    return (a % b < 0) ? (q - 1) : q;
+}
+
+
 static void _lineTo(RleWorker& rw, const SwPoint& to)
 {
 #define SW_UDIV(a, b) \
@@ -387,8 +415,9 @@ static void _lineTo(RleWorker& rw, const SwPoint& to)
         e1.x = e2.x;
         _setCell(rw, e1);
     } else if (diff.x == 0) {
-        //vertical line up
+        //vertical line up, the rows out of the band are skipped
         if (diff.y > 0) {
+            if (e1.y < rw.cellMin.y - 1) e1.y = rw.cellMin.y - 1;
             do {
                 f2.y = ONE_PIXEL;
                 rw.cover += (f2.y - f1.y);
@@ -396,9 +425,10 @@ static void _lineTo(RleWorker& rw, const SwPoint& to)
                 f1.y = 0;
                 ++e1.y;
                 _setCell(rw, e1);
-            } while(e1.y != e2.y);
+            } while(e1.y != e2.y && e1.y < rw.cellMax.y);
         //vertical line down
         } else {
+            if (e1.y > rw.cellMax.y) e1.y = rw.cellMax.y;
             do {
                 f2.y = 0;
                 rw.cover += (f2.y - f1.y);
@@ -406,23 +436,49 @@ static void _lineTo(RleWorker& rw, const SwPoint& to)
                 f1.y = ONE_PIXEL;
                 --e1.y;
                 _setCell(rw, e1);
-            } while(e1.y != e2.y);
+            } while(e1.y != e2.y && e1.y >= rw.cellMin.y);
         }
     //any other line
     } else {
-        Area prod = diff.x * f1.y - diff.y * f1.x;
+        //It's beyond the 32 bits when the line is long.
+        int64_t prod = int64_t(diff.x) * f1.y - int64_t(diff.y) * f1.x;
 
         /* These macros speed up repetitive divisions by replacing them
            with multiplications and right shifts. */
         auto dx_r = static_cast<long>(ULONG_MAX >> PIXEL_BITS) / (diff.x);
         auto dy_r = static_cast<long>(ULONG_MAX >> PIXEL_BITS) / (diff.y);
+        auto px = diff.x * ONE_PIXEL;
+        auto py = diff.y * ONE_PIXEL;
+
+        /* The line jumps to the cell where it enters the band, as the walk below would reach it. The rows of
+           the cells are the ranges of prod, prod(k) = prod(0) + k * py for the k-th cell of a row. */
+        if (abs(diff.x) < (1 << 24) && abs(diff.y) < (1 << 24)) {
+            if (diff.y > 0 && e1.y < rw.cellMin.y) {
+                //It leaves the row above up, in (px - py, px].
+                auto top = int64_t(diff.x) * (rw.pos.y - SUBPIXELS(rw.cellMin.y - 1)) - int64_t(diff.y) * f1.x;
+                auto k = _floorDiv(px - top, py);
+                prod = top + k * py - px;
+                f1 = {SW_UDIV(-prod, dy_r), 0};
+                e1 = {e1.x + SwCoord(k), rw.cellMin.y};
+                _setCell(rw, e1);
+            } else if (diff.y < 0 && e1.y >= rw.cellMax.y) {
+                //It leaves the row below down, in [0, -py) to the right or (0, -py] to the left.
+                auto bottom = int64_t(diff.x) * (rw.pos.y - SUBPIXELS(rw.cellMax.y)) - int64_t(diff.y) * f1.x;
+                auto k = _floorDiv((diff.x > 0) ? bottom : (bottom - 1), -py);
+                auto cur = bottom + k * py;
+                if (!(cur <= 0 && cur - px > 0) && !(cur - px + py <= 0 && cur + py >= 0)) {
+                    prod = cur + px;
+                    f1 = {SW_UDIV(cur, -dy_r), ONE_PIXEL};
+                    e1 = {e1.x + SwCoord(k), rw.cellMax.y - 1};
+                    _setCell(rw, e1);
+                }
+            }
+        }
 
         /* The fundamental value `prod' determines which side and the  */
         /* exact coordinate where the line exits current cell.  It is  */
         /* also easily updated when moving from one cell to the next.  */
-        do {
-            auto px = diff.x * ONE_PIXEL;
-            auto py = diff.y * ONE_PIXEL;
+        while (e1 != e2) {
 
             //left
             if (prod <= 0 && prod - px > 0) {
@@ -460,7 +516,12 @@ static void _lineTo(RleWorker& rw, const SwPoint& to)
 
             _setCell(rw, e1);
 
-        } while(e1 != e2);
+            //The rest is out of the band.
+            if ((diff.y > 0) ? (e1.y >= rw.cellMax.y) : (e1.y < rw.cellMin.y)) {
+                rw.pos = to;
+                return;
+            }
+        }
     }
 
     f2 = {to.x - SUBPIXELS(e2.x), to.y - SUBPIXELS(e2.y)};
@@ -478,25 +539,21 @@ static void _cubicTo(RleWorker& rw, const SwPoint& ctrl1, const SwPoint& ctrl2,
     arc[2] = ctrl1;
     arc[3] = rw.pos;
 
-    //Short-cut the arc that crosses the current band
-    auto min = arc[0].y;
-    auto max = arc[0].y;
-
-    SwCoord y;
-    for (auto i = 1; i < 4; ++i) {
-        y = arc[i].y;
-        if (y < min) min = y;
-        if (y > max) max = y;
-    }
-
-    if (TRUNC(min) >= rw.cellMax.y || TRUNC(max) < rw.cellMin.y) goto draw;
-
     /* Decide whether to split or draw. See `Rapid Termination          */
     /* Evaluation for Recursive Subdivision of Bezier Curves' by Thomas */
     /* F. Hain, at                                                      */
     /* http://www.cis.southalabama.edu/~hain/general/Publications/Bezier/Camera-ready%20CISST02%202.pdf */
     while (true) {
         {
+            //Short-cut the pieces out of the current band, their lines are clipped anyway.
+            auto min = arc[0].y;
+            auto max = arc[0].y;
+            for (auto i = 1; i < 4; ++i) {
+                if (arc[i].y < min) min = arc[i].y;
+                if (arc[i].y > max) max = arc[i].y;
+            }
+            if (TRUNC(min) >= rw.cellMax.y || TRUNC(max) < rw.cellMin.y) goto draw;
+
             //diff is the P0 - P3 chord vector
             auto diff = arc[3] - arc[0];
             auto L = HYPOT(diff);
@@ -505,24 +562,24 @@ static void _cubicTo(RleWorker& rw, const SwPoint& ctrl1, const SwPoint& ctrl2,
             if (L > SHRT_MAX) goto split;
 
             //max deviation may be as much as (s/L) * 3/4 (if Hain's v = 1)
-            auto sLimit = L * (ONE_PIXEL / 6);
+            auto sLimit = int64_t(L) * rw.flatness;
 
             auto diff1 = arc[1] - arc[0];
-            auto s = diff.y * diff1.x - diff.x * diff1.y;
+            auto s = int64_t(diff.y) * diff1.x - int64_t(diff.x) * diff1.y;
             if (s < 0) s = -s;
             if (s > sLimit) goto split;
 
             //s is L * the perpendicular distance from P2 to the line P0 - P3
             auto diff2 = arc[2] - arc[0];
-            s = diff.y * diff2.x - diff.x * diff2.y;
+            s = int64_t(diff.y) * diff2.x - int64_t(diff.x) * diff2.y;
             if (s < 0) s = -s;
             if (s > sLimit) goto split;
 
             /* Split super curvy segments where the off points are so far
             from the chord that the angles P0-P1-P3 or P0-P2-P3 become
             acute as detected by appropriate dot products */
-            if (diff1.x * (diff1.x - diff.x) + diff1.y * (diff1.y - diff.y) > 0 ||
-                diff2.x * (diff2.x - diff.x) + diff2.y * (diff2.y - diff.y) > 0)
+            if (int64_t(diff1.x) * (diff1.x - diff.x) + int64_t(diff1.y) * (diff1.y - diff.y) > 0 ||
+                int64_t(diff2.x) * (diff2.x - diff.x) + int64_t(diff2.y) * (diff2.y - diff.y) > 0)
                 goto split;
 
             //no reason to split
@@ -594,10 +651,109 @@ invalid_outline:
 }
 
 
+//The edges skipped between are out of the band, and the cells there are invalid anyway.
+static bool _decomposeEdges(RleWorker& rw)
+{
+    auto pts = rw.outline->pts;
+    auto last = UINT32_MAX;
+
+    for (uint32_t i = 0; i < rw.bandEdgesCnt; ++i) {
+        auto& edge = rw.edges[rw.bandEdges[i]];
+        if (edge.from != last) _moveTo(rw, UPSCALE(pts[edge.from]));
+        if (edge.cubic) _cubicTo(rw, UPSCALE(pts[edge.from + 1]), UPSCALE(pts[edge.from + 2]), UPSCALE(pts[edge.to]));
+        else _lineTo(rw, UPSCALE(pts[edge.to]));
+        last = edge.to;
+    }
+    return true;
+}
+
+
+static inline int _edgeBand(SwCoord y, SwCoord top, int bandSize, int bandCnt)
+{
+    auto band = (y - top) / bandSize;
+    return (band < bandCnt) ? band : (bandCnt - 1);
+}
+
+
+/* The bands are rendered one after another, so the edges of the outline are bucketed by the bands they
+   touch in advance. A band decomposes only its own edges, and the bands without any are skipped.
+   It returns false if the outline is invalid or no memory, then the whole of it is decomposed per band. */
+static bool _bucketEdges(RleWorker& rw, SwCoord top, SwCoord bottom, int bandCnt, uint32_t* bandStart, uint32_t*& bandEdges)
+{
+    auto outline = rw.outline;
+    auto edges = static_cast<Edge*>(malloc(outline->ptsCnt * sizeof(Edge)));
+    if (!edges) return false;
+
+    auto cnt = 0U;
+    auto first = 0U;
+
+    for (int i = 0; i <= bandCnt; ++i) bandStart[i] = 0;
+
+    for (uint32_t n = 0; n < outline->cntrsCnt; ++n) {
+        auto last = outline->cntrs[n];
+        if (last >= outline->ptsCnt || outline->types[first] == SW_CURVE_TYPE_CUBIC) goto invalid;
+
+        for (auto i = first; i <= last; ) {
+            auto& edge = edges[cnt];
+            edge.from = i;
+            edge.cubic = (i < last && outline->types[i + 1] == SW_CURVE_TYPE_CUBIC);
+            if (edge.cubic) {
+                if (i + 2 > last || outline->types[i + 2] != SW_CURVE_TYPE_CUBIC) goto invalid;
+                i += 3;
+            } else {
+                ++i;
+            }
+            edge.to = (i <= last) ? i : first;
+
+            //The rows of the points, as the band clipping of the lines and the cubics
+            auto min = TRUNC(UPSCALE(outline->pts[edge.from])).y;
+            auto max = min;
+            auto y = TRUNC(UPSCALE(outline->pts[edge.to])).y;
+            if (y < min) min = y;
+            if (y > max) max = y;
+            if (edge.cubic) {
+                for (auto j = edge.from + 1; j <= edge.from + 2; ++j) {
+                    y = TRUNC(UPSCALE(outline->pts[j])).y;
+                    if (y < min) min = y;
+                    if (y > max) max = y;
+                }
+            }
+            if (max < top || min >= bottom) continue;
+
+            edge.first = _edgeBand((min > top) ? min : top, top, rw.bandSize, bandCnt);
+            edge.last = _edgeBand((max < bottom) ? max : (bottom - 1), top, rw.bandSize, bandCnt);
+            for (auto b = edge.first; b <= edge.last; ++b) ++bandStart[b + 1];
+            ++cnt;
+        }
+        first = last + 1;
+    }
+
+    for (int i = 0; i < bandCnt; ++i) bandStart[i + 1] += bandStart[i];
+
+    bandEdges = static_cast<uint32_t*>(malloc((bandStart[bandCnt] + 1) * sizeof(uint32_t)));
+    if (!bandEdges) goto invalid;
+
+    {
+        uint32_t pos[BAND_SIZE];
+        memcpy(pos, bandStart, bandCnt * sizeof(uint32_t));
+        for (uint32_t i = 0; i < cnt; ++i) {
+            for (auto b = edges[i].first; b <= edges[i].last; ++b) bandEdges[pos[b]++] = i;
+        }
+    }
+
+    rw.edges = edges;
+    return true;
+
+invalid:
+    free(edges);
+    return false;
+}
+
+
 static int _genRle(RleWorker& rw)
 {
     if (setjmp(rw.jmpBuf) == 0) {
-        auto ret = _decomposeOutline(rw);
+        auto ret = rw.edges ? _decomposeEdges(rw) : _decomposeOutline(rw);
         if (!rw.invalid) _recordCell(rw);
         if (ret) return 0;  //success
         else return 1;      //fail
@@ -774,14 +930,1098 @@ void _replaceClipSpan(SwRleData *rle, SwSpan* clippedSpans, uint32_t size)
 }
 
 
+/* Hairline: the thin strokes are drawn from the lines of the outline straight. Each line is a band
+   of the stroke width, the coverage of a pixel is the area of the band in it, cut by the pixel
+   column (row) of its major axis. The coverages are accumulated in tiles, allocated when touched,
+   with 8 more bits for the many small pieces of the flattened curves not to sum up their rounding. */
+
+constexpr auto HAIR_TILE_BITS = 6;
+constexpr auto HAIR_TILE = (1 << HAIR_TILE_BITS);
+
+struct HairWorker
+{
+    uint16_t** tiles;
+    SwCoord tilesX;
+    SwCoord w, h;           //size of the region
+    SwCoord minX, minY;     //origin of the region, in the sub-pixels
+    float hx, hy;           //half width of the stroke, scaled by the axes
+    SwCoord flatness;       //curve flatness tolerance in the sub-pixels
+    SwPoint bezStack[32 * 3 + 1];
+};
+
+
+static inline void _hairPut(HairWorker& hw, SwCoord x, SwCoord y, float coverage)
+{
+    auto c = static_cast<int>(coverage * 65280.0f + 0.5f);
+    if (c <= 0) return;
+
+    auto tile = hw.tiles + (y >> HAIR_TILE_BITS) * hw.tilesX + (x >> HAIR_TILE_BITS);
+    if (!*tile) {
+        *tile = static_cast<uint16_t*>(calloc(HAIR_TILE * HAIR_TILE, sizeof(uint16_t)));
+        if (!*tile) return;
+    }
+    auto p = *tile + ((y & (HAIR_TILE - 1)) << HAIR_TILE_BITS) + (x & (HAIR_TILE - 1));
+    c += *p;
+    *p = (c > 65280) ? 65280 : c;
+}
+
+
+//Integral of clamp(u, 0, 1)
+static inline float _hairIntegral(float u)
+{
+    if (u <= 0.0f) return 0.0f;
+    if (u <= 1.0f) return u * u * 0.5f;
+    return u - 0.5f;
+}
+
+
+//Average of clamp(u, 0, 1) while u goes from a to b linearly, inv is 1 / (b - a) or 0 if they are too close.
+static inline float _hairAverage(float a, float b, float inv)
+{
+    if (a <= 0.0f && b <= 0.0f) return 0.0f;
+    if (a >= 1.0f && b >= 1.0f) return 1.0f;
+    if (inv == 0.0f) {
+        auto u = (a + b) * 0.5f;
+        return (u < 0.0f) ? 0.0f : ((u > 1.0f) ? 1.0f : u);
+    }
+    return (_hairIntegral(b) - _hairIntegral(a)) * inv;
+}
+
+
+/* The band along the major axis(u) of the line: v = v0 + m * (u - u0) +/- t, in the pixels of
+   the region (uSize x vSize). swap tells the u axis is y. */
+static void _hairBand(HairWorker& hw, float u0, float v0, float u1, float v1, float t, bool swap)
+{
+    if (u1 < u0) {
+        auto tmp = u0; u0 = u1; u1 = tmp;
+        tmp = v0; v0 = v1; v1 = tmp;
+    }
+    auto m = (v1 - v0) / (u1 - u0);
+    auto uSize = swap ? hw.h : hw.w;
+    auto vSize = swap ? hw.w : hw.h;
+
+    auto us = (u0 > 0.0f) ? u0 : 0.0f;
+    auto ue = (u1 < uSize) ? u1 : static_cast<float>(uSize);
+
+    for (auto pu = static_cast<SwCoord>(floorf(us)); pu < ue; ++pu) {
+        auto a = (us > pu) ? us : static_cast<float>(pu);
+        auto b = (ue < pu + 1) ? ue : static_cast<float>(pu + 1);
+        auto f = b - a;
+        if (f <= 0.0f) continue;
+
+        auto ca = v0 + m * (a - u0);
+        auto cb = v0 + m * (b - u0);
+        auto d = cb - ca;
+        auto inv = (d > -0.0001f && d < 0.0001f) ? 0.0f : 1.0f / d;
+        auto lo = ((ca < cb) ? ca : cb) - t;
+        auto hi = ((ca > cb) ? ca : cb) + t;
+        auto pvs = static_cast<SwCoord>(floorf(lo));
+        auto pve = static_cast<SwCoord>(floorf(hi));
+        if (pvs < 0) pvs = 0;
+        if (pve >= vSize) pve = vSize - 1;
+
+        for (auto pv = pvs; pv <= pve; ++pv) {
+            auto coverage = _hairAverage(ca + t - pv, cb + t - pv, inv) - _hairAverage(ca - t - pv, cb - t - pv, inv);
+            if (swap) _hairPut(hw, pv, pu, coverage * f);
+            else _hairPut(hw, pu, pv, coverage * f);
+        }
+    }
+}
+
+
+static void _hairLine(HairWorker& hw, const Point& from, const Point& to)
+{
+    auto dx = to.x - from.x;
+    auto dy = to.y - from.y;
+    auto dx2 = dx * dx;
+    auto dy2 = dy * dy;
+    if (dx2 + dy2 < 0.000001f) return;
+    auto len = sqrtf(dx2 + dy2);
+
+    /* The stroker offsets the line by the half width along its normal, scaled by the axes.
+       The band is as thick as the offset along the minor axis. */
+    if (dx2 >= dy2) _hairBand(hw, from.x, from.y, to.x, to.y, (dx2 * hw.hy + dy2 * hw.hx) / (len * fabsf(dx)), false);
+    else _hairBand(hw, from.y, from.x, to.y, to.x, (dy2 * hw.hx + dx2 * hw.hy) / (len * fabsf(dy)), true);
+}
+
+
+static void _hairLineTo(HairWorker& hw, const SwPoint& from, const SwPoint& to)
+{
+    if (from == to) return;
+
+    Point p0 = {float(from.x - hw.minX) / ONE_PIXEL, float(from.y - hw.minY) / ONE_PIXEL};
+    Point p1 = {float(to.x - hw.minX) / ONE_PIXEL, float(to.y - hw.minY) / ONE_PIXEL};
+
+    _hairLine(hw, p0, p1);
+}
+
+
+static void _hairCubicTo(HairWorker& hw, const SwPoint& from, const SwPoint& ctrl1, const SwPoint& ctrl2, const SwPoint& to)
+{
+    auto arc = hw.bezStack;
+    arc[0] = to;
+    arc[1] = ctrl2;
+    arc[2] = ctrl1;
+    arc[3] = from;
+
+    //Split as the rasterizer does, see _cubicTo()
+    while (true) {
+        if (arc < hw.bezStack + 31 * 3) {
+            auto diff = arc[3] - arc[0];
+            auto L = HYPOT(diff);
+            if (L > SHRT_MAX) goto split;
+
+            auto sLimit = int64_t(L) * hw.flatness;
+            auto diff1 = arc[1] - arc[0];
+            auto s = int64_t(diff.y) * diff1.x - int64_t(diff.x) * diff1.y;
+            if (s < 0) s = -s;
+            if (s > sLimit) goto split;
+
+            auto diff2 = arc[2] - arc[0];
+            s = int64_t(diff.y) * diff2.x - int64_t(diff.x) * diff2.y;
+            if (s < 0) s = -s;
+            if (s > sLimit) goto split;
+
+            if (int64_t(diff1.x) * (diff1.x - diff.x) + int64_t(diff1.y) * (diff1.y - diff.y) > 0 ||
+                int64_t(diff2.x) * (diff2.x - diff.x) + int64_t(diff2.y) * (diff2.y - diff.y) > 0)
+                goto split;
+        }
+        goto draw;
+    split:
+        mathSplitCubic(arc);
+        arc += 3;
+        continue;
+    draw:
+        _hairLineTo(hw, arc[3], arc[0]);
+        if (arc == hw.bezStack) return;
+        arc -= 3;
+    }
+}
+
+
+static void _hairSweep(HairWorker& hw, SwRleData* rle)
+{
+    SwSpan spans[MAX_SPANS];
+    auto cnt = 0;
+    auto tilesY = (hw.h + HAIR_TILE - 1) >> HAIR_TILE_BITS;
+
+    for (SwCoord ty = 0; ty < tilesY; ++ty) {
+        auto row = hw.tiles + ty * hw.tilesX;
+        for (SwCoord y = (ty << HAIR_TILE_BITS); y < hw.h && y < ((ty + 1) << HAIR_TILE_BITS); ++y) {
+            for (SwCoord tx = 0; tx < hw.tilesX; ++tx) {
+                if (!row[tx]) continue;
+                auto line = row[tx] + ((y & (HAIR_TILE - 1)) << HAIR_TILE_BITS);
+                for (SwCoord x = 0; x < HAIR_TILE; ++x) {
+                    auto coverage = static_cast<uint8_t>((line[x] + 128) >> 8);
+                    if (coverage == 0) continue;
+                    auto sx = static_cast<int16_t>((tx << HAIR_TILE_BITS) + x + (hw.minX >> PIXEL_BITS));
+                    auto sy = static_cast<int16_t>(y + (hw.minY >> PIXEL_BITS));
+                    auto span = spans + cnt - 1;
+                    if (cnt > 0 && span->y == sy && span->x + span->len == sx && span->coverage == coverage) {
+                        ++span->len;
+                        continue;
+                    }
+                    if (cnt == MAX_SPANS) {
+                        _genSpan(rle, spans, cnt);
+                        cnt = 0;
+                    }
+                    span = spans + cnt++;
+                    span->x = sx;
+                    span->y = sy;
+                    span->len = 1;
+                    span->coverage = coverage;
+                }
+            }
+        }
+    }
+    if (cnt > 0) _genSpan(rle, spans, cnt);
+}
+
+
+/* Accumulation: the coverage engine of the complex paths. Each line of the outline adds its signed area
+   to a buffer of the region, pixel by pixel, and the running sums of the rows are the coverages. Its cost
+   is the area of the region rather than the number of the edges crossing a row, and it never runs out of
+   memory like the cells. The lines are clipped and bucketed by the strips of rows once, the buffer of a
+   strip stays in the cache and the strips without any lines are skipped. */
+
+constexpr auto ACC_STRIP_BITS = 4;
+constexpr auto ACC_STRIP = (1 << ACC_STRIP_BITS);
+constexpr auto ACC_DENSITY = 16;    //see _accDense()
+
+struct AccEdge
+{
+    float x0, y0, x1, y1;   //in the pixels of the region, y0 < y1
+    float dir;              //1: downward, -1: upward
+};
+
+struct AccWorker
+{
+    AccEdge* edges;
+    uint32_t edgesCnt;
+    uint32_t edgesMax;
+    SwCoord w, h;           //size of the region
+    SwCoord minX, minY;     //origin of the region, in the sub-pixels
+    SwCoord flatness;       //curve flatness tolerance in the sub-pixels
+    SwPoint pos;            //upscaled as the cells do, they split the curves at the same points
+    SwPoint bezStack[32 * 3 + 1];
+    bool evenOdd;
+    bool antiAlias;
+    bool aliased;           //keeps the horizontal lines, see _aliasRender()
+    bool failed;            //out of memory
+};
+
+
+static void _accPush(AccWorker& aw, Point p0, Point p1, float dir)
+{
+    if (p0.y > p1.y || (p0.y == p1.y && dir != 0.0f)) return;
+
+    if (aw.edgesCnt == aw.edgesMax) {
+        auto edgesMax = aw.edgesMax ? aw.edgesMax * 2 : 256;
+        auto edges = static_cast<AccEdge*>(realloc(aw.edges, edgesMax * sizeof(AccEdge)));
+        if (!edges) {
+            aw.failed = true;
+            return;
+        }
+        aw.edges = edges;
+        aw.edgesMax = edgesMax;
+    }
+    aw.edges[aw.edgesCnt++] = {p0.x, p0.y, p1.x, p1.y, dir};
+}
+
+
+//The point of the line p0 - p1 at x, y stays in the range of the line.
+static Point _accCutX(const Point& p0, const Point& p1, float x)
+{
+    auto y = p0.y + (p1.y - p0.y) * (x - p0.x) / (p1.x - p0.x);
+    if (y < p0.y) y = p0.y;
+    if (y > p1.y) y = p1.y;
+    return {x, y};
+}
+
+
+static void _accClipX(AccWorker& aw, const Point& p0, const Point& p1, float dir)
+{
+    auto w = static_cast<float>(aw.w);
+
+    //The lines on the left wind the whole rows, they go down along the left side.
+    if (p0.x <= 0.0f && p1.x <= 0.0f) {
+        _accPush(aw, {0.0f, p0.y}, {0.0f, p1.y}, dir);
+    //Nothing on the right is visible.
+    } else if (p0.x >= w && p1.x >= w) {
+        return;
+    } else if ((p0.x < 0.0f) != (p1.x < 0.0f)) {
+        auto pt = _accCutX(p0, p1, 0.0f);
+        _accClipX(aw, p0, pt, dir);
+        _accClipX(aw, pt, p1, dir);
+    } else if ((p0.x > w) != (p1.x > w)) {
+        auto pt = _accCutX(p0, p1, w);
+        _accClipX(aw, p0, pt, dir);
+        _accClipX(aw, pt, p1, dir);
+    } else {
+        _accPush(aw, p0, p1, dir);
+    }
+}
+
+
+static void _accLineTo(AccWorker& aw, SwPoint to)
+{
+    auto from = aw.pos;
+    aw.pos = to;
+
+    //The horizontal lines wind nothing, but they touch the pixels.
+    auto dir = 1.0f;
+    if (from.y == to.y) {
+        if (!aw.aliased || from.x == to.x) return;
+        dir = 0.0f;
+    } else if (from.y > to.y) {
+        auto tmp = from;
+        from = to;
+        to = tmp;
+        dir = -1.0f;
+    }
+
+    //Vertical clipping
+    auto h = static_cast<float>(aw.h);
+    Point p0 = {float(from.x - aw.minX) / ONE_PIXEL, float(from.y - aw.minY) / ONE_PIXEL};
+    Point p1 = {float(to.x - aw.minX) / ONE_PIXEL, float(to.y - aw.minY) / ONE_PIXEL};
+    if (p1.y <= 0.0f || p0.y >= h) return;
+
+    if (dir != 0.0f) {
+        auto dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+        if (p0.y < 0.0f) p0 = {p0.x - p0.y * dxdy, 0.0f};
+        if (p1.y > h) p1 = {p1.x - (p1.y - h) * dxdy, h};
+    }
+
+    _accClipX(aw, p0, p1, dir);
+}
+
+
+static void _accCubicTo(AccWorker& aw, const SwPoint& ctrl1, const SwPoint& ctrl2, const SwPoint& to)
+{
+    auto arc = aw.bezStack;
+    arc[0] = to;
+    arc[1] = ctrl2;
+    arc[2] = ctrl1;
+    arc[3] = aw.pos;
+
+    //The arcs above, below or on the left of the region are as good as their chords.
+    auto minX = arc[0].x, minY = arc[0].y, maxX = arc[0].x, maxY = arc[0].y;
+    for (auto i = 1; i < 4; ++i) {
+        if (arc[i].x < minX) minX = arc[i].x;
+        if (arc[i].x > maxX) maxX = arc[i].x;
+        if (arc[i].y < minY) minY = arc[i].y;
+        if (arc[i].y > maxY) maxY = arc[i].y;
+    }
+    if (maxY <= aw.minY || minY >= aw.minY + SUBPIXELS(aw.h) || maxX <= aw.minX) {
+        _accLineTo(aw, to);
+        return;
+    }
+
+    //Split as the rasterizer does, see _cubicTo()
+    while (true) {
+        if (arc < aw.bezStack + 31 * 3) {
+            auto diff = arc[3] - arc[0];
+            auto L = HYPOT(diff);
+            if (L > SHRT_MAX) goto split;
+
+            auto sLimit = int64_t(L) * aw.flatness;
+            auto diff1 = arc[1] - arc[0];
+            auto s = int64_t(diff.y) * diff1.x - int64_t(diff.x) * diff1.y;
+            if (s < 0) s = -s;
+            if (s > sLimit) goto split;
+
+            auto diff2 = arc[2] - arc[0];
+            s = int64_t(diff.y) * diff2.x - int64_t(diff.x) * diff2.y;
+            if (s < 0) s = -s;
+            if (s > sLimit) goto split;
+
+            if (int64_t(diff1.x) * (diff1.x - diff.x) + int64_t(diff1.y) * (diff1.y - diff.y) > 0 ||
+                int64_t(diff2.x) * (diff2.x - diff.x) + int64_t(diff2.y) * (diff2.y - diff.y) > 0)
+                goto split;
+        }
+        goto draw;
+    split:
+        mathSplitCubic(arc);
+        arc += 3;
+        continue;
+    draw:
+        _accLineTo(aw, arc[0]);
+        if (arc == aw.bezStack) return;
+        arc -= 3;
+    }
+}
+
+
+static bool _accDecomposeOutline(AccWorker& aw, const SwOutline* outline)
+{
+    auto first = 0;  //index of first point in contour
+
+    for (uint32_t n = 0; n < outline->cntrsCnt; ++n) {
+        auto last = outline->cntrs[n];
+        auto limit = outline->pts + last;
+        auto start = UPSCALE(outline->pts[first]);
+        auto pt = outline->pts + first;
+        auto types = outline->types + first;
+
+        //A contour cannot start with a cubic control point!
+        if (types[0] == SW_CURVE_TYPE_CUBIC) return false;
+
+        aw.pos = start;
+
+        while (pt < limit) {
+            ++pt;
+            ++types;
+
+            if (types[0] == SW_CURVE_TYPE_POINT) {
+                _accLineTo(aw, UPSCALE(*pt));
+            } else {
+                if (pt + 1 > limit || types[1] != SW_CURVE_TYPE_CUBIC) return false;
+
+                pt += 2;
+                types += 2;
+
+                if (pt <= limit) {
+                    _accCubicTo(aw, UPSCALE(pt[-2]), UPSCALE(pt[-1]), UPSCALE(pt[0]));
+                    continue;
+                }
+                _accCubicTo(aw, UPSCALE(pt[-2]), UPSCALE(pt[-1]), start);
+                goto close;
+            }
+        }
+        _accLineTo(aw, start);
+    close:
+        first = last + 1;
+    }
+    return !aw.failed;
+}
+
+
+/* Adds the signed area of the edge in the rows of the strip (font-rs). Each row gets the area on the
+   right of the edge in its pixels, and the rest of its height in the pixel next to the edge so that the
+   running sum carries it to the end of the row. */
+static void _accEdge(const AccEdge& edge, float* acc, SwCoord stride, SwCoord* rowMin, SwCoord* rowMax, SwCoord top, SwCoord bottom, float w)
+{
+    auto y0 = (edge.y0 > top) ? edge.y0 : static_cast<float>(top);
+    auto y1 = (edge.y1 < bottom) ? edge.y1 : static_cast<float>(bottom);
+    if (y0 >= y1) return;
+
+    auto dxdy = (edge.x1 - edge.x0) / (edge.y1 - edge.y0);
+    auto x = edge.x0 + (y0 - edge.y0) * dxdy;
+    if (x < 0.0f) x = 0.0f;
+    else if (x > w) x = w;
+
+    for (auto y = static_cast<SwCoord>(y0); y < y1; ++y) {
+        auto dy = ((y + 1 < y1) ? y + 1 : y1) - ((y > y0) ? y : y0);
+        auto xnext = x + dxdy * dy;
+        if (xnext < 0.0f) xnext = 0.0f;
+        else if (xnext > w) xnext = w;
+        auto d = dy * edge.dir;
+        auto row = acc + (y - top) * stride;
+
+        auto xa = (x < xnext) ? x : xnext;
+        auto xb = (x < xnext) ? xnext : x;
+        auto xaf = floorf(xa);
+        auto xai = static_cast<SwCoord>(xaf);
+        auto xbi = static_cast<SwCoord>(ceilf(xb));
+
+        //Inside a pixel
+        if (xbi <= xai + 1) {
+            auto xmf = 0.5f * (x + xnext) - xaf;
+            row[xai] += d - d * xmf;
+            row[xai + 1] += d * xmf;
+            xbi = xai + 1;
+        } else {
+            auto s = 1.0f / (xb - xa);
+            auto x0f = xa - xaf;
+            auto a0 = 0.5f * s * (1.0f - x0f) * (1.0f - x0f);
+            auto x1f = xb - xbi + 1.0f;
+            auto am = 0.5f * s * x1f * x1f;
+            row[xai] += d * a0;
+            if (xbi == xai + 2) {
+                row[xai + 1] += d * (1.0f - a0 - am);
+            } else {
+                auto a1 = s * (1.5f - x0f);
+                row[xai + 1] += d * (a1 - a0);
+                auto ds = d * s;
+                for (auto xi = xai + 2; xi < xbi - 1; ++xi) row[xi] += ds;
+                auto a2 = a1 + (xbi - xai - 3) * s;
+                row[xbi - 1] += d * (1.0f - a2 - am);
+            }
+            row[xbi] += d * am;
+        }
+
+        if (xai < rowMin[y - top]) rowMin[y - top] = xai;
+        if (xbi > rowMax[y - top]) rowMax[y - top] = xbi;
+
+        x = xnext;
+    }
+}
+
+
+//The coverage of the winding, as the cells compute it from the area.
+static inline uint8_t _accCoverage(float winding, bool evenOdd)
+{
+    auto coverage = static_cast<int32_t>(fabsf(winding) * 256.0f);
+    if (evenOdd) {
+        coverage &= 511;
+        if (coverage > 255) coverage = 511 - coverage;
+    } else if (coverage > 255) {
+        coverage = 255;
+    }
+    return static_cast<uint8_t>(coverage);
+}
+
+
+//The running sums of the row in [from, to), to the coverages. The row is cleared for the next strip.
+static float _accSum(float* row, uint8_t* cov, SwCoord from, SwCoord to, bool evenOdd)
+{
+    auto winding = 0.0f;
+    auto x = from & ~3;
+
+#if defined(__SSE2__)
+    auto sum = _mm_setzero_ps();
+    auto zero = _mm_setzero_ps();
+    auto sign = _mm_set1_ps(-0.0f);
+    auto scale = _mm_set1_ps(256.0f);
+    auto mod = _mm_set1_epi32(511);
+
+    for (; x < to; x += 4) {
+        auto v = _mm_load_ps(row + x);
+        v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 4)));
+        v = _mm_add_ps(v, _mm_castsi128_ps(_mm_slli_si128(_mm_castps_si128(v), 8)));
+        v = _mm_add_ps(v, sum);
+        sum = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+        _mm_store_ps(row + x, zero);
+
+        auto c = _mm_cvttps_epi32(_mm_mul_ps(_mm_andnot_ps(sign, v), scale));
+        if (evenOdd) {
+            c = _mm_and_si128(c, mod);
+            c = _mm_packs_epi32(c, c);
+            c = _mm_min_epi16(c, _mm_sub_epi16(_mm_set1_epi16(511), c));
+        } else {
+            c = _mm_packs_epi32(c, c);
+        }
+        c = _mm_packus_epi16(c, c);
+        auto packed = _mm_cvtsi128_si32(c);
+        memcpy(cov + x, &packed, 4);
+    }
+    winding = _mm_cvtss_f32(sum);
+#else
+    for (; x < to; ++x) {
+        winding += row[x];
+        row[x] = 0.0f;
+        cov[x] = _accCoverage(winding, evenOdd);
+    }
+#endif
+    return winding;
+}
+
+
+static void _accSpan(SwRleData* rle, SwSpan* spans, int& cnt, SwCoord x, SwCoord y, SwCoord len, uint8_t coverage)
+{
+    auto span = spans + cnt - 1;
+    if (cnt > 0 && span->y == y && span->x + span->len == x && span->coverage == coverage) {
+        span->len += len;
+        return;
+    }
+    if (cnt == MAX_SPANS) {
+        _genSpan(rle, spans, cnt);
+        cnt = 0;
+    }
+    span = spans + cnt++;
+    span->x = x;
+    span->y = y;
+    span->len = len;
+    span->coverage = coverage;
+}
+
+
+static void _accSweep(AccWorker& aw, SwRleData* rle, float* acc, SwCoord stride, uint8_t* cov, SwCoord* rowMin, SwCoord* rowMax, SwCoord top, SwCoord rows, SwSpan* spans, int& cnt)
+{
+    auto x0 = TRUNC(aw.minX);
+    auto y0 = TRUNC(aw.minY);
+
+    for (SwCoord i = 0; i < rows; ++i) {
+        auto from = rowMin[i];
+        auto to = rowMax[i] + 1;
+        if (from >= to) continue;
+
+        auto row = acc + i * stride;
+        auto winding = _accSum(row, cov, from, to, aw.evenOdd);
+        if (to > aw.w) to = aw.w;
+
+        auto y = y0 + top + i;
+        for (auto x = from; x < to; ) {
+            auto coverage = cov[x];
+            auto len = 1;
+            //The runs of the insides are long, compare them by 8 pixels.
+            auto run = coverage * 0x0101010101010101ULL;
+            uint64_t next;
+            while (x + len + 8 <= to) {
+                memcpy(&next, cov + x + len, 8);
+                if (next != run) break;
+                len += 8;
+            }
+            while (x + len < to && cov[x + len] == coverage) ++len;
+            if (coverage > 0) _accSpan(rle, spans, cnt, x0 + x, y, len, aw.antiAlias ? coverage : 255);
+            x += len;
+        }
+
+        //The rest of the row is wound by the edges on the right of the region.
+        if (to < aw.w) {
+            auto coverage = _accCoverage(winding, aw.evenOdd);
+            if (coverage > 0) _accSpan(rle, spans, cnt, x0 + to, y, aw.w - to, aw.antiAlias ? coverage : 255);
+        }
+
+        rowMin[i] = aw.w + 2;
+        rowMax[i] = -1;
+    }
+}
+
+
+static bool _accRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias, float flatness)
+{
+    AccWorker aw;
+    aw.edges = nullptr;
+    aw.edgesCnt = 0;
+    aw.edgesMax = 0;
+    aw.w = renderRegion.max.x - renderRegion.min.x;
+    aw.h = renderRegion.max.y - renderRegion.min.y;
+    aw.minX = SUBPIXELS(renderRegion.min.x);
+    aw.minY = SUBPIXELS(renderRegion.min.y);
+    aw.flatness = SATURATE_SWCOORD(flatness * ONE_PIXEL);
+    aw.evenOdd = (outline->fillRule == FillRule::EvenOdd);
+    aw.antiAlias = antiAlias;
+    aw.aliased = false;
+    aw.failed = false;
+
+    if (aw.w <= 0 || aw.h <= 0) return true;
+
+    if (!_accDecomposeOutline(aw, outline)) {
+        free(aw.edges);
+        return false;
+    }
+
+    //Bucket the edges by their first strips
+    auto stripsCnt = (aw.h + ACC_STRIP - 1) >> ACC_STRIP_BITS;
+    auto buckets = static_cast<uint32_t*>(calloc(stripsCnt + 1, sizeof(uint32_t)));
+    auto sorted = static_cast<AccEdge*>(malloc((aw.edgesCnt + 1) * sizeof(AccEdge)));
+
+    //A strip of the buffer with the padding of the sums, and the row ranges.
+    auto stride = (aw.w + 2 + 3) & ~3;
+    auto acc = static_cast<float*>(calloc(stride * ACC_STRIP + 4, sizeof(float)));
+    auto cov = static_cast<uint8_t*>(malloc(stride));
+    SwCoord rowMin[ACC_STRIP], rowMax[ACC_STRIP];
+
+    auto ret = (buckets && sorted && acc && cov);
+
+    if (ret) {
+        for (uint32_t i = 0; i < aw.edgesCnt; ++i) {
+            ++buckets[(static_cast<SwCoord>(aw.edges[i].y0) >> ACC_STRIP_BITS) + 1];
+        }
+        for (SwCoord i = 0; i < stripsCnt; ++i) buckets[i + 1] += buckets[i];
+        for (uint32_t i = 0; i < aw.edgesCnt; ++i) {
+            sorted[buckets[static_cast<SwCoord>(aw.edges[i].y0) >> ACC_STRIP_BITS]++] = aw.edges[i];
+        }
+
+        for (SwCoord i = 0; i < ACC_STRIP; ++i) {
+            rowMin[i] = aw.w + 2;
+            rowMax[i] = -1;
+        }
+
+        //The edges are moved to the front of the array while they are alive.
+        auto active = aw.edges;
+        uint32_t activeCnt = 0;
+        uint32_t next = 0;
+        SwSpan spans[MAX_SPANS];
+        auto cnt = 0;
+        auto w = static_cast<float>(aw.w);
+
+        for (SwCoord s = 0; s < stripsCnt; ++s) {
+            while (next < buckets[s]) active[activeCnt++] = sorted[next++];
+            if (activeCnt == 0) continue;
+
+            auto top = s << ACC_STRIP_BITS;
+            auto bottom = (top + ACC_STRIP < aw.h) ? top + ACC_STRIP : aw.h;
+            uint32_t alive = 0;
+
+            for (uint32_t i = 0; i < activeCnt; ++i) {
+                _accEdge(active[i], acc, stride, rowMin, rowMax, top, bottom, w);
+                if (active[i].y1 > bottom) active[alive++] = active[i];
+            }
+            activeCnt = alive;
+
+            _accSweep(aw, rle, acc, stride, cov, rowMin, rowMax, top, bottom - top, spans, cnt);
+        }
+        if (cnt > 0) _genSpan(rle, spans, cnt);
+    }
+
+    free(aw.edges);
+    free(buckets);
+    free(sorted);
+    free(acc);
+    free(cov);
+
+    return ret;
+}
+
+
+/* The cells work best while the edges are sparse in the rows. An edge makes a cell for each pixel it
+   crosses, and the render pool holds about 8 cells a row for a band. Beyond twice that, the cell lists get
+   long and the bands are split over and over, the accumulation wins. The control polygons tell the length
+   of the edges well enough, without flattening the curves. */
+static bool _accDense(const SwOutline* outline, const SwBBox& renderRegion)
+{
+    auto h = renderRegion.max.y - renderRegion.min.y;
+    if (outline->ptsCnt < 2 || h <= 0) return false;
+
+    int64_t length = 0;
+    uint32_t first = 0;
+    for (uint32_t n = 0; n < outline->cntrsCnt; ++n) {
+        auto last = outline->cntrs[n];
+        auto pt = outline->pts + first;
+        for (auto i = first; i < last; ++i, ++pt) {
+            length += abs(pt[1].x - pt[0].x) + abs(pt[1].y - pt[0].y);
+        }
+        length += abs(outline->pts[first].x - pt->x) + abs(outline->pts[first].y - pt->y);
+        first = last + 1;
+    }
+
+    //The cells for each row of the region.
+    return (length >> 6) > ACC_DENSITY * h;
+}
+
+
+/* Aliased: the scan converter of the binary masks and the hit maps. No coverages are computed, a pixel
+   is filled if its center is inside of the path or any line passes through it, so that nothing the path
+   touches is lost. The lines are decomposed as the accumulation does, and bucketed by their first rows.
+   The active lines are kept in the order of their crossings at the centers of the rows, which hardly
+   changes from a row to the next. */
+
+struct AliasEdge
+{
+    AccEdge edge;
+    float dxdy;
+    float x;        //at the center of the current row, the order of the crossings
+};
+
+
+//The lines are clipped to the region, so the positions are never below -1. floorf() and ceilf() are calls without SSE4.1.
+static inline SwCoord _aliasFloor(float v)
+{
+    auto i = static_cast<SwCoord>(v);
+    return (i > v) ? i - 1 : i;
+}
+
+
+static inline SwCoord _aliasCeil(float v)
+{
+    auto i = static_cast<SwCoord>(v);
+    return (i < v) ? i + 1 : i;
+}
+
+
+static inline void _aliasFill(uint8_t* mask, SwCoord first, SwCoord last, SwCoord w, SwCoord& rowMin, SwCoord& rowMax)
+{
+    if (first < 0) first = 0;
+    if (last >= w) last = w - 1;
+    if (first > last) return;
+    //Most of the lines touch a few pixels only, they are marked by a word. The mask is padded for it.
+    auto len = last - first + 1;
+    if (len <= 8) {
+        uint64_t run;
+        memcpy(&run, mask + first, 8);
+        run |= 0x0101010101010101ULL >> ((8 - len) << 3);
+        memcpy(mask + first, &run, 8);
+    } else {
+        memset(mask + first, 1, len);
+    }
+    if (first < rowMin) rowMin = first;
+    if (last > rowMax) rowMax = last;
+}
+
+
+//The pixels of the row the line passes through. The lines along the borders of the pixels touch none.
+static void _aliasTouch(const AliasEdge& ae, uint8_t* mask, float top, SwCoord w, SwCoord& rowMin, SwCoord& rowMax)
+{
+    auto& e = ae.edge;
+    float lo, hi;
+
+    if (e.dir == 0.0f) {
+        if (e.y0 == top) return;
+        lo = (e.x0 < e.x1) ? e.x0 : e.x1;
+        hi = (e.x0 < e.x1) ? e.x1 : e.x0;
+    } else {
+        //The order of the lines is random, no branches here.
+        auto ya = (e.y0 > top) ? e.y0 : top;
+        auto yb = (e.y1 < top + 1.0f) ? e.y1 : top + 1.0f;
+        auto xa = e.x0 + (ya - e.y0) * ae.dxdy;
+        auto xb = e.x0 + (yb - e.y0) * ae.dxdy;
+        lo = (xa < xb) ? xa : xb;
+        hi = (xa < xb) ? xb : xa;
+        //within the line, regardless of the rounding errors
+        auto x0 = (e.x0 < e.x1) ? e.x0 : e.x1;
+        auto x1 = (e.x0 < e.x1) ? e.x1 : e.x0;
+        lo = (lo > x0) ? lo : x0;
+        hi = (hi < x1) ? hi : x1;
+    }
+    _aliasFill(mask, _aliasFloor(lo), _aliasCeil(hi) - 1, w, rowMin, rowMax);
+}
+
+
+static bool _aliasRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, float flatness)
+{
+    AccWorker aw;
+    aw.edges = nullptr;
+    aw.edgesCnt = 0;
+    aw.edgesMax = 0;
+    aw.w = renderRegion.max.x - renderRegion.min.x;
+    aw.h = renderRegion.max.y - renderRegion.min.y;
+    aw.minX = SUBPIXELS(renderRegion.min.x);
+    aw.minY = SUBPIXELS(renderRegion.min.y);
+    aw.flatness = SATURATE_SWCOORD(flatness * ONE_PIXEL);
+    aw.evenOdd = (outline->fillRule == FillRule::EvenOdd);
+    aw.antiAlias = false;
+    aw.aliased = true;
+    aw.failed = false;
+
+    if (aw.w <= 0 || aw.h <= 0) return true;
+
+    if (!_accDecomposeOutline(aw, outline)) {
+        free(aw.edges);
+        return false;
+    }
+
+    auto buckets = static_cast<uint32_t*>(calloc(aw.h + 1, sizeof(uint32_t)));
+    auto sorted = static_cast<AliasEdge*>(malloc((aw.edgesCnt + 1) * sizeof(AliasEdge)));
+    auto active = static_cast<AliasEdge**>(malloc((aw.edgesCnt + 1) * sizeof(AliasEdge*)));
+    auto mask = static_cast<uint8_t*>(calloc(aw.w + 8, sizeof(uint8_t)));
+
+    auto ret = (buckets && sorted && active && mask);
+
+    if (ret) {
+        //Bucket the edges by their first rows
+        auto last = aw.h - 1;
+        for (uint32_t i = 0; i < aw.edgesCnt; ++i) {
+            auto r = static_cast<SwCoord>(aw.edges[i].y0);
+            ++buckets[((r < last) ? r : last) + 1];
+        }
+        for (SwCoord i = 0; i < aw.h; ++i) buckets[i + 1] += buckets[i];
+        for (uint32_t i = 0; i < aw.edgesCnt; ++i) {
+            auto& e = aw.edges[i];
+            auto r = static_cast<SwCoord>(e.y0);
+            auto& ae = sorted[buckets[(r < last) ? r : last]++];
+            ae.edge = e;
+            ae.dxdy = (e.dir == 0.0f) ? 0.0f : (e.x1 - e.x0) / (e.y1 - e.y0);
+        }
+
+        uint32_t activeCnt = 0;
+        uint32_t next = 0;
+        SwSpan spans[MAX_SPANS];
+        auto cnt = 0;
+        auto x0 = TRUNC(aw.minX);
+        auto y0 = TRUNC(aw.minY);
+
+        for (SwCoord r = 0; r < aw.h; ++r) {
+            while (next < buckets[r]) active[activeCnt++] = sorted + next++;
+            if (activeCnt == 0) continue;
+
+            auto top = static_cast<float>(r);
+            auto center = top + 0.5f;
+            auto rowMin = aw.w;
+            auto rowMax = -1;
+
+            //The touched pixels, and the crossings sorted by the insertion as they are almost in order.
+            for (uint32_t i = 0; i < activeCnt; ++i) {
+                auto ae = active[i];
+                auto& e = ae->edge;
+                _aliasTouch(*ae, mask, top, aw.w, rowMin, rowMax);
+                auto y = (center < e.y0) ? e.y0 : ((center > e.y1) ? e.y1 : center);
+                ae->x = e.x0 + (y - e.y0) * ae->dxdy;
+
+                auto j = i;
+                while (j > 0 && active[j - 1]->x > ae->x) {
+                    active[j] = active[j - 1];
+                    --j;
+                }
+                active[j] = ae;
+            }
+
+            //The pixels with the centers inside
+            auto winding = 0;
+            auto from = 0.0f;
+            for (uint32_t i = 0; i < activeCnt; ++i) {
+                auto& e = active[i]->edge;
+                if (e.dir == 0.0f || center < e.y0 || center >= e.y1) continue;
+                auto inside = aw.evenOdd ? (winding & 1) : winding;
+                winding += static_cast<int>(e.dir);
+                auto inside2 = aw.evenOdd ? (winding & 1) : winding;
+                if (!inside && inside2) from = active[i]->x;
+                else if (inside && !inside2) {
+                    _aliasFill(mask, _aliasCeil(from - 0.5f), _aliasCeil(active[i]->x - 0.5f) - 1, aw.w, rowMin, rowMax);
+                }
+            }
+            //The rest of the row is wound by the lines on the right of the region.
+            if (aw.evenOdd ? (winding & 1) : winding) {
+                _aliasFill(mask, _aliasCeil(from - 0.5f), aw.w - 1, aw.w, rowMin, rowMax);
+            }
+
+            //The runs of the mask to the spans
+            auto y = y0 + r;
+            for (auto x = rowMin; x <= rowMax; ) {
+                auto end = static_cast<uint8_t*>(memchr(mask + x, 0, rowMax + 1 - x));
+                auto len = end ? static_cast<SwCoord>(end - mask) - x : rowMax + 1 - x;
+                _accSpan(rle, spans, cnt, x0 + x, y, len, 255);
+                x += len;
+                if (x > rowMax) break;
+                auto begin = static_cast<uint8_t*>(memchr(mask + x, 1, rowMax + 1 - x));
+                if (!begin) break;
+                x = static_cast<SwCoord>(begin - mask);
+            }
+            if (rowMin <= rowMax) memset(mask + rowMin, 0, rowMax - rowMin + 1);
+
+            //The lines ending in this row are done.
+            uint32_t alive = 0;
+            for (uint32_t i = 0; i < activeCnt; ++i) {
+                if (active[i]->edge.y1 > top + 1.0f) active[alive++] = active[i];
+            }
+            activeCnt = alive;
+        }
+        if (cnt > 0) _genSpan(rle, spans, cnt);
+    }
+
+    free(aw.edges);
+    free(buckets);
+    free(sorted);
+    free(active);
+    free(mask);
+
+    return ret;
+}
+
+
+/* RoundRect: the rectangles and the ellipses with the axes of the device. A side of them is made of the
+   arcs of the corners and the straight line between, x = cx + kx * sqrt(1 - ((y - cy) / ry)^2), so the
+   rows are scanned straight without the outline. Each side adds its area to the row in the pieces between
+   the pixel columns it crosses (font-rs), a piece in a column adds to the column and its next. The rows
+   between the corners are the same, so the spans of a rounded rectangle are mostly copied. */
+
+struct RoundArc
+{
+    float cx, kx;   //the column of the center and the signed radius, kx is zero for the straight lines
+    float cy, ry;
+    float ikx, iry; //the reciprocals of the radii
+};
+
+
+static inline float _roundX(const RoundArc& arc, float y)
+{
+    auto v = (y - arc.cy) * arc.iry;
+    auto d = 1.0f - v * v;
+    return arc.cx + arc.kx * ((d > 0.0f) ? sqrtf(d) : 0.0f);
+}
+
+
+//The left side at y, the right one is its mirror.
+static inline float _roundLeft(const RoundArc* left, float y, float yA, float yB)
+{
+    if (y < yA) return _roundX(left[0], y);
+    if (y > yB) return _roundX(left[2], y);
+    return left[1].cx;
+}
+
+
+//The pixels out of the region are the same for the sums, the positions are clamped before the casts.
+static inline SwCoord _roundFloor(float v, SwCoord max)
+{
+    if (v < -1.0f) return -1;
+    if (v > max + 1.0f) return max + 1;
+    return _aliasFloor(v);
+}
+
+
+/* The part of the side in [y0, y1] of a row, from x0 to x1. It's split at the pixel columns [0, w] it crosses,
+   each piece is the chord and the segment of the arc beyond it. For the unit circle, the segment of a short
+   chord l is l^3 / 12, the length is estimated within 4% without the square root. A piece in a column adds
+   its area on the right in the column there, and the rest to the next. */
+static void _roundSide(float* row, SwCoord w, const RoundArc& arc, float y0, float y1, float x0, float x1, float dir, SwCoord& lo, SwCoord& hi)
+{
+    if (y0 >= y1) return;
+
+    //The upper arcs are above their centers.
+    auto sign = (y0 + y1 < 2.0f * arc.cy) ? -arc.ry : arc.ry;
+    auto step = (x1 > x0) ? 1 : -1;
+    auto c = _roundFloor(x0, w) + ((step > 0) ? 1 : 0);
+    auto end = _roundFloor(x1, w) + ((step > 0) ? 0 : 1);
+    if (step > 0) {
+        if (c < 0) c = 0;
+        if (end > w) end = w;
+        if (end < c) end = c - 1;
+    } else {
+        //The column x0 itself is not a crossing.
+        if (static_cast<float>(c) == x0) --c;
+        if (c > w) c = w;
+        if (end < 0) end = 0;
+        if (end > c) end = c + 1;
+    }
+    end += step;
+
+    /* The arcs of 16 pixels or more are within 1/256 of the parabola by the ends and the middle of the part,
+       the crossings of the long parts are on it without the square roots. */
+    auto quad = (arc.kx * arc.kx >= 256.0f && arc.ry >= 16.0f && (end - c) * step > 2);
+    float mid = 0.0f, s1 = 0.0f, s2 = 0.0f;
+    if (quad) {
+        mid = 0.5f * (x0 + x1);
+        auto u = (mid - arc.cx) * arc.ikx;
+        auto d = 1.0f - u * u;
+        auto ym = arc.cy + sign * ((d > 0.0f) ? sqrtf(d) : 0.0f);
+        s1 = (ym - y0) / (mid - x0);
+        s2 = ((y1 - ym) / (x1 - mid) - s1) / (x1 - x0);
+    }
+
+    auto py = y0;
+    auto px = x0;
+    auto last = false;
+
+    while (!last) {
+        float x, y;
+        if (c == end) {
+            x = x1;
+            y = y1;
+            last = true;
+        } else {
+            x = static_cast<float>(c);
+            if (quad) {
+                y = y0 + (x - x0) * (s1 + (x - mid) * s2);
+            } else {
+                auto u = (x - arc.cx) * arc.ikx;
+                auto d = 1.0f - u * u;
+                y = arc.cy + sign * ((d > 0.0f) ? sqrtf(d) : 0.0f);
+            }
+            if (y < py) y = py;
+            else if (y > y1) y = y1;
+            c += step;
+        }
+
+        if (y > py) {
+            auto dy = y - py;
+            auto xm = 0.5f * (px + x);
+            auto col = (xm < 0.0f) ? -1 : ((xm < w) ? static_cast<SwCoord>(xm) : w);
+            if (col < 0) {
+                row[0] += dy * dir;
+                lo = 0;
+                if (hi < 0) hi = 0;
+            } else if (col < w) {
+                auto u = fabsf((x - px) * arc.ikx);
+                auto v = dy * arc.iry;
+                auto l = (u > v) ? (0.96f * u + 0.4f * v) : (0.96f * v + 0.4f * u);
+                auto a = (xm - col) * dy + arc.kx * arc.ry * l * l * l * (1.0f / 12.0f);
+                if (a < 0.0f) a = 0.0f;
+                else if (a > dy) a = dy;
+                row[col] += (dy - a) * dir;
+                if (col < lo) lo = col;
+                if (col + 1 < w) {
+                    row[col + 1] += a * dir;
+                    ++col;
+                }
+                if (col > hi) hi = col;
+            }
+        }
+        py = y;
+        px = x;
+    }
+}
+
+
+//The running sums of the row in [from, to] to the spans. The row is cleared for the next.
+static float _roundSum(SwRleData* rle, SwSpan* spans, int& cnt, float* row, SwCoord from, SwCoord to, float winding, SwCoord x, SwCoord y)
+{
+    //The runs of the same coverage are a span.
+    auto start = from;
+    int32_t run = 0;
+
+    for (auto i = from; i <= to; ++i) {
+        winding += row[i];
+        row[i] = 0.0f;
+        auto coverage = static_cast<int32_t>(fabsf(winding) * 256.0f);
+        if (coverage > 255) coverage = 255;
+        if (coverage == run) continue;
+        if (run > 0) _accSpan(rle, spans, cnt, x + start, y, i - start, run);
+        start = i;
+        run = coverage;
+    }
+    if (run > 0) _accSpan(rle, spans, cnt, x + start, y, to + 1 - start, run);
+    return winding;
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
 
-SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias)
+SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias, float flatness, SwRasterizer rasterizer)
 {
     constexpr auto RENDER_POOL_SIZE = 16384L;
-    constexpr auto BAND_SIZE = 40;
 
     //TODO: We can preserve several static workers in advance
     RleWorker rw;
@@ -803,13 +2043,35 @@ SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& ren
     rw.cellYCnt = rw.cellMax.y - rw.cellMin.y;
     rw.ySpan = 0;
     rw.outline = const_cast<SwOutline*>(outline);
-    rw.bandSize = rw.bufferSize / (sizeof(Cell) * 8);  //bandSize: 64
+    rw.edges = nullptr;
+    rw.bandEdges = nullptr;
+    rw.bandEdgesCnt = 0;
+    rw.bandSize = rw.bufferSize / (sizeof(Cell) * 8);  //bandSize: 85
     rw.bandShoot = 0;
     rw.antiAlias = antiAlias;
+    rw.flatness = SATURATE_SWCOORD(flatness * ONE_PIXEL);
 
     if (!rle) rw.rle = reinterpret_cast<SwRleData*>(calloc(1, sizeof(SwRleData)));
     else rw.rle = rle;
 
+    //The binary masks and hit maps don't need the areas at all. The other non anti-aliased ones keep the coverage engines.
+    if (rasterizer == SwRasterizer::Aliased) {
+        if (_aliasRender(rw.rle, outline, renderRegion, flatness)) return rw.rle;
+        free(rw.rle);
+        return nullptr;
+    }
+
+    if (rasterizer == SwRasterizer::Auto) rasterizer = _accDense(outline, renderRegion) ? SwRasterizer::Accumulation : SwRasterizer::Cells;
+
+    if (rasterizer == SwRasterizer::Accumulation) {
+        if (_accRender(rw.rle, outline, renderRegion, antiAlias, flatness)) return rw.rle;
+        free(rw.rle);
+        return nullptr;
+    }
+
+    //The spans of the bands are discarded if a row is too complex for the cells.
+    auto spansCnt = rw.rle->size;
+
     //Generate RLE
     Band bands[BAND_SIZE];
     Band* band;
@@ -819,6 +2081,10 @@ SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& ren
     if (bandCnt == 0) bandCnt = 1;
     else if (bandCnt >= BAND_SIZE) bandCnt = (BAND_SIZE - 1);
 
+    uint32_t bandStart[BAND_SIZE];
+    uint32_t* bandEdges = nullptr;
+    if (bandCnt > 1) _bucketEdges(rw, rw.cellMin.y, rw.cellMax.y, bandCnt, bandStart, bandEdges);
+
     auto min = rw.cellMin.y;
     auto yMax = rw.cellMax.y;
     SwCoord max;
@@ -828,6 +2094,13 @@ SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& ren
         max = min + rw.bandSize;
         if (n == bandCnt -1 || max > yMax) max = yMax;
 
+        //Nothing in this band
+        if (rw.edges) {
+            rw.bandEdges = bandEdges + bandStart[n];
+            rw.bandEdgesCnt = bandStart[n + 1] - bandStart[n];
+            if (rw.bandEdgesCnt == 0) continue;
+        }
+
         bands[0].min = min;
         bands[0].max = max;
         band = bands;
@@ -878,7 +2151,7 @@ SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& ren
 
             /* This is too complex for a single scanline; there must
                be some problems */
-            if (middle == bottom) goto error;
+            if (middle == bottom) goto overflow;
 
             if (bottom - top >= rw.bandSize) ++rw.bandShoot;
 
@@ -893,15 +2166,193 @@ SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& ren
     if (rw.bandShoot > 8 && rw.bandSize > 16)
         rw.bandSize = (rw.bandSize >> 1);
 
+    free(rw.edges);
+    free(bandEdges);
+
     return rw.rle;
 
+overflow:
+    free(rw.edges);
+    free(bandEdges);
+    rw.edges = nullptr;
+    bandEdges = nullptr;
+
+    //The accumulation has no limit of the edges in a row.
+    rw.rle->size = spansCnt;
+    if (_accRender(rw.rle, outline, renderRegion, antiAlias, flatness)) return rw.rle;
+
 error:
+    free(rw.edges);
+    free(bandEdges);
     free(rw.rle);
     rw.rle = nullptr;
     return nullptr;
 }
 
 
+SwRleData* rleRenderRoundRect(SwRleData* rle, const Point& min, const Point& max, float rx, float ry, const SwBBox& renderRegion)
+{
+    auto w = renderRegion.max.x - renderRegion.min.x;
+    auto h = renderRegion.max.y - renderRegion.min.y;
+
+    if (!rle) rle = static_cast<SwRleData*>(calloc(1, sizeof(SwRleData)));
+    if (!rle || w <= 0 || h <= 0) return rle;
+
+    auto row = static_cast<float*>(calloc(w, sizeof(float)));
+    if (!row) {
+        rleFree(rle);
+        return nullptr;
+    }
+
+    //The geometry in the region
+    auto x0 = min.x - renderRegion.min.x;
+    auto x1 = max.x - renderRegion.min.x;
+    auto y0 = min.y - renderRegion.min.y;
+    auto y1 = max.y - renderRegion.min.y;
+    auto yA = y0 + ry;
+    auto yB = y1 - ry;
+    if (yA > yB) yA = yB = 0.5f * (y0 + y1);
+
+    auto ikx = (rx > 0.0f) ? 1.0f / rx : 0.0f;
+    auto iry = (ry > 0.0f) ? 1.0f / ry : 0.0f;
+    RoundArc left[3] = {{x0 + rx, -rx, yA, ry, -ikx, iry}, {x0, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}, {x0 + rx, -rx, yB, ry, -ikx, iry}};
+    RoundArc right[3] = {{x1 - rx, rx, yA, ry, ikx, iry}, {x1, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f}, {x1 - rx, rx, yB, ry, ikx, iry}};
+    auto mirror = x0 + x1;
+
+    auto top = _roundFloor(y0, h);
+    if (top < 0) top = 0;
+    auto bottom = _roundFloor(y1, h) + 1;
+    if (bottom > h) bottom = h;
+
+    SwSpan spans[MAX_SPANS];
+    auto cnt = 0;
+    auto xb = _roundLeft(left, (y0 > top) ? y0 : static_cast<float>(top), yA, yB);
+
+    //The full rows between the arcs are the same, the spans of the first one are repeated.
+    SwSpan repeat[4];
+    auto repeatCnt = 0;
+
+    for (auto r = top; r < bottom; ++r) {
+        auto ta = (y0 > r) ? y0 : static_cast<float>(r);
+        auto tb = (y1 < r + 1) ? y1 : static_cast<float>(r + 1);
+        if (ta >= tb) continue;
+
+        //The sides at the borders of the row, both of them are shared with the neighbors.
+        auto xa = xb;
+        xb = _roundLeft(left, tb, yA, yB);
+
+        auto y = renderRegion.min.y + r;
+        auto straight = (ta >= yA && tb <= yB && tb - ta == 1.0f);
+
+        if (straight && repeatCnt > 0) {
+            for (auto i = 0; i < repeatCnt; ++i) _accSpan(rle, spans, cnt, repeat[i].x, y, repeat[i].len, repeat[i].coverage);
+            continue;
+        }
+
+        //The arcs of the top, the lines and the arcs of the bottom. They meet on the lines.
+        float from[3] = {ta, (yA > ta) ? yA : ta, (yB > ta) ? yB : ta};
+        float to[3] = {(yA < tb) ? yA : tb, (yB < tb) ? yB : tb, tb};
+
+        SwCoord loL = w, hiL = -1, loR = w, hiR = -1;
+        for (int i = 0; i < 3; ++i) {
+            auto xf = (from[i] == ta) ? xa : x0;
+            auto xt = (to[i] == tb) ? xb : x0;
+            if (from[i] >= to[i]) continue;
+            _roundSide(row, w, left[i], from[i], to[i], xf, xt, 1.0f, loL, hiL);
+            _roundSide(row, w, right[i], from[i], to[i], mirror - xf, mirror - xt, -1.0f, loR, hiR);
+        }
+
+        auto first = cnt;
+
+        //The row is on the right of the region.
+        if (hiL < loL) {
+            if (hiR >= loR) memset(row + loR, 0, (hiR - loR + 1) * sizeof(float));
+        //The sides share the pixels.
+        } else if (hiR >= loR && loR <= hiL + 1) {
+            _roundSum(rle, spans, cnt, row, (loL < loR) ? loL : loR, (hiL > hiR) ? hiL : hiR, 0.0f, renderRegion.min.x, y);
+        } else {
+            auto winding = _roundSum(rle, spans, cnt, row, loL, hiL, 0.0f, renderRegion.min.x, y);
+
+            //The inside, up to the right side or the end of the region
+            auto end = (hiR >= loR) ? loR : w;
+            auto coverage = _accCoverage(winding, false);
+            if (end > hiL + 1 && coverage > 0) _accSpan(rle, spans, cnt, renderRegion.min.x + hiL + 1, y, end - hiL - 1, coverage);
+
+            if (hiR >= loR) _roundSum(rle, spans, cnt, row, loR, hiR, winding, renderRegion.min.x, y);
+        }
+
+        if (straight && cnt > first && cnt - first <= 4) {
+            repeatCnt = cnt - first;
+            memcpy(repeat, spans + first, repeatCnt * sizeof(SwSpan));
+        }
+    }
+    if (cnt > 0) _genSpan(rle, spans, cnt);
+
+    free(row);
+
+    return rle;
+}
+
+
+SwRleData* rleRenderHairline(SwRleData* rle, const SwOutline* outline, const SwStroke* stroke, const SwBBox& renderRegion)
+{
+    HairWorker hw;
+    hw.w = renderRegion.max.x - renderRegion.min.x;
+    hw.h = renderRegion.max.y - renderRegion.min.y;
+    hw.minX = renderRegion.min.x << PIXEL_BITS;
+    hw.minY = renderRegion.min.y << PIXEL_BITS;
+    hw.hx = stroke->width * stroke->sx / 64.0f;
+    hw.hy = stroke->width * stroke->sy / 64.0f;
+    hw.flatness = SATURATE_SWCOORD(stroke->flatness * ONE_PIXEL);
+
+    if (!rle) rle = static_cast<SwRleData*>(calloc(1, sizeof(SwRleData)));
+    if (!rle || hw.w <= 0 || hw.h <= 0) return rle;
+
+    hw.tilesX = (hw.w + HAIR_TILE - 1) >> HAIR_TILE_BITS;
+    auto tilesCnt = hw.tilesX * ((hw.h + HAIR_TILE - 1) >> HAIR_TILE_BITS);
+    hw.tiles = static_cast<uint16_t**>(calloc(tilesCnt, sizeof(uint16_t*)));
+    if (!hw.tiles) return rle;
+
+    uint32_t first = 0;
+
+    for (uint32_t i = 0; i < outline->cntrsCnt; ++i) {
+        auto last = outline->cntrs[i];  //index of last point in contour
+
+        //Skip empty points
+        if (last <= first) {
+            first = last + 1;
+            continue;
+        }
+
+        auto pt = outline->pts + first;
+        auto types = outline->types + first;
+        auto limit = outline->pts + last;
+
+        while (pt < limit) {
+            if (types[1] == SW_CURVE_TYPE_CUBIC) {
+                if (pt + 3 > limit) break;
+                _hairCubicTo(hw, UPSCALE(pt[0]), UPSCALE(pt[1]), UPSCALE(pt[2]), UPSCALE(pt[3]));
+                pt += 3;
+                types += 3;
+            } else {
+                _hairLineTo(hw, UPSCALE(pt[0]), UPSCALE(pt[1]));
+                ++pt;
+                ++types;
+            }
+        }
+
+        first = last + 1;
+    }
+
+    _hairSweep(hw, rle);
+
+    for (SwCoord i = 0; i < tilesCnt; ++i) free(hw.tiles[i]);
+    free(hw.tiles);
+
+    return rle;
+}
+
+
 void rleReset(SwRleData* rle)
 {
     if (!rle) return;
@@ -19,6 +19,8 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+#include <math.h>
+#include <float.h>
 #include "tvgSwCommon.h"
 #include "tvgBezier.h"
 
@@ -33,21 +35,9 @@ struct Line
 };
 
 
-static float _lineLength(const Point& pt1, const Point& pt2)
-{
-    /* approximate sqrt(x*x + y*y) using alpha max plus beta min algorithm.
-       With alpha = 1, beta = 3/8, giving results with the largest error less
-       than 7% compared to the exact value. */
-    Point diff = {pt2.x - pt1.x, pt2.y - pt1.y};
-    if (diff.x < 0) diff.x = -diff.x;
-    if (diff.y < 0) diff.y = -diff.y;
-    return (diff.x > diff.y) ? (diff.x + diff.y * 0.375f) : (diff.y + diff.x * 0.375f);
-}
-
-
 static void _lineSplitAt(const Line& cur, float at, Line& left, Line& right)
 {
-    auto len = _lineLength(cur.pt1, cur.pt2);
+    auto len = lineLength(cur.pt1, cur.pt2);
     auto dx = ((cur.pt2.x - cur.pt1.x) / len) * at;
     auto dy = ((cur.pt2.y - cur.pt1.y) / len) * at;
     left.pt1 = cur.pt1;
@@ -58,10 +48,11 @@ static void _lineSplitAt(const Line& cur, float at, Line& left, Line& right)
 }
 
 
+//Grows by a half of the current size at least, the outlines of the pool are reused.
 static void _growOutlineContour(SwOutline& outline, uint32_t n)
 {
     if (outline.reservedCntrsCnt >= outline.cntrsCnt + n) return;
-    outline.reservedCntrsCnt = outline.cntrsCnt + n;
+    outline.reservedCntrsCnt = outline.cntrsCnt + n + (outline.cntrsCnt >> 1);
     outline.cntrs = static_cast<uint32_t*>(realloc(outline.cntrs, outline.reservedCntrsCnt * sizeof(uint32_t)));
 }
 
@@ -69,7 +60,7 @@ static void _growOutlineContour(SwOutline& outline, uint32_t n)
 static void _growOutlinePoint(SwOutline& outline, uint32_t n)
 {
     if (outline.reservedPtsCnt >= outline.ptsCnt + n) return;
-    outline.reservedPtsCnt = outline.ptsCnt + n;
+    outline.reservedPtsCnt = outline.ptsCnt + n + (outline.ptsCnt >> 1);
     outline.pts = static_cast<SwPoint*>(realloc(outline.pts, outline.reservedPtsCnt * sizeof(SwPoint)));
     outline.types = static_cast<uint8_t*>(realloc(outline.types, outline.reservedPtsCnt * sizeof(uint8_t)));
 }
@@ -157,13 +148,89 @@ static void _outlineClose(SwOutline& outline)
 }
 
 
-static void _dashLineTo(SwDashStroke& dash, const Point* to, const Matrix* transform)
+static void _dashNext(SwDashStroke& dash)
 {
-    _growOutlinePoint(*dash.outline, dash.outline->ptsCnt >> 1);
-    _growOutlineContour(*dash.outline, dash.outline->cntrsCnt >> 1);
+    dash.curIdx = (dash.curIdx + 1) % dash.cnt;
+    dash.curLen = dash.pattern[dash.curIdx];
+    dash.curOpGap = !dash.curOpGap;
+}
+
+
+//Moves along the pattern without the dashes, the whole periods are skipped at once.
+static void _dashAdvance(SwDashStroke& dash, float len)
+{
+    if (len < dash.curLen) {
+        dash.curLen -= len;
+        return;
+    }
+    len -= dash.curLen;
+    _dashNext(dash);
+
+    if (len > dash.period) len = fmodf(len, dash.period);
+
+    while (len > dash.curLen) {
+        len -= dash.curLen;
+        _dashNext(dash);
+    }
+    dash.curLen -= len;
+}
+
+
+//As the dashing does, a dash left shorter than 1 is skipped at the end of a segment, if it's not the first one.
+static void _dashSegmentEnd(SwDashStroke& dash, float len, float begin)
+{
+    if (len >= begin && dash.curLen < 1 && TO_SWCOORD(dash.pattern[dash.curIdx] - dash.curLen) > 1) _dashNext(dash);
+}
+
+
+//The point in the 26.6 device space, not rounded.
+static Point _dashDevice(const Point* pt, const Matrix* transform)
+{
+    if (!transform) return {pt->x * 64.0f, pt->y * 64.0f};
+    return {(pt->x * transform->e11 + pt->y * transform->e12 + transform->e13) * 64.0f,
+            (pt->x * transform->e21 + pt->y * transform->e22 + transform->e23) * 64.0f};
+}
+
+
+static inline uint32_t _dashOutcode(const SwBBox& box, const Point& pt)
+{
+    return (pt.x < box.min.x ? 1 : 0) | (pt.x > box.max.x ? 2 : 0) | (pt.y < box.min.y ? 4 : 0) | (pt.y > box.max.y ? 8 : 0);
+}
+
+
+//The range of the line in the box (Liang-Barsky), false if there is none.
+static bool _dashVisible(const SwBBox& box, const Point& pt1, const Point& pt2, float& t0, float& t1)
+{
+    auto dx = pt2.x - pt1.x;
+    auto dy = pt2.y - pt1.y;
+    float p[4] = {-dx, dx, -dy, dy};
+    float q[4] = {pt1.x - box.min.x, box.max.x - pt1.x, pt1.y - box.min.y, box.max.y - pt1.y};
+
+    t0 = 0.0f;
+    t1 = 1.0f;
+
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0f) {
+            if (q[i] < 0.0f) return false;
+            continue;
+        }
+        auto t = q[i] / p[i];
+        if (p[i] < 0.0f) {
+            if (t > t1) return false;
+            if (t > t0) t0 = t;
+        } else {
+            if (t < t0) return false;
+            if (t < t1) t1 = t;
+        }
+    }
+    return t0 < t1;
+}
 
+
+static void _dashLine(SwDashStroke& dash, const Point* to, const Matrix* transform, bool end)
+{
     Line cur = {dash.ptCur, *to};
-    auto len = _lineLength(cur.pt1, cur.pt2);
+    auto len = lineLength(cur.pt1, cur.pt2);
 
     if (len < dash.curLen) {
         dash.curLen -= len;
@@ -192,24 +259,58 @@ static void _dashLineTo(SwDashStroke& dash, const Point* to, const Matrix* trans
             _outlineMoveTo(*dash.outline, &cur.pt1, transform);
             _outlineLineTo(*dash.outline, &cur.pt2, transform);
         }
-        if (dash.curLen < 1 && TO_SWCOORD(len) > 1) {
+        if (end && dash.curLen < 1 && TO_SWCOORD(len) > 1) {
             //move to next dash
-            dash.curIdx = (dash.curIdx + 1) % dash.cnt;
-            dash.curLen = dash.pattern[dash.curIdx];
-            dash.curOpGap = !dash.curOpGap;
+            _dashNext(dash);
         }
     }
     dash.ptCur = *to;
 }
 
 
-static void _dashCubicTo(SwDashStroke& dash, const Point* ctrl1, const Point* ctrl2, const Point* to, const Matrix* transform)
+//Only the part in the box is dashed, the pattern is just advanced over the rest.
+static void _dashLineTo(SwDashStroke& dash, const Point* to, const Matrix* transform, const SwBBox& box)
 {
-    _growOutlinePoint(*dash.outline, dash.outline->ptsCnt >> 1);
-    _growOutlineContour(*dash.outline, dash.outline->cntrsCnt >> 1);
+    float t0, t1;
+    auto visible = _dashVisible(box, _dashDevice(&dash.ptCur, transform), _dashDevice(to, transform), t0, t1);
+
+    if (visible && t0 == 0.0f && t1 == 1.0f) {
+        _dashLine(dash, to, transform, true);
+        return;
+    }
 
+    auto len = lineLength(dash.ptCur, *to);
+    auto begin = dash.curLen;
+
+    if (visible) {
+        auto from = dash.ptCur;
+        Point end = {from.x + (to->x - from.x) * t1, from.y + (to->y - from.y) * t1};
+        _dashAdvance(dash, len * t0);
+        dash.ptCur = {from.x + (to->x - from.x) * t0, from.y + (to->y - from.y) * t0};
+        _dashLine(dash, &end, transform, false);
+        _dashAdvance(dash, len * (1.0f - t1));
+    } else {
+        _dashAdvance(dash, len);
+    }
+    _dashSegmentEnd(dash, len, begin);
+    dash.ptCur = *to;
+}
+
+
+static void _dashCubicTo(SwDashStroke& dash, const Point* ctrl1, const Point* ctrl2, const Point* to, const Matrix* transform, const SwBBox& box)
+{
     Bezier cur = {dash.ptCur, *ctrl1, *ctrl2, *to};
-    auto len = bezLength(cur);
+    auto len = bezLength(cur, dash.tolerance);
+
+    //A curve beyond a box line can't show any dash.
+    if (_dashOutcode(box, _dashDevice(&cur.start, transform)) & _dashOutcode(box, _dashDevice(ctrl1, transform)) &
+        _dashOutcode(box, _dashDevice(ctrl2, transform)) & _dashOutcode(box, _dashDevice(to, transform))) {
+        auto begin = dash.curLen;
+        _dashAdvance(dash, len);
+        _dashSegmentEnd(dash, len, begin);
+        dash.ptCur = *to;
+        return;
+    }
 
     if (len < dash.curLen) {
         dash.curLen -= len;
@@ -221,7 +322,7 @@ static void _dashCubicTo(SwDashStroke& dash, const Point* ctrl1, const Point* ct
         while (len > dash.curLen) {
             Bezier left, right;
             len -= dash.curLen;
-            bezSplitAt(cur, dash.curLen, left, right);
+            bezSplitAt(cur, dash.curLen, left, right, dash.tolerance);
             dash.curIdx = (dash.curIdx + 1) % dash.cnt;
             if (!dash.curOpGap) {
                 _outlineMoveTo(*dash.outline, &left.start, transform);
@@ -240,16 +341,14 @@ static void _dashCubicTo(SwDashStroke& dash, const Point* ctrl1, const Point* ct
         }
         if (dash.curLen < 1 && TO_SWCOORD(len) > 1) {
             //move to next dash
-            dash.curIdx = (dash.curIdx + 1) % dash.cnt;
-            dash.curLen = dash.pattern[dash.curIdx];
-            dash.curOpGap = !dash.curOpGap;
+            _dashNext(dash);
         }
     }
     dash.ptCur = *to;
 }
 
 
-static SwOutline* _genDashOutline(const Shape* sdata, const Matrix* transform)
+static SwOutline* _genDashOutline(const Shape* sdata, const Matrix* transform, const SwStroke* stroke, const SwBBox& preClip, SwMpool* mpool, unsigned tid)
 {
     const PathCommand* cmds = nullptr;
     auto cmdCnt = sdata->pathCommands(&cmds);
@@ -268,51 +367,31 @@ static SwOutline* _genDashOutline(const Shape* sdata, const Matrix* transform)
     dash.curOpGap = false;
 
     const float* pattern;
-    dash.cnt = sdata->strokeDash(&pattern);
+    float offset;
+    dash.cnt = sdata->strokeDash(&pattern, &offset);
     if (dash.cnt == 0) return nullptr;
 
-    //OPTMIZE ME: Use mempool???
     dash.pattern = const_cast<float*>(pattern);
-    dash.outline = static_cast<SwOutline*>(calloc(1, sizeof(SwOutline)));
-    dash.outline->opened = true;
 
-    //smart reservation
-    auto outlinePtsCnt = 0;
-    auto outlineCntrsCnt = 0;
+    //The dashes and the gaps are swapped in the next round of an odd pattern.
+    dash.period = 0;
+    for (uint32_t i = 0; i < dash.cnt; ++i) dash.period += dash.pattern[i];
+    if (dash.cnt % 2) dash.period *= 2;
 
-    for (uint32_t i = 0; i < cmdCnt; ++i) {
-        switch(*(cmds + i)) {
-            case PathCommand::Close: {
-                ++outlinePtsCnt;
-                break;
-            }
-            case PathCommand::MoveTo: {
-                ++outlineCntrsCnt;
-                ++outlinePtsCnt;
-                break;
-            }
-            case PathCommand::LineTo: {
-                ++outlinePtsCnt;
-                break;
-            }
-            case PathCommand::CubicTo: {
-                outlinePtsCnt += 3;
-                break;
-            }
-        }
-    }
+    offset = fmodf(offset, dash.period);
+    if (offset < 0) offset += dash.period;
 
-    ++outlinePtsCnt;    //for close
-    ++outlineCntrsCnt;  //for end
+    //The curves are measured in the user space, as precisely as they are drawn.
+    dash.tolerance = stroke->flatness / ((stroke->sx > stroke->sy) ? stroke->sx : stroke->sy);
 
-    //Reserve Approximitely 20x...
-    _growOutlinePoint(*dash.outline, outlinePtsCnt * 20);
-    _growOutlineContour(*dash.outline, outlineCntrsCnt * 20);
+    //The outline grows on demand, it's reused by the next dashing of the thread.
+    dash.outline = mpoolReqDashOutline(mpool, tid);
+    dash.outline->opened = true;
 
     while (cmdCnt-- > 0) {
         switch(*cmds) {
             case PathCommand::Close: {
-                _dashLineTo(dash, &dash.ptStart, transform);
+                _dashLineTo(dash, &dash.ptStart, transform, preClip);
                 break;
             }
             case PathCommand::MoveTo: {
@@ -320,17 +399,18 @@ static SwOutline* _genDashOutline(const Shape* sdata, const Matrix* transform)
                 dash.curIdx = 0;
                 dash.curLen = *dash.pattern;
                 dash.curOpGap = false;
+                if (offset > 0) _dashAdvance(dash, offset);
                 dash.ptStart = dash.ptCur = *pts;
                 ++pts;
                 break;
             }
             case PathCommand::LineTo: {
-                _dashLineTo(dash, pts, transform);
+                _dashLineTo(dash, pts, transform, preClip);
                 ++pts;
                 break;
             }
             case PathCommand::CubicTo: {
-                _dashCubicTo(dash, pts, pts + 1, pts + 2, transform);
+                _dashCubicTo(dash, pts, pts + 1, pts + 2, transform, preClip);
                 pts += 3;
                 break;
             }
@@ -364,7 +444,448 @@ static bool _fastTrack(const SwOutline* outline)
 
 
 
-static bool _genOutline(SwShape* shape, const Shape* sdata, const Matrix* transform, SwMpool* mpool, unsigned tid)
+/* The rectangles and the ellipses keep their forms in the device space if the transform keeps the axes,
+   and the circles also under the rotations. Then their coverages are computed from the arcs straight. */
+static bool _primitive(const RenderPrimitive* primitive, const Matrix* transform, Point& min, Point& max, Point& radius)
+{
+    //Far enough for the pixel coordinates, and not a number fails it.
+    constexpr auto LIMIT = static_cast<float>(1 << 24);
+
+    if (!primitive || !primitive->valid) return false;
+
+    auto x = primitive->x;
+    auto y = primitive->y;
+    auto w = primitive->w;
+    auto h = primitive->h;
+    auto rx = primitive->rx;
+    auto ry = primitive->ry;
+
+    if (!transform) {
+        min = {x, y};
+        max = {x + w, y + h};
+        radius = {rx, ry};
+    } else if (fabsf(transform->e12) < FLT_EPSILON && fabsf(transform->e21) < FLT_EPSILON) {
+        auto x0 = transform->e11 * x + transform->e13;
+        auto x1 = transform->e11 * (x + w) + transform->e13;
+        auto y0 = transform->e22 * y + transform->e23;
+        auto y1 = transform->e22 * (y + h) + transform->e23;
+        min = {(x0 < x1) ? x0 : x1, (y0 < y1) ? y0 : y1};
+        max = {(x0 < x1) ? x1 : x0, (y0 < y1) ? y1 : y0};
+        radius = {fabsf(transform->e11) * rx, fabsf(transform->e22) * ry};
+    } else {
+        if (fabsf(w - h) > FLT_EPSILON || fabsf(rx - ry) > FLT_EPSILON || fabsf(rx * 2.0f - w) > FLT_EPSILON) return false;
+        //The columns of a similarity are orthogonal and of the same length.
+        auto sx = transform->e11 * transform->e11 + transform->e21 * transform->e21;
+        auto sy = transform->e12 * transform->e12 + transform->e22 * transform->e22;
+        auto dot = transform->e11 * transform->e12 + transform->e21 * transform->e22;
+        if (fabsf(sx - sy) > sx * 1e-5f || fabsf(dot) > sx * 1e-5f) return false;
+        auto cx = x + rx;
+        auto cy = y + ry;
+        auto c = Point{transform->e11 * cx + transform->e12 * cy + transform->e13, transform->e21 * cx + transform->e22 * cy + transform->e23};
+        auto r = rx * sqrtf(sx);
+        min = {c.x - r, c.y - r};
+        max = {c.x + r, c.y + r};
+        radius = {r, r};
+    }
+
+    if (!(fabsf(min.x) < LIMIT && fabsf(min.y) < LIMIT && fabsf(max.x) < LIMIT && fabsf(max.y) < LIMIT)) return false;
+    return (max.x > min.x && max.y > min.y);
+}
+
+
+/* Pre-clip of the offscreen geometry: the segments are split at the lines of the box and the
+   pieces outside are clamped onto the box, then the runs on a box line are merged into a line.
+   For the filling it keeps the winding of the box area, for the stroking the box margin is
+   wider than the stroke so the clamped edges are not visible.
+   The points are wider than SwCoord until they are clamped, the far lines keep their directions. */
+struct SwClipPoint
+{
+    int64_t x, y;
+};
+
+
+struct SwPreClip
+{
+    SwBBox box;         //clip region with a margin, in 26.6
+    SwClipPoint start;  //first point of the contour, not clamped
+    SwClipPoint cur;    //last point of the contour, not clamped
+    bool fill;          //close the contours as the rasterizer does
+    bool clipped;       //any point is clamped
+};
+
+
+static inline int64_t _clipCoord(float val)
+{
+    constexpr auto LIMIT = static_cast<int64_t>(1) << 60;
+    if (val > -LIMIT && val < LIMIT) return static_cast<int64_t>(val);
+    return (val > 0) ? LIMIT : -LIMIT;   //nan as well
+}
+
+
+//Same as mathTransform() but in the wide range
+static inline SwClipPoint _clipTransform(const Point* to, const Matrix* transform)
+{
+    if (!transform) return {_clipCoord(to->x * 64), _clipCoord(to->y * 64)};
+
+    auto tx = to->x * transform->e11 + to->y * transform->e12 + transform->e13;
+    auto ty = to->x * transform->e21 + to->y * transform->e22 + transform->e23;
+
+    return {_clipCoord(tx * 64), _clipCoord(ty * 64)};
+}
+
+
+static inline bool _far(const SwClipPoint& pt)
+{
+    return (pt.x < -SW_COORD_LIMIT || pt.x > SW_COORD_LIMIT || pt.y < -SW_COORD_LIMIT || pt.y > SW_COORD_LIMIT);
+}
+
+
+//The curves still too far after the splits are kept, with the saturated points
+static inline SwPoint _saturate(const SwClipPoint& pt)
+{
+    return {SwCoord(pt.x < -SW_COORD_LIMIT ? -SW_COORD_LIMIT : (pt.x > SW_COORD_LIMIT ? SW_COORD_LIMIT : pt.x)),
+            SwCoord(pt.y < -SW_COORD_LIMIT ? -SW_COORD_LIMIT : (pt.y > SW_COORD_LIMIT ? SW_COORD_LIMIT : pt.y))};
+}
+
+
+static inline SwPoint _clamp(const SwBBox& box, const SwClipPoint& pt)
+{
+    return {SwCoord(pt.x < box.min.x ? box.min.x : (pt.x > box.max.x ? box.max.x : pt.x)),
+            SwCoord(pt.y < box.min.y ? box.min.y : (pt.y > box.max.y ? box.max.y : pt.y))};
+}
+
+
+//Which lines of the box the point is beyond
+static inline uint32_t _outcode(const SwBBox& box, const SwClipPoint& pt)
+{
+    return (pt.x < box.min.x ? 1 : 0) | (pt.x > box.max.x ? 2 : 0) | (pt.y < box.min.y ? 4 : 0) | (pt.y > box.max.y ? 8 : 0);
+}
+
+
+static inline bool _onLine(const SwBBox& box, const SwPoint& pt1, const SwPoint& pt2, const SwPoint& pt3)
+{
+    return ((pt1.x == box.min.x && pt2.x == box.min.x && pt3.x == box.min.x) ||
+            (pt1.x == box.max.x && pt2.x == box.max.x && pt3.x == box.max.x) ||
+            (pt1.y == box.min.y && pt2.y == box.min.y && pt3.y == box.min.y) ||
+            (pt1.y == box.max.y && pt2.y == box.max.y && pt3.y == box.max.y));
+}
+
+
+//Append a clamped point, the repeated ones and the runs on a box line are merged.
+static void _clipPush(SwOutline& outline, SwPreClip& clip, const SwPoint& pt)
+{
+    clip.clipped = true;
+
+    auto first = (outline.cntrsCnt > 0) ? outline.cntrs[outline.cntrsCnt - 1] + 1 : 0;
+    auto cnt = outline.ptsCnt - first;
+
+    if (cnt > 0) {
+        auto last = outline.pts + outline.ptsCnt - 1;
+        if (*last == pt) return;
+        if (cnt > 1 && outline.types[outline.ptsCnt - 2] == SW_CURVE_TYPE_POINT && _onLine(clip.box, last[-1], *last, pt)) {
+            *last = pt;
+            return;
+        }
+    }
+
+    _growOutlinePoint(outline, 1);
+    outline.pts[outline.ptsCnt] = pt;
+    outline.types[outline.ptsCnt] = SW_CURVE_TYPE_POINT;
+    ++outline.ptsCnt;
+}
+
+
+static void _clipLine(SwOutline& outline, SwPreClip& clip, const SwClipPoint& to, bool end)
+{
+    auto& box = clip.box;
+    auto from = clip.cur;
+    clip.cur = to;
+
+    auto code1 = _outcode(box, from);
+    auto code2 = _outcode(box, to);
+
+    if (!(code1 | code2)) {
+        if (end) {
+            _growOutlinePoint(outline, 1);
+            outline.pts[outline.ptsCnt] = {SwCoord(to.x), SwCoord(to.y)};
+            outline.types[outline.ptsCnt] = SW_CURVE_TYPE_POINT;
+            ++outline.ptsCnt;
+        }
+        return;
+    }
+
+    //Both beyond the same box line: the clamped line is the clamp of the line.
+    if (!(code1 & code2)) {
+        //Split at the box lines, so that each piece stays in a single area around the box.
+        auto dx = double(to.x - from.x);
+        auto dy = double(to.y - from.y);
+        double ts[4];
+        auto cnt = 0;
+        if ((code1 ^ code2) & 1) ts[cnt++] = (box.min.x - from.x) / dx;
+        if ((code1 ^ code2) & 2) ts[cnt++] = (box.max.x - from.x) / dx;
+        if ((code1 ^ code2) & 4) ts[cnt++] = (box.min.y - from.y) / dy;
+        if ((code1 ^ code2) & 8) ts[cnt++] = (box.max.y - from.y) / dy;
+
+        for (auto i = 1; i < cnt; ++i) {
+            auto t = ts[i];
+            auto j = i;
+            for (; j > 0 && ts[j - 1] > t; --j) ts[j] = ts[j - 1];
+            ts[j] = t;
+        }
+        for (auto i = 0; i < cnt; ++i) {
+            SwClipPoint pt = {from.x + int64_t(round(dx * ts[i])), from.y + int64_t(round(dy * ts[i]))};
+            _clipPush(outline, clip, _clamp(box, pt));
+        }
+    }
+    if (end) _clipPush(outline, clip, _clamp(box, to));
+}
+
+
+static void _clipMoveTo(SwOutline& outline, SwPreClip& clip, const SwClipPoint& to)
+{
+    //Close the previous one as the rasterizer, from the point not clamped.
+    if (clip.fill) _clipLine(outline, clip, clip.start, false);
+
+    _growOutlinePoint(outline, 1);
+    outline.pts[outline.ptsCnt] = _clamp(clip.box, to);
+    outline.types[outline.ptsCnt] = SW_CURVE_TYPE_POINT;
+
+    if (outline.ptsCnt > 0) {
+        _growOutlineContour(outline, 1);
+        outline.cntrs[outline.cntrsCnt] = outline.ptsCnt - 1;
+        ++outline.cntrsCnt;
+    }
+
+    ++outline.ptsCnt;
+
+    clip.start = clip.cur = to;
+}
+
+
+static void _clipCubicTo(SwOutline& outline, SwPreClip& clip, const SwClipPoint& ctrl1, const SwClipPoint& ctrl2, const SwClipPoint& to, int depth = 0)
+{
+    auto& box = clip.box;
+    auto from = clip.cur;
+
+    //A curve beyond a box line counts as the line of its end points.
+    if (_outcode(box, from) & _outcode(box, ctrl1) & _outcode(box, ctrl2) & _outcode(box, to)) {
+        _clipLine(outline, clip, to, true);
+        return;
+    }
+
+    //Split the far ones in halves, until the pieces nearby fit in SwCoord.
+    if (depth < 32 && (_far(from) || _far(ctrl1) || _far(ctrl2) || _far(to))) {
+        SwClipPoint c = {(ctrl1.x + ctrl2.x) / 2, (ctrl1.y + ctrl2.y) / 2};
+        SwClipPoint a1 = {(from.x + ctrl1.x) / 2, (from.y + ctrl1.y) / 2};
+        SwClipPoint b2 = {(ctrl2.x + to.x) / 2, (ctrl2.y + to.y) / 2};
+        SwClipPoint a2 = {(a1.x + c.x) / 2, (a1.y + c.y) / 2};
+        SwClipPoint b1 = {(c.x + b2.x) / 2, (c.y + b2.y) / 2};
+        SwClipPoint mid = {(a2.x + b1.x) / 2, (a2.y + b1.y) / 2};
+        _clipCubicTo(outline, clip, a1, a2, mid, depth + 1);
+        _clipCubicTo(outline, clip, b1, b2, to, depth + 1);
+        return;
+    }
+
+    //Otherwise it's kept, from the point not clamped.
+    if (_outcode(box, from)) _clipPush(outline, clip, _saturate(from));
+
+    _growOutlinePoint(outline, 3);
+    outline.pts[outline.ptsCnt] = _saturate(ctrl1);
+    outline.types[outline.ptsCnt] = SW_CURVE_TYPE_CUBIC;
+    ++outline.ptsCnt;
+    outline.pts[outline.ptsCnt] = _saturate(ctrl2);
+    outline.types[outline.ptsCnt] = SW_CURVE_TYPE_CUBIC;
+    ++outline.ptsCnt;
+    outline.pts[outline.ptsCnt] = _saturate(to);
+    outline.types[outline.ptsCnt] = SW_CURVE_TYPE_POINT;
+    ++outline.ptsCnt;
+
+    clip.cur = to;
+}
+
+
+static void _clipClose(SwOutline& outline, SwPreClip& clip)
+{
+    _clipLine(outline, clip, clip.start, false);
+    _outlineClose(outline);
+}
+
+
+static SwBBox _preClipBox(const SwBBox& clipRegion, SwCoord margin)
+{
+    return {{(clipRegion.min.x << 6) - margin, (clipRegion.min.y << 6) - margin},
+            {(clipRegion.max.x << 6) + margin, (clipRegion.max.y << 6) + margin}};
+}
+
+
+//The path turns enough between the two directions for the stroker to draw a join. (about 3 degrees)
+static bool _turned(const SwPoint& in, const SwPoint& out)
+{
+    auto dot = static_cast<double>(in.x) * out.x + static_cast<double>(in.y) * out.y;
+    auto cross = static_cast<double>(in.x) * out.y - static_cast<double>(in.y) * out.x;
+    return (dot <= 0 || fabs(cross) > 0.05 * dot);
+}
+
+
+//The first non zero direction of the control points, from the start point
+static SwPoint _direction(const SwPoint& from, const SwPoint& p1, const SwPoint& p2, const SwPoint& p3)
+{
+    if (p1 != from) return p1 - from;
+    if (p2 != from) return p2 - from;
+    return p3 - from;
+}
+
+
+//The major axis of the direction, 1 for x, 2 for y
+static int _axis(const SwPoint& d)
+{
+    return (abs(d.x) >= abs(d.y)) ? 1 : 2;
+}
+
+
+//Checks the legs of the control polygon: it folds back for a cusp or a loop, the curve runs along the axes of them.
+static bool _curveLegs(const SwPoint* pts, int& axes)
+{
+    SwPoint prev = {0, 0};
+    for (int i = 0; i < 3; ++i) {
+        auto leg = pts[i + 1] - pts[i];
+        if (leg == SwPoint{0, 0}) continue;
+        if (static_cast<double>(prev.x) * leg.x + static_cast<double>(prev.y) * leg.y < 0) return false;
+        axes |= _axis(leg);
+        prev = leg;
+    }
+    return true;
+}
+
+
+/* No visible joins: the thin lines don't draw them and sum the coverages where the segments overlap.
+   The lines are cut across their major axis, a contour turning over the diagonal would leave the wedges
+   of the crossed cuts, so it runs along a single axis. (which never closes without a join) */
+static bool _smooth(const SwOutline* outline)
+{
+    uint32_t first = 0;
+
+    for (uint32_t i = 0; i < outline->cntrsCnt; ++i) {
+        auto last = outline->cntrs[i];
+        auto pt = outline->pts + first;
+        auto types = outline->types + first;
+        auto limit = outline->pts + last;
+        SwPoint in = {0, 0};
+        auto axes = 0;
+
+        while (pt < limit) {
+            SwPoint out, end;
+            if (types[1] == SW_CURVE_TYPE_CUBIC) {
+                if (pt + 3 > limit) break;
+                if (!_curveLegs(pt, axes)) return false;
+                out = _direction(pt[0], pt[1], pt[2], pt[3]);
+                end = SwPoint{0, 0} - _direction(pt[3], pt[2], pt[1], pt[0]);
+                pt += 3;
+                types += 3;
+            } else {
+                out = end = pt[1] - pt[0];
+                if (out != SwPoint{0, 0}) axes |= _axis(out);
+                ++pt;
+                ++types;
+            }
+            if (axes == 3) return false;
+            if (out == SwPoint{0, 0}) continue;
+            if (in != SwPoint{0, 0} && _turned(in, out)) return false;
+            in = end;
+        }
+        first = last + 1;
+    }
+    return true;
+}
+
+
+//Thin enough to be drawn along the lines without the stroker. (1.5px at most, butt caps, no joins)
+static bool _hairline(const SwStroke* stroke, const SwOutline* outline)
+{
+    if (stroke->cap != StrokeCap::Butt) return false;
+    auto scale = (stroke->sx > stroke->sy) ? stroke->sx : stroke->sy;
+    if (stroke->width * scale * 2 > 96) return false;
+    return _smooth(outline);
+}
+
+
+static bool _hairlineBBox(const SwOutline* outline, SwCoord margin, const SwBBox& clipRegion, SwBBox& renderRegion)
+{
+    if (outline->ptsCnt == 0 || outline->cntrsCnt == 0) return false;
+
+    auto pt = outline->pts;
+    auto xMin = pt->x;
+    auto xMax = pt->x;
+    auto yMin = pt->y;
+    auto yMax = pt->y;
+
+    for (uint32_t i = 1; i < outline->ptsCnt; ++i) {
+        ++pt;
+        if (xMin > pt->x) xMin = pt->x;
+        if (xMax < pt->x) xMax = pt->x;
+        if (yMin > pt->y) yMin = pt->y;
+        if (yMax < pt->y) yMax = pt->y;
+    }
+
+    renderRegion.min.x = (xMin - margin) >> 6;
+    renderRegion.max.x = (xMax + margin + 63) >> 6;
+    renderRegion.min.y = (yMin - margin) >> 6;
+    renderRegion.max.y = (yMax + margin + 63) >> 6;
+
+    if (renderRegion.min.x < clipRegion.min.x) renderRegion.min.x = clipRegion.min.x;
+    if (renderRegion.min.y < clipRegion.min.y) renderRegion.min.y = clipRegion.min.y;
+    if (renderRegion.max.x > clipRegion.max.x) renderRegion.max.x = clipRegion.max.x;
+    if (renderRegion.max.y > clipRegion.max.y) renderRegion.max.y = clipRegion.max.y;
+
+    return (renderRegion.max.x > renderRegion.min.x && renderRegion.max.y > renderRegion.min.y);
+}
+
+
+//The common case, all in the box: nothing to clip, so the points are transformed at once between the closes.
+static bool _genOutlineInBox(SwOutline& outline, const PathCommand* cmds, uint32_t cmdCnt, const Point* pts, const Matrix* transform, const SwBBox& box, bool& closed)
+{
+    auto from = pts;        //the points not transformed yet
+    auto dst = outline.pts + outline.ptsCnt;
+
+    while (cmdCnt-- > 0) {
+        switch(*cmds) {
+            case PathCommand::Close: {
+                if (!mathTransformPoints(from, pts - from, transform, box, dst)) return false;
+                _outlineClose(outline);
+                from = pts;
+                dst = outline.pts + outline.ptsCnt;
+                closed = true;
+                break;
+            }
+            case PathCommand::MoveTo: {
+                if (outline.ptsCnt > 0) {
+                    outline.cntrs[outline.cntrsCnt] = outline.ptsCnt - 1;
+                    ++outline.cntrsCnt;
+                }
+                outline.types[outline.ptsCnt++] = SW_CURVE_TYPE_POINT;
+                ++pts;
+                break;
+            }
+            case PathCommand::LineTo: {
+                outline.types[outline.ptsCnt++] = SW_CURVE_TYPE_POINT;
+                ++pts;
+                break;
+            }
+            case PathCommand::CubicTo: {
+                outline.types[outline.ptsCnt++] = SW_CURVE_TYPE_CUBIC;
+                outline.types[outline.ptsCnt++] = SW_CURVE_TYPE_CUBIC;
+                outline.types[outline.ptsCnt++] = SW_CURVE_TYPE_POINT;
+                pts += 3;
+                break;
+            }
+        }
+        ++cmds;
+    }
+    return mathTransformPoints(from, pts - from, transform, box, dst);
+}
+
+
+static bool _genOutline(SwShape* shape, const Shape* sdata, const Matrix* transform, const SwBBox& preClip, bool fill, SwMpool* mpool, unsigned tid)
 {
     const PathCommand* cmds = nullptr;
     auto cmdCnt = sdata->pathCommands(&cmds);
@@ -414,25 +935,40 @@ static bool _genOutline(SwShape* shape, const Shape* sdata, const Matrix* transf
     auto closed = false;
 
     //Generate Outlines
+    if (_genOutlineInBox(*outline, cmds, cmdCnt, pts, transform, preClip, closed)) {
+        _outlineEnd(*outline);
+        if (closed) outline->opened = false;
+        outline->fillRule = sdata->fillRule();
+        shape->clipped = false;
+        return true;
+    }
+
+    //Some are beyond the box, start over with the clipping.
+    outline->ptsCnt = outline->cntrsCnt = 0;
+    outline->opened = true;
+    closed = false;
+
+    SwPreClip clip = {preClip, {0, 0}, {0, 0}, fill, false};
+
     while (cmdCnt-- > 0) {
         switch(*cmds) {
             case PathCommand::Close: {
-                _outlineClose(*outline);
+                _clipClose(*outline, clip);
                 closed = true;
                 break;
             }
             case PathCommand::MoveTo: {
-                _outlineMoveTo(*outline, pts, transform);
+                _clipMoveTo(*outline, clip, _clipTransform(pts, transform));
                 ++pts;
                 break;
             }
             case PathCommand::LineTo: {
-                _outlineLineTo(*outline, pts, transform);
+                _clipLine(*outline, clip, _clipTransform(pts, transform), true);
                 ++pts;
                 break;
             }
             case PathCommand::CubicTo: {
-                _outlineCubicTo(*outline, pts, pts + 1, pts + 2, transform);
+                _clipCubicTo(*outline, clip, _clipTransform(pts, transform), _clipTransform(pts + 1, transform), _clipTransform(pts + 2, transform));
                 pts += 3;
                 break;
             }
@@ -440,6 +976,9 @@ static bool _genOutline(SwShape* shape, const Shape* sdata, const Matrix* transf
         ++cmds;
     }
 
+    if (fill) _clipLine(*outline, clip, clip.start, false);
+    shape->clipped = clip.clipped;
+
     _outlineEnd(*outline);
 
     if (closed) outline->opened = false;
@@ -457,7 +996,9 @@ static bool _genOutline(SwShape* shape, const Shape* sdata, const Matrix* transf
 
 bool shapePrepare(SwShape* shape, const Shape* sdata, const Matrix* transform,  const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid)
 {
-    if (!_genOutline(shape, sdata, transform, mpool, tid)) return false;
+    //The offscreen parts are reduced to the lines on a box, a bit wider than the clip region.
+    auto preClip = _preClipBox(clipRegion, 2 << 6);
+    if (!_genOutline(shape, sdata, transform, preClip, true, mpool, tid)) return false;
     if (!mathUpdateOutlineBBox(shape->outline, clipRegion, renderRegion)) return false;
 
     //Keep it for Rasterization Region
@@ -480,7 +1021,7 @@ bool shapePrepared(const SwShape* shape)
 }
 
 
-bool shapeGenRle(SwShape* shape, TVG_UNUSED const Shape* sdata, bool antiAlias, bool hasComposite)
+bool shapeGenRle(SwShape* shape, TVG_UNUSED const Shape* sdata, const RenderPrimitive* primitive, const Matrix* transform, bool antiAlias, bool hasComposite, float flatness, SwRasterizer rasterizer)
 {
     //FIXME: Should we draw it?
     //Case: Stroke Line
@@ -488,8 +1029,16 @@ bool shapeGenRle(SwShape* shape, TVG_UNUSED const Shape* sdata, bool antiAlias,
 
     //Case A: Fast Track Rectangle Drawing
     if (!hasComposite && (shape->rect = _fastTrack(shape->outline))) return true;
-    //Case B: Normale Shape RLE Drawing
-    if ((shape->rle = rleRender(shape->rle, shape->outline, shape->bbox, antiAlias))) return true;
+
+    //Case B: Rounded Rectangle & Ellipse Drawing, unless another engine is asked
+    Point min, max, radius;
+    if (antiAlias && rasterizer == SwRasterizer::Auto && _primitive(primitive, transform, min, max, radius)) {
+        if ((shape->rle = rleRenderRoundRect(shape->rle, min, max, radius.x, radius.y, shape->bbox))) return true;
+        return false;
+    }
+
+    //Case C: Normale Shape RLE Drawing
+    if ((shape->rle = rleRender(shape->rle, shape->outline, shape->bbox, antiAlias, flatness, rasterizer))) return true;
 
     return false;
 }
@@ -533,35 +1082,54 @@ void shapeDelStroke(SwShape* shape)
 }
 
 
-void shapeResetStroke(SwShape* shape, const Shape* sdata, const Matrix* transform)
+void shapeResetStroke(SwShape* shape, const Shape* sdata, const Matrix* transform, float flatness)
 {
     if (!shape->stroke) shape->stroke = static_cast<SwStroke*>(calloc(1, sizeof(SwStroke)));
     auto stroke = shape->stroke;
     if (!stroke) return;
 
-    strokeReset(stroke, sdata, transform);
+    strokeReset(stroke, sdata, transform, flatness);
     rleReset(shape->strokeRle);
 }
 
 
-bool shapeGenStrokeRle(SwShape* shape, const Shape* sdata, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid)
+bool shapeGenStrokeRle(SwShape* shape, const Shape* sdata, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid, SwRasterizer rasterizer)
 {
     SwOutline* shapeOutline = nullptr;
     SwOutline* strokeOutline = nullptr;
-    bool freeOutline = false;
+    bool dashOutline = false;
     bool ret = true;
 
+    //Far enough not to show the strokes of the clamped lines and the cut dashes, with their miter joins.
+    auto stroke = shape->stroke;
+    auto scale = (stroke->sx > stroke->sy) ? stroke->sx : stroke->sy;
+    auto margin = stroke->width * scale * 4;
+    if (margin > SW_COORD_LIMIT) margin = SW_COORD_LIMIT;
+    auto preClip = _preClipBox(clipRegion, SwCoord(margin) + (2 << 6));
+
     //Dash Style Stroke
     if (sdata->strokeDash(nullptr) > 0) {
-        shapeOutline = _genDashOutline(sdata, transform);
+        shapeOutline = _genDashOutline(sdata, transform, stroke, preClip, mpool, tid);
         if (!shapeOutline) return false;
-        freeOutline = true;
+        dashOutline = true;
+        //All the dashes are offscreen
+        if (shapeOutline->ptsCnt == 0) goto fail;
     //Normal Style stroke
     } else {
-        if (!shape->outline) {
-            if (!_genOutline(shape, sdata, transform, mpool, tid)) return false;
+        //The outline of the filling can't be stroked if it's pre-clipped.
+        if (!shape->outline || shape->clipped) {
+            if (shape->outline) shapeDelOutline(shape, mpool, tid);
+            if (!_genOutline(shape, sdata, transform, preClip, false, mpool, tid)) return false;
         }
         shapeOutline = shape->outline;
+
+        //The thin lines are anti-aliased by their nature.
+        if (_hairline(stroke, shapeOutline) && rasterizer != SwRasterizer::Aliased) {
+            //Half width and the square cap, with a pixel of the anti-aliasing.
+            if (!_hairlineBBox(shapeOutline, SwCoord(stroke->width * scale * 2) + (1 << 6), clipRegion, renderRegion)) return false;
+            shape->strokeRle = rleRenderHairline(shape->strokeRle, shapeOutline, stroke, renderRegion);
+            return true;
+        }
     }
 
     if (!strokeParseOutline(shape->stroke, *shapeOutline)) {
@@ -580,15 +1148,10 @@ bool shapeGenStrokeRle(SwShape* shape, const Shape* sdata, const Matrix* transfo
         goto fail;
     }
 
-    shape->strokeRle = rleRender(shape->strokeRle, strokeOutline, renderRegion, true);
+    shape->strokeRle = rleRender(shape->strokeRle, strokeOutline, renderRegion, true, stroke->flatness, rasterizer);
 
 fail:
-    if (freeOutline) {
-        if (shapeOutline->cntrs) free(shapeOutline->cntrs);
-        if (shapeOutline->pts) free(shapeOutline->pts);
-        if (shapeOutline->types) free(shapeOutline->types);
-        free(shapeOutline);
-    }
+    if (dashOutline) mpoolRetDashOutline(mpool, tid);
     mpoolRetStrokeOutline(mpool, tid);
 
     return ret;
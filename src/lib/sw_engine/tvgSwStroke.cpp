@@ -19,6 +19,8 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+#define _USE_MATH_DEFINES       //Math Constants are not defined in Standard C/C++.
+
 #include <string.h>
 #include <math.h>
 #include "tvgSwCommon.h"
@@ -40,8 +42,8 @@ static inline SwFixed SIDE_TO_ROTATE(const int32_t s)
 
 static inline void SCALE(const SwStroke& stroke, SwPoint& pt)
 {
-    pt.x *= stroke.sx;
-    pt.y *= stroke.sy;
+    pt.x = SATURATE_SWCOORD(pt.x * stroke.sx);
+    pt.y = SATURATE_SWCOORD(pt.y * stroke.sy);
 }
 
 
@@ -446,7 +448,7 @@ static void _cubicTo(SwStroke& stroke, const SwPoint& ctrl1, const SwPoint& ctrl
         //initialize with current direction
         angleIn = angleOut = angleMid = stroke.angleIn;
 
-        if (arc < limit && !mathSmallCubic(arc, angleIn, angleMid, angleOut)) {
+        if (arc < limit && !mathSmallCubic(arc, angleIn, angleMid, angleOut, stroke.angleLimit)) {
             if (stroke.firstPt) stroke.angleIn = angleIn;
             mathSplitCubic(arc);
             arc += 3;
@@ -826,7 +828,7 @@ void strokeFree(SwStroke* stroke)
 }
 
 
-void strokeReset(SwStroke* stroke, const Shape* sdata, const Matrix* transform)
+void strokeReset(SwStroke* stroke, const Shape* sdata, const Matrix* transform, float flatness)
 {
     if (transform) {
         stroke->sx = sqrt(pow(transform->e11, 2) + pow(transform->e21, 2));
@@ -837,6 +839,16 @@ void strokeReset(SwStroke* stroke, const Shape* sdata, const Matrix* transform)
 
     stroke->width = HALF_STROKE(sdata->strokeWidth());
     stroke->cap = sdata->strokeCap();
+    stroke->flatness = flatness;
+
+    /* The borders of a curve piece deviate up to about width * turn^2 / 2 from the exact offset,
+       where the turn is the angle between the legs of the control polygon.
+       The thinner strokes can be offset with the bigger pieces. */
+    auto width = stroke->width * ((stroke->sx > stroke->sy) ? stroke->sx : stroke->sy) / 64.0f;
+    auto turn = (width > 0.0f) ? sqrtf(2.0f * flatness / width) * (SW_ANGLE_PI / M_PI) : SW_ANGLE_PI4;
+    if (turn > SW_ANGLE_PI4) turn = SW_ANGLE_PI4;
+    else if (turn < SW_ANGLE_PI / 16) turn = SW_ANGLE_PI / 16;
+    stroke->angleLimit = static_cast<SwFixed>(turn);
 
     //Save line join: it can be temporarily changed when stroking curves...
     stroke->joinSaved = stroke->join = sdata->strokeJoin();
@@ -24,28 +24,20 @@
 #include "tvgBezier.h"
 
 /************************************************************************/
-/* Internal Class Implementation                                        */
+/* External Class Implementation                                        */
 /************************************************************************/
 
-static float _lineLength(const Point& pt1, const Point& pt2)
+namespace tvg
+{
+
+float lineLength(const Point& pt1, const Point& pt2)
 {
-    /* approximate sqrt(x*x + y*y) using alpha max plus beta min algorithm.
-       With alpha = 1, beta = 3/8, giving results with the largest error less
-       than 7% compared to the exact value. */
+    //Exact, the dashes and the tolerance of the measuring are meaningless with an estimation of 7% error.
     Point diff = {pt2.x - pt1.x, pt2.y - pt1.y};
-    if (diff.x < 0) diff.x = -diff.x;
-    if (diff.y < 0) diff.y = -diff.y;
-    return (diff.x > diff.y) ? (diff.x + diff.y * 0.375f) : (diff.y + diff.x * 0.375f);
+    return sqrtf(diff.x * diff.x + diff.y * diff.y);
 }
 
 
-/************************************************************************/
-/* External Class Implementation                                        */
-/************************************************************************/
-
-namespace tvg
-{
-
 void bezSplit(const Bezier&cur, Bezier& left, Bezier& right)
 {
     auto c = (cur.ctrl1.x + cur.ctrl2.x) * 0.5f;
@@ -68,17 +60,18 @@ void bezSplit(const Bezier&cur, Bezier& left, Bezier& right)
 }
 
 
-float bezLength(const Bezier& cur)
+float bezLength(const Bezier& cur, float tolerance)
 {
     Bezier left, right;
-    auto len = _lineLength(cur.start, cur.ctrl1) + _lineLength(cur.ctrl1, cur.ctrl2) + _lineLength(cur.ctrl2, cur.end);
-    auto chord = _lineLength(cur.start, cur.end);
+    auto len = lineLength(cur.start, cur.ctrl1) + lineLength(cur.ctrl1, cur.ctrl2) + lineLength(cur.ctrl2, cur.end);
+    auto chord = lineLength(cur.start, cur.end);
 
-    if (fabs(len - chord) > BEZIER_EPSILON) {
+    if (fabs(len - chord) > tolerance) {
         bezSplit(cur, left, right);
-        return bezLength(left) + bezLength(right);
+        return bezLength(left, tolerance) + bezLength(right, tolerance);
     }
-    return len;
+    //The arc lies between the chord and the control polygon, closer to the average of them.
+    return (len + chord) * 0.5f;
 }
 
 
@@ -106,9 +99,9 @@ void bezSplitLeft(Bezier& cur, float at, Bezier& left)
 }
 
 
-float bezAt(const Bezier& bz, float at)
+float bezAt(const Bezier& bz, float at, float tolerance)
 {
-    auto len = bezLength(bz);
+    auto len = bezLength(bz, tolerance);
     auto biggest = 1.0f;
     auto smallest = 0.0f;
     auto t = 0.5f;
@@ -122,7 +115,7 @@ float bezAt(const Bezier& bz, float at)
         auto right = bz;
         Bezier left;
         bezSplitLeft(right, t, left);
-        len = bezLength(left);
+        len = bezLength(left, tolerance);
 
         if (fabs(len - at) < BEZIER_EPSILON || fabs(smallest - biggest) < BEZIER_EPSILON) {
             break;
@@ -140,10 +133,10 @@ float bezAt(const Bezier& bz, float at)
 }
 
 
-void bezSplitAt(const Bezier& cur, float at, Bezier& left, Bezier& right)
+void bezSplitAt(const Bezier& cur, float at, Bezier& left, Bezier& right, float tolerance)
 {
     right = cur;
-    auto t = bezAt(right, at);
+    auto t = bezAt(right, at, tolerance);
     bezSplitLeft(right, t, left);
 }
 
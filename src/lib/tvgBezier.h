@@ -37,11 +37,12 @@ struct Bezier
     Point end;
 };
 
+float lineLength(const Point& pt1, const Point& pt2);
 void bezSplit(const Bezier&cur, Bezier& left, Bezier& right);
-float bezLength(const Bezier& cur);
+float bezLength(const Bezier& cur, float tolerance);
 void bezSplitLeft(Bezier& cur, float at, Bezier& left);
-float bezAt(const Bezier& bz, float at);
-void bezSplitAt(const Bezier& cur, float at, Bezier& left, Bezier& right);
+float bezAt(const Bezier& bz, float at, float tolerance);
+void bezSplitAt(const Bezier& cur, float at, Bezier& left, Bezier& right, float tolerance);
 
 }
 
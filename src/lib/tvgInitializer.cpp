@@ -103,3 +103,33 @@ Result Initializer::term(CanvasEngine engine) noexcept
 
     return Result::Success;
 }
+
+
+Result Initializer::cache(size_t bytes) noexcept
+{
+    if (_initCnt == 0) return Result::InsufficientCondition;
+
+    LoaderMgr::cacheBudget(bytes);
+
+    return Result::Success;
+}
+
+
+Result Initializer::cache(uint32_t* hits, uint32_t* misses, size_t* bytes) noexcept
+{
+    if (_initCnt == 0) return Result::InsufficientCondition;
+
+    LoaderMgr::cacheStats(hits, misses, bytes);
+
+    return Result::Success;
+}
+
+
+Result Initializer::cache(const std::string& path) noexcept
+{
+    if (_initCnt == 0) return Result::InsufficientCondition;
+
+    if (!LoaderMgr::cacheDir(path)) return Result::NonSupport;
+
+    return Result::Success;
+}
@@ -22,6 +22,8 @@
 #ifndef _TVG_LOADER_H_
 #define _TVG_LOADER_H_
 
+#include <atomic>
+#include <mutex>
 #include "tvgCommon.h"
 
 namespace tvg
@@ -37,16 +39,46 @@ public:
     float vh = 0;
     float w = 0, h = 0;         //default image size
     bool preserveAspect = true; //keep aspect ratio by default.
+    atomic<bool> canceled{false};   //stop loading as soon as possible, polled by the loaders.
+    bool cancelable = false;        //the loader polls the canceled flag.
+    bool bitmap = false;            //the loader produces pixels instead of a scene.
 
     virtual ~Loader() {}
 
+    //Set the function called once the loading is finished. It's called in the loading thread.
+    void callback(void (*func)(void* data, bool success), void* data)
+    {
+        lock_guard<mutex> lock(mtx);
+        this->func = func;
+        this->data = data;
+    }
+
+    //Loaders call this at the end of the loading.
+    void notify(bool success)
+    {
+        lock_guard<mutex> lock(mtx);
+        if (func) func(data, success && !canceled);
+        func = nullptr;
+    }
+
     virtual bool open(const string& path) { /* Not supported */ return false; };
     virtual bool open(const char* data, uint32_t size, bool copy) { /* Not supported */ return false; };
     virtual bool open(const uint32_t* data, uint32_t w, uint32_t h, bool copy) { /* Not supported */ return false; };
     virtual bool read() = 0;
     virtual bool close() = 0;
     virtual const uint32_t* pixels() { return nullptr; };
+    //Drop the pixels of pixels(), it decodes them again if they are requested. Optional.
+    virtual void release() {};
+    //Pixels reduced to 1/2^level of the image size, in a new buffer the caller frees. Optional.
+    virtual uint32_t* decode(uint32_t level, uint32_t* w, uint32_t* h) { return nullptr; };
     virtual unique_ptr<Scene> scene() { return nullptr; };
+    //Memory used by the loaded scene, reported back by the picture for the shared loaders.
+    virtual void footprint(size_t bytes) {};
+
+private:
+    mutex mtx;
+    void (*func)(void* data, bool success) = nullptr;
+    void* data = nullptr;
 };
 
 }
@@ -19,6 +19,18 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+#endif
+#include "tvgArray.h"
+#include "tvgBinaryDesc.h"
 #include "tvgLoaderMgr.h"
 
 #ifdef THORVG_SVG_LOADER_SUPPORT
@@ -29,6 +41,10 @@
     #include "tvgPngLoader.h"
 #endif
 
+#ifdef THORVG_JPG_LOADER_SUPPORT
+    #include "tvgJpgLoader.h"
+#endif
+
 #ifdef THORVG_TVG_LOADER_SUPPORT
     #include "tvgTvgLoader.h"
 #endif
@@ -51,6 +67,12 @@ static Loader* _find(FileType type)
         case FileType::Png: {
 #ifdef THORVG_PNG_LOADER_SUPPORT
             return new PngLoader;
+#endif
+            break;
+        }
+        case FileType::Jpg: {
+#ifdef THORVG_JPG_LOADER_SUPPORT
+            return new JpgLoader;
 #endif
             break;
         }
@@ -80,6 +102,10 @@ static Loader* _find(FileType type)
             format = "PNG";
             break;
         }
+        case FileType::Jpg: {
+            format = "JPG";
+            break;
+        }
         case FileType::Raw: {
             format = "RAW";
             break;
@@ -100,20 +126,405 @@ static Loader* _find(FileType type)
 }
 
 
-static Loader* _find(const string& path)
+//Number of the leading bytes required to tell the format
+#define SNIFF_LENGTH 64
+
+//Guess the format from the leading bytes of the data.
+static FileType _sniff(const char* data, uint32_t size)
 {
+    static const char pngSignature[] = "\x89PNG\r\n\x1a\n";
+    static const char jpgSignature[] = "\xff\xd8\xff";
+
+    if (size >= TVG_BIN_HEADER_SIGNATURE_LENGTH && !memcmp(data, TVG_BIN_HEADER_SIGNATURE, TVG_BIN_HEADER_SIGNATURE_LENGTH)) return FileType::Tvg;
+    if (size >= sizeof(pngSignature) - 1 && !memcmp(data, pngSignature, sizeof(pngSignature) - 1)) return FileType::Png;
+    if (size >= sizeof(jpgSignature) - 1 && !memcmp(data, jpgSignature, sizeof(jpgSignature) - 1)) return FileType::Jpg;
+
+    //Xml document: <svg, <?xml, <!DOCTYPE or a comment, after an optional utf-8 bom and spaces.
+    auto end = data + size;
+    if (size >= 3 && !memcmp(data, "\xef\xbb\xbf", 3)) data += 3;
+    while (data < end && (*data == ' ' || *data == '\t' || *data == '\r' || *data == '\n')) ++data;
+    if (end - data >= 2 && data[0] == '<' && (data[1] == 's' || data[1] == '?' || data[1] == '!')) return FileType::Svg;
+
+    return FileType::Unknown;
+}
+
+
+static FileType _fileType(const string& path)
+{
+    //The contents decide the format, the extension is used if they are not conclusive.
+    if (auto f = fopen(path.c_str(), "rb")) {
+        char head[SNIFF_LENGTH];
+        auto size = fread(head, 1, SNIFF_LENGTH, f);
+        fclose(f);
+        auto type = _sniff(head, static_cast<uint32_t>(size));
+        if (type != FileType::Unknown) return type;
+    }
+
     auto ext = path.substr(path.find_last_of(".") + 1);
-    if (!ext.compare("svg")) return _find(FileType::Svg);
-    if (!ext.compare("png")) return _find(FileType::Png);
-    if (!ext.compare("tvg")) return _find(FileType::Tvg);
+    if (!ext.compare("svg")) return FileType::Svg;
+    if (!ext.compare("png")) return FileType::Png;
+    if (!ext.compare("jpg") || !ext.compare("jpeg")) return FileType::Jpg;
+    if (!ext.compare("tvg")) return FileType::Tvg;
+    return FileType::Unknown;
+}
+
+
+static bool _copyFile(const string& path, const char** data, uint32_t* size)
+{
+    auto f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    fseek(f, 0, SEEK_END);
+    auto len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    if (len <= 0 || (unsigned long)len >= UINT32_MAX) {
+        fclose(f);
+        return false;
+    }
+
+    auto buffer = static_cast<char*>(malloc(len + 1));
+    if (!buffer || fread(buffer, 1, len, f) != (size_t)len) {
+        free(buffer);
+        fclose(f);
+        return false;
+    }
+    fclose(f);
+    buffer[len] = '\0';
+
+    *data = buffer;
+    *size = static_cast<uint32_t>(len);
+    return true;
+}
+
+
+//Default memory budget of the loader cache
+#define LOADER_CACHE_BUDGET (32 * 1024 * 1024)
+
+struct LoaderShare;
+static void _cacheCharge(const LoaderShare* share, size_t bytes);
+
+
+//The loaded result of a file, shared by the pictures loading the same file.
+struct LoaderShare
+{
+    mutex mtx;
+    Loader* origin;
+    Scene* scene = nullptr;
+    const uint32_t* pixels = nullptr;
+    bool requested = false;
+    bool readable = false;
+    bool resolved = false;
+    bool charged = false;
+
+    LoaderShare(Loader* origin) : origin(origin) {}
+
+    ~LoaderShare()
+    {
+        if (scene) delete(scene);
+        if (!resolved) origin->close();
+        //The origin owns the pixels, it's alive as long as the share is.
+        delete(origin);
+    }
+
+    bool read()
+    {
+        lock_guard<mutex> lock(mtx);
+        if (!requested) {
+            requested = true;
+            readable = origin->read();
+        }
+        return readable;
+    }
+
+    void resolve()
+    {
+        lock_guard<mutex> lock(mtx);
+        if (resolved || !requested) return;
+        scene = origin->scene().release();
+        origin->close();
+        resolved = true;
+    }
+
+    //The document is charged with the scene it's made of, once it's known.
+    void charge(size_t bytes)
+    {
+        {
+            lock_guard<mutex> lock(mtx);
+            if (charged) return;
+            charged = true;
+        }
+        _cacheCharge(this, bytes);
+    }
+
+    //Decoded on demand, a reduced level of detail may be all the pictures need.
+    const uint32_t* image()
+    {
+        lock_guard<mutex> lock(mtx);
+        if (!pixels && requested && !scene) pixels = origin->pixels();
+        return pixels;
+    }
+
+    uint32_t* decode(uint32_t level, uint32_t* w, uint32_t* h)
+    {
+        lock_guard<mutex> lock(mtx);
+        return origin->decode(level, w, h);
+    }
+};
+
+
+//Hands out the shared result, every picture gets its own copy of the scene.
+class ShareLoader : public Loader
+{
+public:
+    shared_ptr<LoaderShare> share;
+
+    ShareLoader(shared_ptr<LoaderShare> share) : share(share)
+    {
+        auto origin = share->origin;
+        vx = origin->vx;
+        vy = origin->vy;
+        vw = origin->vw;
+        vh = origin->vh;
+        w = origin->w;
+        h = origin->h;
+        preserveAspect = origin->preserveAspect;
+        bitmap = origin->bitmap;
+    }
+
+    bool read() override
+    {
+        return share->read();
+    }
+
+    bool close() override
+    {
+        return true;
+    }
+
+    const uint32_t* pixels() override
+    {
+        share->resolve();
+        return share->image();
+    }
+
+    uint32_t* decode(uint32_t level, uint32_t* w, uint32_t* h) override
+    {
+        //The reduced pixels are owned by the caller, they are not shared.
+        return share->decode(level, w, h);
+    }
+
+    unique_ptr<Scene> scene() override
+    {
+        share->resolve();
+        if (!share->scene) return nullptr;
+        return unique_ptr<Scene>(static_cast<Scene*>(share->scene->duplicate()));
+    }
+
+    void footprint(size_t bytes) override
+    {
+        share->charge(bytes);
+    }
+};
+
+
+struct LoaderCacheEntry
+{
+    string path;
+    uint64_t mtime;
+    uint64_t fsize;
+    size_t bytes;
+    shared_ptr<LoaderShare> share;
+};
+
+
+//Least recently used entries come first.
+static struct
+{
+    mutex mtx;
+    Array<LoaderCacheEntry*> entries;
+    size_t budget = LOADER_CACHE_BUDGET;     //zero disables the cache
+    size_t bytes = 0;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+} _cache;
+
+
+static bool _fileStamp(const string& path, uint64_t* mtime, uint64_t* fsize)
+{
+#ifndef _WIN32
+    struct stat info;
+    if (stat(path.c_str(), &info) < 0) return false;
+    *mtime = static_cast<uint64_t>(info.st_mtime) * 1000000000ULL;
+    #if defined(__linux__)
+        *mtime += static_cast<uint64_t>(info.st_mtim.tv_nsec);
+    #endif
+    *fsize = static_cast<uint64_t>(info.st_size);
+    return true;
+#else
+    struct _stat64 info;
+    if (_stat64(path.c_str(), &info) != 0) return false;
+    *mtime = static_cast<uint64_t>(info.st_mtime) * 1000000000ULL;
+    *fsize = static_cast<uint64_t>(info.st_size);
+    return true;
+#endif
+}
+
+
+static void _cacheRemove(uint32_t idx)
+{
+    auto entry = _cache.entries.data[idx];
+    _cache.bytes -= entry->bytes;
+    delete(entry);
+
+    auto count = _cache.entries.count - idx - 1;
+    if (count > 0) memmove(_cache.entries.data + idx, _cache.entries.data + idx + 1, sizeof(LoaderCacheEntry*) * count);
+    --_cache.entries.count;
+}
+
+
+//Evict the least recently used entries until the budget fits the given extra bytes.
+static void _cacheTrim(size_t extra)
+{
+    while (_cache.entries.count > 0 && _cache.bytes + extra > _cache.budget) _cacheRemove(0);
+}
+
+
+static void _cacheClear()
+{
+    for (uint32_t i = 0; i < _cache.entries.count; ++i) delete(_cache.entries.data[i]);
+    _cache.entries.reset();
+    _cache.bytes = 0;
+}
+
+
+static shared_ptr<LoaderShare> _cacheFind(const string& path, uint64_t mtime, uint64_t fsize)
+{
+    for (uint32_t i = 0; i < _cache.entries.count; ++i) {
+        auto entry = _cache.entries.data[i];
+        if (entry->path != path) continue;
+
+        //The file is modified, drop the outdated result.
+        if (entry->mtime != mtime || entry->fsize != fsize) {
+            _cacheRemove(i);
+            return nullptr;
+        }
+
+        //Move to the most recently used
+        auto count = _cache.entries.count - i - 1;
+        if (count > 0) {
+            memmove(_cache.entries.data + i, _cache.entries.data + i + 1, sizeof(LoaderCacheEntry*) * count);
+            _cache.entries.data[_cache.entries.count - 1] = entry;
+        }
+        return entry->share;
+    }
     return nullptr;
 }
 
 
+//The scene of a document is known once it's resolved, the entry is charged again with it.
+static void _cacheCharge(const LoaderShare* share, size_t bytes)
+{
+    lock_guard<mutex> lock(_cache.mtx);
+
+    for (uint32_t i = 0; i < _cache.entries.count; ++i) {
+        auto entry = _cache.entries.data[i];
+        if (entry->share.get() != share) continue;
+        _cache.bytes = _cache.bytes - entry->bytes + bytes;
+        entry->bytes = bytes;
+        //Too big to keep, the pictures still hold it.
+        if (bytes > _cache.budget) _cacheRemove(i);
+        else _cacheTrim(0);
+        return;
+    }
+}
+
+
+static void _cacheAdd(const string& path, FileType type, uint64_t mtime, uint64_t fsize, shared_ptr<LoaderShare> share)
+{
+    //Rough estimation: the decoded pixels or the document size until its scene is resolved.
+    auto origin = share->origin;
+    size_t bytes = fsize;
+    if (type == FileType::Png || type == FileType::Jpg) bytes = static_cast<size_t>(origin->w) * static_cast<size_t>(origin->h) * sizeof(uint32_t);
+
+    if (bytes > _cache.budget) return;
+    _cacheTrim(bytes);
+
+    auto entry = new LoaderCacheEntry;
+    entry->path = path;
+    entry->mtime = mtime;
+    entry->fsize = fsize;
+    entry->bytes = bytes;
+    entry->share = share;
+    _cache.entries.push(entry);
+    _cache.bytes += bytes;
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
 
+FileMap::~FileMap()
+{
+    close();
+}
+
+
+bool FileMap::open(const string& path, bool text)
+{
+    close();
+
+#ifndef _WIN32
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size <= 0 || (unsigned long long)info.st_size >= UINT32_MAX) {
+        ::close(fd);
+        return false;
+    }
+
+    //The rest of the last page is zero-filled, unless the file ends on the page boundary.
+    if (text && (info.st_size % sysconf(_SC_PAGESIZE)) == 0) {
+        ::close(fd);
+        return _copyFile(path, &data, &size);
+    }
+
+    auto addr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (addr != MAP_FAILED) {
+    #ifdef MADV_SEQUENTIAL
+        madvise(addr, info.st_size, MADV_SEQUENTIAL);
+    #endif
+        data = static_cast<const char*>(addr);
+        size = static_cast<uint32_t>(info.st_size);
+        mapped = true;
+        return true;
+    }
+#endif
+    //Fallback: mmap is not available
+    return _copyFile(path, &data, &size);
+}
+
+
+void FileMap::close()
+{
+    if (!data) return;
+
+#ifndef _WIN32
+    if (mapped) munmap((void*)data, size);
+    else free((void*)data);
+#else
+    free((void*)data);
+#endif
+    data = nullptr;
+    size = 0;
+    mapped = false;
+}
+
+
 
 bool LoaderMgr::init()
 {
@@ -125,25 +536,82 @@ bool LoaderMgr::init()
 
 bool LoaderMgr::term()
 {
-    //TODO:
+    lock_guard<mutex> lock(_cache.mtx);
+
+#ifdef THORVG_LOG_ENABLED
+    printf("LOADER: cache hits(%u) misses(%u) bytes(%zu)\n", _cache.hits, _cache.misses, _cache.bytes);
+#endif
+    _cacheClear();
+    _cache.hits = _cache.misses = 0;
+    _cache.budget = LOADER_CACHE_BUDGET;
+
+#ifdef THORVG_SVG_LOADER_SUPPORT
+    SvgLoader::cacheDir("");
+#endif
 
     return true;
 }
 
 
-shared_ptr<Loader> LoaderMgr::loader(const string& path)
+shared_ptr<Loader> LoaderMgr::loader(const string& path, bool cache)
 {
-    if (auto loader = _find(path)) {
-        if (loader->open(path)) return shared_ptr<Loader>(loader);
-        else delete(loader);
+    uint64_t mtime = 0, fsize = 0;
+    if (cache) {
+        lock_guard<mutex> lock(_cache.mtx);
+        cache = (_cache.budget > 0);
     }
-    return nullptr;
+    auto cacheable = cache && _fileStamp(path, &mtime, &fsize);
+
+    if (cacheable) {
+        lock_guard<mutex> lock(_cache.mtx);
+        if (auto share = _cacheFind(path, mtime, fsize)) {
+            ++_cache.hits;
+            return make_shared<ShareLoader>(share);
+        }
+        ++_cache.misses;
+    }
+
+    auto type = _fileType(path);
+    if (type == FileType::Unknown) return nullptr;
+
+    auto loader = _find(type);
+    if (!loader) return nullptr;
+    if (!loader->open(path)) {
+        delete(loader);
+        return nullptr;
+    }
+    if (!cacheable) return shared_ptr<Loader>(loader);
+
+    auto share = make_shared<LoaderShare>(loader);
+    {
+        lock_guard<mutex> lock(_cache.mtx);
+        //Another thread loaded the same file in the meantime, share its result instead.
+        if (auto prior = _cacheFind(path, mtime, fsize)) return make_shared<ShareLoader>(prior);
+        _cacheAdd(path, type, mtime, fsize, share);
+    }
+    return make_shared<ShareLoader>(share);
+}
+
+
+FileType LoaderMgr::type(const char* data, uint32_t size)
+{
+    return _sniff(data, size);
 }
 
 
 shared_ptr<Loader> LoaderMgr::loader(const char* data, uint32_t size, bool copy)
 {
+    //Try the likely format first
+    auto type = _sniff(data, size);
+    if (type != FileType::Unknown) {
+        if (auto loader = _find(type)) {
+            if (loader->open(data, size, copy)) return shared_ptr<Loader>(loader);
+            else delete(loader);
+        }
+    }
+
     for (int i = 0; i < static_cast<int>(FileType::Unknown); i++) {
+        if (static_cast<FileType>(i) == type) continue;
         auto loader = _find(static_cast<FileType>(i));
         if (loader) {
             if (loader->open(data, size, copy)) return shared_ptr<Loader>(loader);
@@ -165,3 +633,31 @@ shared_ptr<Loader> LoaderMgr::loader(const uint32_t *data, uint32_t w, uint32_t
     }
     return nullptr;
 }
+
+
+void LoaderMgr::cacheBudget(size_t bytes)
+{
+    lock_guard<mutex> lock(_cache.mtx);
+    _cache.budget = bytes;
+    _cacheTrim(0);
+}
+
+
+void LoaderMgr::cacheStats(uint32_t* hits, uint32_t* misses, size_t* bytes)
+{
+    lock_guard<mutex> lock(_cache.mtx);
+    if (hits) *hits = _cache.hits;
+    if (misses) *misses = _cache.misses;
+    if (bytes) *bytes = _cache.bytes;
+}
+
+
+bool LoaderMgr::cacheDir(const string& dir)
+{
+#ifdef THORVG_SVG_LOADER_SUPPORT
+    SvgLoader::cacheDir(dir);
+    return true;
+#else
+    return false;
+#endif
+}
@@ -24,15 +24,39 @@
 
 #include "tvgLoader.h"
 
-enum class FileType { Tvg = 0, Svg, Raw, Png, Unknown };
+enum class FileType { Tvg = 0, Svg, Raw, Png, Jpg, Unknown };
+
+//Read-only view of a whole file. The file is memory-mapped where the platform supports it,
+//otherwise its contents are copied into a heap buffer. Loaders parse the data in place.
+struct FileMap
+{
+    const char* data = nullptr;
+    uint32_t size = 0;
+
+    ~FileMap();
+    //text: data[size] is a NUL, for the parsers using the string functions.
+    bool open(const string& path, bool text = false);
+    void close();
+
+private:
+    bool mapped = false;
+};
 
 struct LoaderMgr
 {
     static bool init();
     static bool term();
-    static shared_ptr<Loader> loader(const string& path);
+    static shared_ptr<Loader> loader(const string& path, bool cache = true);
     static shared_ptr<Loader> loader(const char* data, uint32_t size, bool copy);
     static shared_ptr<Loader> loader(const uint32_t* data, uint32_t w, uint32_t h, bool copy);
+    static FileType type(const char* data, uint32_t size);     //format guessed from the leading bytes
+
+    //Files loaded by path are shared through a cache, limited by the estimated memory usage in bytes.
+    static void cacheBudget(size_t bytes);
+    static void cacheStats(uint32_t* hits, uint32_t* misses, size_t* bytes);
+
+    //Directory of the parsed documents kept across the processes. Empty disables it.
+    static bool cacheDir(const string& dir);
 };
 
 #endif //_TVG_LOADER_MGR_H_
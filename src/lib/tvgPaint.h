@@ -37,6 +37,7 @@ namespace tvg
         virtual bool bounds(float* x, float* y, float* w, float* h) const = 0;
         virtual RenderRegion bounds(RenderMethod& renderer) const = 0;
         virtual Paint* duplicate() = 0;
+        virtual size_t footprint() const = 0;      //Rough memory usage in bytes.
     };
 
     struct Paint::Impl
@@ -111,6 +112,14 @@ namespace tvg
         void* update(RenderMethod& renderer, const RenderTransform* pTransform, uint32_t opacity, Array<RenderData>& clips, uint32_t pFlag);
         bool render(RenderMethod& renderer);
         Paint* duplicate();
+
+        size_t footprint() const
+        {
+            auto bytes = sizeof(Paint) + sizeof(Impl) + smethod->footprint();
+            if (rTransform) bytes += sizeof(RenderTransform);
+            if (cmpTarget) bytes += cmpTarget->pImpl->footprint();
+            return bytes;
+        }
     };
 
 
@@ -151,6 +160,11 @@ namespace tvg
         {
             return inst->duplicate();
         }
+
+        size_t footprint() const override
+        {
+            return inst->footprint();
+        }
     };
 }
 
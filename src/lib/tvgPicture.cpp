@@ -53,6 +53,21 @@ Result Picture::load(const std::string& path) noexcept
 }
 
 
+Result Picture::load(const std::string& path, void (*func)(Picture* picture, Result result, void* data), void* data) noexcept
+{
+    if (path.empty() || !func) return Result::InvalidArguments;
+
+    return pImpl->load(path, func, data);
+}
+
+
+Result Picture::cancel() noexcept
+{
+    if (pImpl->cancel()) return Result::Success;
+    return Result::InsufficientCondition;
+}
+
+
 Result Picture::load(const char* data, uint32_t size, bool copy) noexcept
 {
     if (!data || size <= 0) return Result::InvalidArguments;
@@ -93,10 +108,29 @@ Result Picture::size(float* w, float* h) const noexcept
 
 const uint32_t* Picture::data() const noexcept
 {
-    //Try it, If not loaded yet.
-    if (pImpl->loader) return pImpl->loader->pixels();
+    return data(nullptr, nullptr);
+}
+
 
-    return pImpl->pixels;
+const uint32_t* Picture::data(uint32_t* w, uint32_t* h) const noexcept
+{
+    lock_guard<mutex> lock(pImpl->mtx);
+
+    //The drawn pixels, if they are in the full size.
+    if (pImpl->image.data && pImpl->image.level == 0) {
+        if (w) *w = pImpl->image.w;
+        if (h) *h = pImpl->image.h;
+        return pImpl->image.data;
+    }
+
+    //Not loaded yet or drawn in a reduced level of detail, decoded in the full size.
+    if (pImpl->loader) {
+        if (w) *w = static_cast<uint32_t>(pImpl->loader->vw);
+        if (h) *h = static_cast<uint32_t>(pImpl->loader->vh);
+        return pImpl->loader->pixels();
+    }
+
+    return nullptr;
 }
 
 
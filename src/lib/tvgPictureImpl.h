@@ -22,7 +22,9 @@
 #ifndef _TVG_PICTURE_IMPL_H_
 #define _TVG_PICTURE_IMPL_H_
 
+#include <math.h>
 #include <string>
+#include <mutex>
 #include "tvgPaint.h"
 #include "tvgLoaderMgr.h"
 
@@ -32,21 +34,65 @@
 
 struct Picture::Impl
 {
+    //The pixels handed to the engine, decoded by its task in the level of detail the picture is drawn with.
+    struct Image : RenderImage
+    {
+        Impl* impl;
+        Image(Impl* impl) : impl(impl) {}
+        void decode(const Matrix* transform) override { impl->lod(transform); }
+    };
+
     shared_ptr<Loader> loader = nullptr;
     Paint* paint = nullptr;
-    uint32_t *pixels = nullptr;
     Picture *picture = nullptr;
     void *rdata = nullptr;              //engine data
     float w = 0, h = 0;
     bool resizing = false;
 
+    Image image{this};
+    bool owned = false;                 //reduced pixels belong to the picture, the others to the loader.
+    mutable mutex mtx;                  //the pixels are decoded in the engine task, read in the caller thread.
+
+    //Asynchronous loading
+    void (*loadFunc)(Picture* picture, Result result, void* data) = nullptr;
+    void* loadData = nullptr;
+
     Impl(Picture* p) : picture(p)
     {
     }
 
     ~Impl()
     {
+        detach();
         if (paint) delete(paint);
+        if (owned) free(const_cast<uint32_t*>(image.data));
+    }
+
+    static void loaded(void* data, bool success)
+    {
+        auto impl = static_cast<Impl*>(data);
+        auto result = Result::Success;
+        if (impl->loader->canceled) result = Result::InsufficientCondition;
+        else if (!success) result = Result::Unknown;
+        impl->loadFunc(impl->picture, result, impl->loadData);
+    }
+
+    //Stop listening to the loader, the picture is going away or loads another one.
+    void detach()
+    {
+        if (!loadFunc) return;
+        loader->canceled = true;
+        loader->callback(nullptr, nullptr);
+        loadFunc = nullptr;
+        loadData = nullptr;
+    }
+
+    bool cancel()
+    {
+        //The images are decoded at once and the shared loaders are not owned by a single picture.
+        if (!loader || !loader->cancelable) return false;
+        loader->canceled = true;
+        return true;
     }
 
     bool dispose(RenderMethod& renderer)
@@ -54,7 +100,7 @@ struct Picture::Impl
         bool ret = true;
         if (paint) {
             ret = paint->pImpl->dispose(renderer);
-        } else if (pixels) {
+        } else if (rdata) {
             ret =  renderer.dispose(rdata);
             rdata = nullptr;
         }
@@ -100,37 +146,87 @@ struct Picture::Impl
                 auto scene = loader->scene();
                 if (scene) {
                     paint = scene.release();
+                    loader->footprint(paint->pImpl->footprint());
                     loader->close();
                     if (w != loader->w && h != loader->h) resize();
                     if (paint) return RenderUpdateFlag::None;
                 }
             }
-            if (!pixels) {
-                pixels = const_cast<uint32_t*>(loader->pixels());
-                loader->close();
-                if (pixels) return RenderUpdateFlag::Image;
-            }
         }
         return RenderUpdateFlag::None;
     }
 
+    //The coarsest level of detail that still has a pixel per a drawn pixel.
+    static uint32_t lodLevel(const Matrix* m)
+    {
+        if (!m) return 0;
+        auto sx = sqrtf(m->e11 * m->e11 + m->e21 * m->e21);
+        auto sy = sqrtf(m->e12 * m->e12 + m->e22 * m->e22);
+        auto scale = (sx > sy) ? sx : sy;
+        uint32_t level = 0;
+        while (level < 11 && scale * static_cast<float>(2 << level) <= 1.0f) ++level;
+        return level;
+    }
+
+    //Decode the pixels in the level of detail for the drawing transform, called by the engine task.
+    //Nothing else reads the previous pixels meanwhile, they are freed here.
+    void lod(const Matrix* transform)
+    {
+        lock_guard<mutex> lock(mtx);
+
+        auto level = lodLevel(transform);
+
+        //Current pixels are fine enough and not too large, the hysteresis avoids decoding back and forth.
+        if (image.data && (level == image.level || level == image.level + 1)) return;
+
+        auto prev = image.data;
+        auto prevOwned = owned;
+
+        uint32_t w = 0, h = 0;
+        auto data = (level > 0) ? loader->decode(level, &w, &h) : nullptr;
+        if (data) {
+            owned = true;
+        } else {
+            //The original size, if the loader can't reduce it.
+            if (image.data && !owned) return;
+            data = const_cast<uint32_t*>(loader->pixels());
+            if (!data) return;
+            owned = false;
+            level = 0;
+            w = static_cast<uint32_t>(loader->vw);
+            h = static_cast<uint32_t>(loader->vh);
+            loader->close();
+        }
+        image.data = data;
+        image.w = w;
+        image.h = h;
+        image.level = level;
+
+        if (prevOwned) free(const_cast<uint32_t*>(prev));
+        //The full size pixels are decoded again on demand, unless the duplicates share them.
+        else if (prev && level > 0 && loader.use_count() == 1) loader->release();
+    }
+
     void* update(RenderMethod &renderer, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag pFlag)
     {
         auto flag = reload();
 
-        if (pixels) rdata = renderer.prepare(*picture, rdata, transform, opacity, clips, static_cast<RenderUpdateFlag>(pFlag | flag));
-        else if (paint) {
+        if (paint) {
             if (resizing) resize();
             rdata = paint->pImpl->update(renderer, transform, opacity, clips, static_cast<RenderUpdateFlag>(pFlag | flag));
+        //The engine task decodes the pixels, the caller doesn't wait for them.
+        } else if (loader && loader->bitmap) {
+            rdata = renderer.prepare(*picture, &image, rdata, transform, opacity, clips, static_cast<RenderUpdateFlag>(pFlag | flag));
         }
         return rdata;
     }
 
     bool render(RenderMethod &renderer)
     {
-        if (pixels) return renderer.renderImage(rdata);
-        else if (paint) return paint->pImpl->render(renderer);
-        return false;
+        if (paint) return paint->pImpl->render(renderer);
+        else if (rdata) return renderer.renderImage(rdata);
+        //A canceled picture has nothing to draw, the others are still drawn.
+        return (loader && loader->canceled);
     }
 
     bool viewbox(float* x, float* y, float* w, float* h) const
@@ -166,6 +262,7 @@ struct Picture::Impl
 
     Result load(const string& path)
     {
+        detach();
         if (loader) loader->close();
         loader = LoaderMgr::loader(path);
         if (!loader) return Result::NonSupport;
@@ -175,8 +272,29 @@ struct Picture::Impl
         return Result::Success;
     }
 
+    Result load(const string& path, void (*func)(Picture* picture, Result result, void* data), void* data)
+    {
+        detach();
+        if (loader) loader->close();
+        loader = LoaderMgr::loader(path, false);
+        if (!loader) return Result::NonSupport;
+        w = loader->w;
+        h = loader->h;
+        loadFunc = func;
+        loadData = data;
+        loader->callback(loaded, this);
+        if (!loader->read()) {
+            loader->callback(nullptr, nullptr);
+            loadFunc = nullptr;
+            loadData = nullptr;
+            return Result::Unknown;
+        }
+        return Result::Success;
+    }
+
     Result load(const char* data, uint32_t size, bool copy)
     {
+        detach();
         if (loader) loader->close();
         loader = LoaderMgr::loader(data, size, copy);
         if (!loader) return Result::NonSupport;
@@ -188,12 +306,22 @@ struct Picture::Impl
 
     Result load(uint32_t* data, uint32_t w, uint32_t h, bool copy)
     {
+        detach();
         if (loader) loader->close();
         loader = LoaderMgr::loader(data, w, h, copy);
         if (!loader) return Result::NonSupport;
         return Result::Success;
     }
 
+    size_t footprint() const
+    {
+        auto bytes = sizeof(Impl);
+        if (paint) bytes += paint->pImpl->footprint();
+        lock_guard<mutex> lock(mtx);
+        if (image.data) bytes += static_cast<size_t>(image.w) * static_cast<size_t>(image.h) * sizeof(uint32_t);
+        return bytes;
+    }
+
     Paint* duplicate()
     {
         reload();
@@ -205,7 +333,13 @@ struct Picture::Impl
         if (paint) dup->paint = paint->duplicate();
 
         dup->loader = loader;
-        dup->pixels = pixels;
+        //The reduced pixels are decoded again for the duplicate.
+        lock_guard<mutex> lock(mtx);
+        if (!owned) {
+            dup->image.data = image.data;
+            dup->image.w = image.w;
+            dup->image.h = image.h;
+        }
         dup->w = w;
         dup->h = h;
         dup->resizing = resizing;
@@ -63,6 +63,26 @@ struct RenderRegion {
     }
 };
 
+//The geometry of a path made by a single appendRect() or appendCircle(), the engines may draw it analytically.
+struct RenderPrimitive
+{
+    float x = 0.0f, y = 0.0f, w = 0.0f, h = 0.0f;  //bounding box
+    float rx = 0.0f, ry = 0.0f;                    //corner radii, the half of the box for the ellipses
+    bool valid = false;
+};
+
+//The pixels of a picture, reduced to 1/2^level of the picture size for a coarser level of detail.
+struct RenderImage
+{
+    const uint32_t* data = nullptr;
+    uint32_t w = 0, h = 0;
+    uint32_t level = 0;
+
+    virtual ~RenderImage() {}
+    //Brings the pixels up to date for the drawing transform. The engines call it in their tasks.
+    virtual void decode(const Matrix* transform) = 0;
+};
+
 struct RenderTransform
 {
     Matrix m;             //3x3 Matrix Elements
@@ -83,8 +103,8 @@ class RenderMethod
 {
 public:
     virtual ~RenderMethod() {}
-    virtual RenderData prepare(const Shape& shape, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) = 0;
-    virtual RenderData prepare(const Picture& picture, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) = 0;
+    virtual RenderData prepare(const Shape& shape, const RenderPrimitive* primitive, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) = 0;
+    virtual RenderData prepare(const Picture& picture, RenderImage* image, RenderData data, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag flags) = 0;
     virtual bool preRender() = 0;
     virtual bool renderShape(RenderData data) = 0;
     virtual bool renderImage(RenderData data) = 0;
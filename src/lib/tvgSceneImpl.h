@@ -155,6 +155,15 @@ struct Scene::Impl
         return true;
     }
 
+    size_t footprint() const
+    {
+        auto bytes = sizeof(Impl) + paints.reserved * sizeof(Paint*);
+        for (auto paint = paints.data; paint < (paints.data + paints.count); ++paint) {
+            bytes += (*paint)->pImpl->footprint();
+        }
+        return bytes;
+    }
+
     Paint* duplicate()
     {
         auto ret = Scene::gen();
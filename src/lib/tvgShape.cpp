@@ -139,6 +139,7 @@ Result Shape::close() noexcept
 
 Result Shape::appendCircle(float cx, float cy, float rx, float ry) noexcept
 {
+    auto primitive = (pImpl->path.cmdCnt == 0 && rx > 0 && ry > 0);
     auto rxKappa = rx * PATH_KAPPA;
     auto ryKappa = ry * PATH_KAPPA;
 
@@ -150,6 +151,8 @@ Result Shape::appendCircle(float cx, float cy, float rx, float ry) noexcept
     pImpl->path.cubicTo(cx - rx, cy - ryKappa, cx - rxKappa, cy - ry, cx, cy - ry);
     pImpl->path.close();
 
+    if (primitive) pImpl->path.primitive = {cx - rx, cy - ry, rx * 2.0f, ry * 2.0f, rx, ry, true};
+
     pImpl->flag |= RenderUpdateFlag::Path;
 
     return Result::Success;
@@ -228,12 +231,14 @@ Result Shape::appendRect(float x, float y, float w, float h, float rx, float ry)
 
     //rectangle
     if (rx == 0 && ry == 0) {
+        auto primitive = (pImpl->path.cmdCnt == 0 && w > 0 && h > 0);
         pImpl->path.grow(5, 4);
         pImpl->path.moveTo(x, y);
         pImpl->path.lineTo(x + w, y);
         pImpl->path.lineTo(x + w, y + h);
         pImpl->path.lineTo(x, y + h);
         pImpl->path.close();
+        if (primitive) pImpl->path.primitive = {x, y, w, h, 0, 0, true};
     //circle
     } else if (fabsf(rx - halfW) < FLT_EPSILON && fabsf(ry - halfH) < FLT_EPSILON) {
         return appendCircle(x + (w * 0.5f), y + (h * 0.5f), rx, ry);
@@ -357,13 +362,19 @@ const Fill* Shape::strokeFill() const noexcept
 
 
 Result Shape::stroke(const float* dashPattern, uint32_t cnt) noexcept
+{
+    return stroke(dashPattern, cnt, 0.0f);
+}
+
+
+Result Shape::stroke(const float* dashPattern, uint32_t cnt, float offset) noexcept
 {
     if (cnt < 2 || !dashPattern) return Result::InvalidArguments;
 
     for (uint32_t i = 0; i < cnt; i++)
         if (dashPattern[i] < FLT_EPSILON) return Result::InvalidArguments;
 
-    if (!pImpl->strokeDash(dashPattern, cnt)) return Result::FailedAllocation;
+    if (!pImpl->strokeDash(dashPattern, cnt, offset)) return Result::FailedAllocation;
 
     return Result::Success;
 }
@@ -371,6 +382,14 @@ Result Shape::stroke(const float* dashPattern, uint32_t cnt) noexcept
 
 uint32_t Shape::strokeDash(const float** dashPattern) const noexcept
 {
+    return strokeDash(dashPattern, nullptr);
+}
+
+
+uint32_t Shape::strokeDash(const float** dashPattern, float* offset) const noexcept
+{
+    if (offset) *offset = pImpl->stroke ? pImpl->stroke->dashOffset : 0.0f;
+
     if (!pImpl->stroke) return 0;
 
     if (dashPattern) *dashPattern = pImpl->stroke->dashPattern;
@@ -36,6 +36,7 @@ struct ShapeStroke
     Fill *fill = nullptr;
     float* dashPattern = nullptr;
     uint32_t dashCnt = 0;
+    float dashOffset = 0;
     StrokeCap cap = StrokeCap::Square;
     StrokeJoin join = StrokeJoin::Bevel;
 
@@ -44,6 +45,7 @@ struct ShapeStroke
     ShapeStroke(const ShapeStroke* src)
      : width(src->width),
        dashCnt(src->dashCnt),
+       dashOffset(src->dashOffset),
        cap(src->cap),
        join(src->join)
     {
@@ -72,6 +74,8 @@ struct ShapePath
     uint32_t ptsCnt = 0;
     uint32_t reservedPtsCnt = 0;
 
+    RenderPrimitive primitive;      //valid while the path is just a rectangle or an ellipse
+
     ~ShapePath()
     {
         if (cmds) free(cmds);
@@ -88,6 +92,7 @@ struct ShapePath
         reservedCmdCnt = src->reservedCmdCnt;
         ptsCnt = src->ptsCnt;
         reservedPtsCnt = src->reservedPtsCnt;
+        primitive = src->primitive;
 
         cmds = static_cast<PathCommand*>(malloc(sizeof(PathCommand) * reservedCmdCnt));
         if (!cmds) return;
@@ -125,6 +130,7 @@ struct ShapePath
     {
         cmdCnt = 0;
         ptsCnt = 0;
+        primitive.valid = false;
     }
 
     void append(const PathCommand* cmds, uint32_t cmdCnt, const Point* pts, uint32_t ptsCnt)
@@ -133,6 +139,7 @@ struct ShapePath
         memcpy(this->pts + this->ptsCnt, pts, sizeof(Point) * ptsCnt);
         this->cmdCnt += cmdCnt;
         this->ptsCnt += ptsCnt;
+        primitive.valid = false;
     }
 
     void moveTo(float x, float y)
@@ -142,6 +149,7 @@ struct ShapePath
 
         cmds[cmdCnt++] = PathCommand::MoveTo;
         pts[ptsCnt++] = {x, y};
+        primitive.valid = false;
     }
 
     void lineTo(float x, float y)
@@ -151,6 +159,7 @@ struct ShapePath
 
         cmds[cmdCnt++] = PathCommand::LineTo;
         pts[ptsCnt++] = {x, y};
+        primitive.valid = false;
     }
 
     void cubicTo(float cx1, float cy1, float cx2, float cy2, float x, float y)
@@ -162,6 +171,7 @@ struct ShapePath
         pts[ptsCnt++] = {cx1, cy1};
         pts[ptsCnt++] = {cx2, cy2};
         pts[ptsCnt++] = {x, y};
+        primitive.valid = false;
     }
 
     void close()
@@ -170,6 +180,7 @@ struct ShapePath
 
         if (cmdCnt + 1 > reservedCmdCnt) reserveCmd((cmdCnt + 1) * 2);
         cmds[cmdCnt++] = PathCommand::Close;
+        primitive.valid = false;
     }
 
     bool bounds(float* x, float* y, float* w, float* h) const
@@ -231,7 +242,7 @@ struct Shape::Impl
 
     void* update(RenderMethod& renderer, const RenderTransform* transform, uint32_t opacity, Array<RenderData>& clips, RenderUpdateFlag pFlag)
     {
-        this->rdata = renderer.prepare(*shape, this->rdata, transform, opacity, clips, static_cast<RenderUpdateFlag>(pFlag | flag));
+        this->rdata = renderer.prepare(*shape, &path.primitive, this->rdata, transform, opacity, clips, static_cast<RenderUpdateFlag>(pFlag | flag));
         flag = RenderUpdateFlag::None;
         return this->rdata;
     }
@@ -328,7 +339,7 @@ struct Shape::Impl
         return Result::Success;
     }
 
-    bool strokeDash(const float* pattern, uint32_t cnt)
+    bool strokeDash(const float* pattern, uint32_t cnt, float offset)
     {
        if (!stroke) stroke = new ShapeStroke();
        if (!stroke) return false;
@@ -347,11 +358,20 @@ struct Shape::Impl
             stroke->dashPattern[i] = pattern[i];
 
         stroke->dashCnt = cnt;
+        stroke->dashOffset = offset;
         flag |= RenderUpdateFlag::Stroke;
 
         return true;
     }
 
+    size_t footprint() const
+    {
+        auto bytes = sizeof(Impl) + path.reservedCmdCnt * sizeof(PathCommand) + path.reservedPtsCnt * sizeof(Point);
+        if (fill) bytes += sizeof(LinearGradient);
+        if (stroke) bytes += sizeof(ShapeStroke) + stroke->dashCnt * sizeof(float);
+        return bytes;
+    }
+
     Paint* duplicate()
     {
         auto ret = Shape::gen();
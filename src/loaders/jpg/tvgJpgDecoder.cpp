@@ -0,0 +1,1134 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tvgJpgDecoder.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+//Baseline and progressive huffman coded jpeg, 8 bits grayscale, YCbCr or RGB.
+
+#define JPG_FAST_BITS 9     //huffman codes up to this length are decoded by a table lookup
+#define JPG_MAX_PIXELS (1 << 28)    //16384 x 16384, larger frames are rejected before anything is allocated
+
+struct JpgHuffman
+{
+    uint8_t fast[1 << JPG_FAST_BITS];   //code prefix -> symbol index, 255 if the code is longer
+    int16_t fastAc[1 << JPG_FAST_BITS]; //code prefix -> ac value << 8 | run << 4 | total length, 0 if longer
+    uint16_t code[256];
+    uint8_t values[256];
+    uint8_t size[257];
+    uint32_t maxcode[18];
+    int32_t delta[17];                  //symbol index - code, per code length
+    bool valid = false;
+};
+
+struct JpgComponent
+{
+    uint32_t id;
+    uint32_t hs, vs;                    //sampling factors
+    uint32_t tq, td, ta;                //quantization, dc and ac table indices
+    uint32_t w, h;                      //samples in the image, reduced
+    uint32_t bw, bh;                    //blocks per line and per column, padded to the mcus
+    uint32_t nx, ny;                    //samples of a reduced block
+    int32_t dcpred;
+    uint8_t* plane = nullptr;           //samples, bw x bh blocks of nx x ny
+    uint32_t stride;
+    int16_t* coefs = nullptr;           //progressive: the coefficients of all blocks, quantized
+};
+
+struct JpgDecoder
+{
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+    uint32_t w = 0, h = 0;
+    bool progressive = false;
+    bool rgb = false;                   //components are not YCbCr, adobe transform 0
+    uint32_t ncomps = 0;
+    JpgComponent comps[3];
+    uint16_t qt[4][64] = {};            //zigzag order
+    uint32_t qtDefined = 0;             //bits of the tables given by the file
+    JpgHuffman hdc[4], hac[4];
+    uint32_t hmax = 1, vmax = 1;
+    uint32_t mcusX, mcusY;
+    uint32_t restart = 0;               //restart interval, in mcus
+
+    //level of detail: a full resolution block is reduced to n x n samples
+    uint32_t n = 8;
+
+    //entropy coded data
+    uint32_t buffer = 0;
+    int32_t bits = 0;
+    uint32_t marker = 0;                //reached marker, the data stops there
+
+    //current scan
+    JpgComponent* scomps[3];
+    uint32_t nscomps = 0;
+    uint32_t ss, se, ah, al;
+    uint32_t eobrun;
+
+    ~JpgDecoder()
+    {
+        for (uint32_t i = 0; i < ncomps; ++i) {
+            free(comps[i].plane);
+            free(comps[i].coefs);
+        }
+    }
+};
+
+
+static const uint8_t _zigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10,
+    17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63
+};
+
+
+static uint32_t _u16(const uint8_t* p)
+{
+    return (p[0] << 8) | p[1];
+}
+
+
+static uint8_t _clamp(int32_t v)
+{
+    if (v < 0) return 0;
+    if (v > 255) return 255;
+    return static_cast<uint8_t>(v);
+}
+
+
+static bool _buildHuffman(JpgHuffman* h, const uint8_t* counts)
+{
+    uint32_t k = 0;
+    for (uint32_t i = 0; i < 16; ++i) {
+        for (uint32_t j = 0; j < counts[i]; ++j) h->size[k++] = static_cast<uint8_t>(i + 1);
+    }
+    h->size[k] = 0;
+
+    uint32_t code = 0;
+    k = 0;
+    for (uint32_t j = 1; j <= 16; ++j) {
+        h->delta[j] = static_cast<int32_t>(k) - static_cast<int32_t>(code);
+        if (h->size[k] == j) {
+            while (h->size[k] == j) h->code[k++] = static_cast<uint16_t>(code++);
+            if (code - 1 >= (1u << j)) return false;
+        }
+        h->maxcode[j] = code << (16 - j);
+        code <<= 1;
+    }
+    h->maxcode[17] = 0xffffffff;
+
+    memset(h->fast, 255, sizeof(h->fast));
+    for (uint32_t i = 0; i < k; ++i) {
+        uint32_t s = h->size[i];
+        if (s > JPG_FAST_BITS) continue;
+        uint32_t c = h->code[i] << (JPG_FAST_BITS - s);
+        uint32_t m = 1 << (JPG_FAST_BITS - s);
+        for (uint32_t j = 0; j < m; ++j) h->fast[c + j] = static_cast<uint8_t>(i);
+    }
+    h->valid = true;
+    return true;
+}
+
+
+//Ac symbols and their magnitude bits in a single lookup, if they fit in the prefix.
+static void _buildFastAc(JpgHuffman* h)
+{
+    for (int32_t i = 0; i < (1 << JPG_FAST_BITS); ++i) {
+        h->fastAc[i] = 0;
+        auto k = h->fast[i];
+        if (k == 255) continue;
+        int32_t rs = h->values[k];
+        int32_t r = rs >> 4;
+        int32_t s = rs & 15;
+        int32_t len = h->size[k];
+        if (s == 0 || len + s > JPG_FAST_BITS) continue;
+        int32_t v = ((i << len) & ((1 << JPG_FAST_BITS) - 1)) >> (JPG_FAST_BITS - s);
+        if (v < (1 << (s - 1))) v -= (1 << s) - 1;
+        if (v >= -128 && v <= 127) h->fastAc[i] = static_cast<int16_t>(v * 256 + r * 16 + len + s);
+    }
+}
+
+
+/************************************************************************/
+/* Entropy Decoding                                                     */
+/************************************************************************/
+
+//Keep more than 24 bits in the buffer, zeros are fed once the data reaches a marker.
+static void _fill(JpgDecoder* d)
+{
+    while (d->bits <= 24) {
+        uint32_t c = 0;
+        if (!d->marker && d->pos < d->size) {
+            c = d->data[d->pos];
+            if (c == 0xff) {
+                auto next = (d->pos + 1 < d->size) ? d->data[d->pos + 1] : 0xd9;
+                if (next == 0) d->pos += 2;
+                else {
+                    d->marker = next;
+                    c = 0;
+                }
+            } else ++d->pos;
+        }
+        d->buffer |= c << (24 - d->bits);
+        d->bits += 8;
+    }
+}
+
+
+static uint32_t _bits(JpgDecoder* d, uint32_t n)
+{
+    if (d->bits < static_cast<int32_t>(n)) _fill(d);
+    auto v = d->buffer >> (32 - n);
+    d->buffer <<= n;
+    d->bits -= n;
+    return v;
+}
+
+
+static uint32_t _bit(JpgDecoder* d)
+{
+    return _bits(d, 1);
+}
+
+
+//The n bits value of the magnitude category n, sign extended.
+static int32_t _extend(JpgDecoder* d, uint32_t n)
+{
+    if (n == 0) return 0;
+    auto v = static_cast<int32_t>(_bits(d, n));
+    if (v < (1 << (n - 1))) v -= (1 << n) - 1;
+    return v;
+}
+
+
+static int32_t _decode(JpgDecoder* d, const JpgHuffman* h)
+{
+    if (d->bits < 16) _fill(d);
+
+    auto k = h->fast[d->buffer >> (32 - JPG_FAST_BITS)];
+    if (k < 255) {
+        uint32_t s = h->size[k];
+        d->buffer <<= s;
+        d->bits -= s;
+        return h->values[k];
+    }
+
+    auto prefix = d->buffer >> 16;
+    uint32_t s;
+    for (s = JPG_FAST_BITS + 1; s < 17; ++s) {
+        if (prefix < h->maxcode[s]) break;
+    }
+    if (s == 17) return -1;
+
+    auto c = static_cast<int32_t>(d->buffer >> (32 - s)) + h->delta[s];
+    if (c < 0 || c > 255) return -1;
+    d->buffer <<= s;
+    d->bits -= s;
+    return h->values[c];
+}
+
+
+//Hostile data can't overflow the idct: the dequantized coefficients of 8 bits samples are within +-2048.
+static inline int32_t _dequant(int32_t coef, uint16_t q)
+{
+    auto v = static_cast<int64_t>(coef) * q;
+    if (v < -2048) return -2048;
+    if (v > 2047) return 2047;
+    return static_cast<int32_t>(v);
+}
+
+
+//The dc differences of a broken file can't accumulate beyond the range of the coefficients.
+static inline int32_t _predict(int32_t dcpred, int32_t diff)
+{
+    auto dc = dcpred + diff;
+    if (dc < -32768) return -32768;
+    if (dc > 32767) return 32767;
+    return dc;
+}
+
+
+//Baseline block into natural order, dequantized. last returns the zigzag index of the last coefficient.
+static bool _decodeBlock(JpgDecoder* d, JpgComponent* c, int32_t* block, uint32_t* last)
+{
+    auto q = d->qt[c->tq];
+
+    auto t = _decode(d, &d->hdc[c->td]);
+    if (t < 0 || t > 15) return false;
+    c->dcpred = _predict(c->dcpred, _extend(d, t));
+    block[0] = _dequant(c->dcpred, q[0]);
+
+    *last = 0;
+
+    auto ac = &d->hac[c->ta];
+    for (uint32_t k = 1; k < 64; ) {
+        if (d->bits < 16) _fill(d);
+        auto fast = ac->fastAc[d->buffer >> (32 - JPG_FAST_BITS)];
+        if (fast) {
+            k += (fast >> 4) & 15;
+            if (k > 63) return false;
+            d->buffer <<= fast & 15;
+            d->bits -= fast & 15;
+            block[_zigzag[k]] = _dequant(fast >> 8, q[k]);
+            *last = k++;
+            continue;
+        }
+        auto rs = _decode(d, ac);
+        if (rs < 0) return false;
+        uint32_t s = rs & 15;
+        uint32_t r = rs >> 4;
+        if (s == 0) {
+            if (rs != 0xf0) break;  //end of block
+            k += 16;
+            continue;
+        }
+        k += r;
+        if (k > 63) return false;
+        block[_zigzag[k]] = _dequant(_extend(d, s), q[k]);
+        *last = k++;
+    }
+    return true;
+}
+
+
+//Progressive scan of a block, the coefficients are accumulated in the natural order.
+static bool _decodeProgressive(JpgDecoder* d, JpgComponent* c, int16_t* coefs)
+{
+    //Dc
+    if (d->ss == 0) {
+        if (d->ah == 0) {
+            auto t = _decode(d, &d->hdc[c->td]);
+            if (t < 0 || t > 15) return false;
+            c->dcpred = _predict(c->dcpred, _extend(d, t));
+            coefs[0] = static_cast<int16_t>(c->dcpred * (1 << d->al));
+        } else if (_bit(d)) {
+            coefs[0] |= static_cast<int16_t>(1 << d->al);
+        }
+        return true;
+    }
+
+    auto ac = &d->hac[c->ta];
+
+    //Ac, first pass
+    if (d->ah == 0) {
+        if (d->eobrun > 0) {
+            --d->eobrun;
+            return true;
+        }
+        for (uint32_t k = d->ss; k <= d->se; ) {
+            auto rs = _decode(d, ac);
+            if (rs < 0) return false;
+            uint32_t s = rs & 15;
+            uint32_t r = rs >> 4;
+            if (s == 0) {
+                if (r < 15) {
+                    d->eobrun = (1 << r) - 1;
+                    if (r > 0) d->eobrun += _bits(d, r);
+                    break;
+                }
+                k += 16;
+                continue;
+            }
+            k += r;
+            if (k > 63) return false;
+            coefs[_zigzag[k]] = static_cast<int16_t>(_extend(d, s) * (1 << d->al));
+            ++k;
+        }
+        return true;
+    }
+
+    //Ac, refinement: a correction bit for every nonzero coefficient passed by
+    auto bit = static_cast<int16_t>(1 << d->al);
+    auto refine = [&](int16_t* p) {
+        if (_bit(d) && (*p & bit) == 0) {
+            if (*p > 0) *p += bit;
+            else *p -= bit;
+        }
+    };
+
+    if (d->eobrun > 0) {
+        --d->eobrun;
+        for (uint32_t k = d->ss; k <= d->se; ++k) {
+            auto p = &coefs[_zigzag[k]];
+            if (*p != 0) refine(p);
+        }
+        return true;
+    }
+
+    for (uint32_t k = d->ss; k <= d->se; ) {
+        auto rs = _decode(d, ac);
+        if (rs < 0) return false;
+        int32_t s = rs & 15;
+        int32_t r = rs >> 4;
+        if (s == 0) {
+            //end of band: refine the rest of the block
+            if (r < 15) {
+                d->eobrun = (1 << r) - 1;
+                if (r > 0) d->eobrun += _bits(d, r);
+                r = 64;
+            }
+            //else 16 zeros are skipped, r = 15 and s = 0 place the last one.
+        } else {
+            if (s != 1) return false;
+            s = _bit(d) ? bit : -bit;
+        }
+        while (k <= d->se) {
+            auto p = &coefs[_zigzag[k++]];
+            if (*p != 0) refine(p);
+            else {
+                if (r == 0) {
+                    *p = static_cast<int16_t>(s);
+                    break;
+                }
+                --r;
+            }
+        }
+    }
+    return true;
+}
+
+
+/************************************************************************/
+/* Inverse DCT                                                          */
+/************************************************************************/
+
+#define JPG_FIX(x) static_cast<int32_t>((x) * 4096 + 0.5f)
+
+//One dimensional 8 point idct, in 12 bits fixed point. The even part is x0~x3, the odd part is t0~t3.
+#define JPG_IDCT_1D(s0, s1, s2, s3, s4, s5, s6, s7) \
+    int32_t t0, t1, t2, t3, p1, p2, p3, p4, p5, x0, x1, x2, x3; \
+    p2 = s2; \
+    p3 = s6; \
+    p1 = (p2 + p3) * JPG_FIX(0.5411961f); \
+    t2 = p1 + p3 * JPG_FIX(-1.847759065f); \
+    t3 = p1 + p2 * JPG_FIX(0.765366865f); \
+    p2 = s0; \
+    p3 = s4; \
+    t0 = (p2 + p3) * 4096; \
+    t1 = (p2 - p3) * 4096; \
+    x0 = t0 + t3; \
+    x3 = t0 - t3; \
+    x1 = t1 + t2; \
+    x2 = t1 - t2; \
+    t0 = s7; \
+    t1 = s5; \
+    t2 = s3; \
+    t3 = s1; \
+    p3 = t0 + t2; \
+    p4 = t1 + t3; \
+    p1 = t0 + t3; \
+    p2 = t1 + t2; \
+    p5 = (p3 + p4) * JPG_FIX(1.175875602f); \
+    t0 = t0 * JPG_FIX(0.298631336f); \
+    t1 = t1 * JPG_FIX(2.053119869f); \
+    t2 = t2 * JPG_FIX(3.072711026f); \
+    t3 = t3 * JPG_FIX(1.501321110f); \
+    p1 = p5 + p1 * JPG_FIX(-0.899976223f); \
+    p2 = p5 + p2 * JPG_FIX(-2.562915447f); \
+    p3 = p3 * JPG_FIX(-1.961570560f); \
+    p4 = p4 * JPG_FIX(-0.390180644f); \
+    t3 += p1 + p4; \
+    t2 += p2 + p3; \
+    t1 += p2 + p4; \
+    t0 += p1 + p3;
+
+
+static void _idct8(const int32_t* block, uint8_t* out, uint32_t stride)
+{
+    int32_t tmp[64];
+
+    //Columns, keeping 2 extra bits of precision
+    for (uint32_t i = 0; i < 8; ++i) {
+        auto d = block + i;
+        auto v = tmp + i;
+        if (!d[8] && !d[16] && !d[24] && !d[32] && !d[40] && !d[48] && !d[56]) {
+            auto dc = d[0] * 4;
+            v[0] = v[8] = v[16] = v[24] = v[32] = v[40] = v[48] = v[56] = dc;
+            continue;
+        }
+        JPG_IDCT_1D(d[0], d[8], d[16], d[24], d[32], d[40], d[48], d[56])
+        x0 += 512; x1 += 512; x2 += 512; x3 += 512;
+        v[0] = (x0 + t3) >> 10;
+        v[56] = (x0 - t3) >> 10;
+        v[8] = (x1 + t2) >> 10;
+        v[48] = (x1 - t2) >> 10;
+        v[16] = (x2 + t1) >> 10;
+        v[40] = (x2 - t1) >> 10;
+        v[24] = (x3 + t0) >> 10;
+        v[32] = (x3 - t0) >> 10;
+    }
+
+    //Rows: 12 bits of the constants, 2 bits of the columns and 3 bits of the two 1/sqrt(8) scales, plus the level shift
+    for (uint32_t i = 0; i < 8; ++i, out += stride) {
+        auto v = tmp + i * 8;
+        JPG_IDCT_1D(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7])
+        x0 += 65536 + (128 << 17);
+        x1 += 65536 + (128 << 17);
+        x2 += 65536 + (128 << 17);
+        x3 += 65536 + (128 << 17);
+        out[0] = _clamp((x0 + t3) >> 17);
+        out[7] = _clamp((x0 - t3) >> 17);
+        out[1] = _clamp((x1 + t2) >> 17);
+        out[6] = _clamp((x1 - t2) >> 17);
+        out[2] = _clamp((x2 + t1) >> 17);
+        out[5] = _clamp((x2 - t1) >> 17);
+        out[3] = _clamp((x3 + t0) >> 17);
+        out[4] = _clamp((x3 - t0) >> 17);
+    }
+}
+
+
+//Reduced idct: every sample is the average of the 8 point idct over its 8/n samples, as if box filtered.
+//basis[x][u] = average of C(u) / 2 * cos((2j + 1) * u * pi / 16) over j in the x-th 8/n samples, in 12 bits fixed point
+static const int32_t _basis1[1][8] = {
+    {1448, 0, 0, 0, 0, 0, 0, 0}
+};
+
+static const int32_t _basis2[2][8] = {
+    {1448, 1312, 0, -461, 0, 308, 0, -261},
+    {1448, -1312, 0, 461, 0, -308, 0, 261}
+};
+
+static const int32_t _basis4[4][8] = {
+    {1448, 1856, 1338, 652, 0, -435, -554, -369},
+    {1448, 769, -1338, -1573, 0, 1051, 554, -153},
+    {1448, -769, -1338, 1573, 0, -1051, 554, 153},
+    {1448, -1856, 1338, -652, 0, 435, -554, 369}
+};
+
+static const int32_t _basis8[8][8] = {
+    {1448, 2009, 1892, 1703, 1448, 1138, 784, 400},
+    {1448, 1703, 784, -400, -1448, -2009, -1892, -1138},
+    {1448, 1138, -784, -2009, -1448, 400, 1892, 1703},
+    {1448, 400, -1892, -1138, 1448, 1703, -784, -2009},
+    {1448, -400, -1892, 1138, 1448, -1703, -784, 2009},
+    {1448, -1138, -784, 2009, -1448, -400, 1892, -1703},
+    {1448, -1703, 784, 400, -1448, 2009, -1892, 1138},
+    {1448, -2009, 1892, -1703, 1448, -1138, 784, -400}
+};
+
+
+static const int32_t* _basis(uint32_t n)
+{
+    if (n == 1) return &_basis1[0][0];
+    if (n == 2) return &_basis2[0][0];
+    if (n == 4) return &_basis4[0][0];
+    return &_basis8[0][0];
+}
+
+
+static void _idctReduced(const int32_t* block, uint8_t* out, uint32_t stride, uint32_t nx, uint32_t ny)
+{
+    //Dc only, the average of the block
+    if (nx == 1 && ny == 1) {
+        *out = _clamp(((block[0] + 4) >> 3) + 128);
+        return;
+    }
+
+    auto bx = _basis(nx);
+    auto by = _basis(ny);
+    int32_t tmp[8 * 8];
+
+    //Columns, back to 2 extra bits of precision
+    for (uint32_t u = 0; u < 8; ++u) {
+        auto d = block + u;
+        if (!d[8] && !d[16] && !d[24] && !d[32] && !d[40] && !d[48] && !d[56]) {
+            auto dc = (by[0] * d[0] + 512) >> 10;
+            for (uint32_t y = 0; y < ny; ++y) tmp[y * 8 + u] = dc;
+            continue;
+        }
+        for (uint32_t y = 0; y < ny; ++y) {
+            int32_t sum = 0;
+            for (uint32_t v = 0; v < 8; ++v) sum += by[y * 8 + v] * block[v * 8 + u];
+            tmp[y * 8 + u] = (sum + 512) >> 10;
+        }
+    }
+
+    //Rows: 12 bits of the basis and 2 bits of the columns, plus the level shift
+    for (uint32_t y = 0; y < ny; ++y, out += stride) {
+        for (uint32_t x = 0; x < nx; ++x) {
+            int32_t sum = 0;
+            for (uint32_t u = 0; u < 8; ++u) sum += bx[x * 8 + u] * tmp[y * 8 + u];
+            out[x] = _clamp(((sum + (1 << 13)) >> 14) + 128);
+        }
+    }
+}
+
+
+//last is the zigzag index of the last nonzero coefficient.
+static void _idct(JpgComponent* c, const int32_t* block, uint32_t last, uint8_t* out)
+{
+    //Dc only, flat
+    if (last == 0) {
+        auto v = _clamp(((block[0] + 4) >> 3) + 128);
+        for (uint32_t y = 0; y < c->ny; ++y, out += c->stride) memset(out, v, c->nx);
+        return;
+    }
+    if (c->nx == 8 && c->ny == 8) _idct8(block, out, c->stride);
+    else _idctReduced(block, out, c->stride, c->nx, c->ny);
+}
+
+
+/************************************************************************/
+/* Markers                                                              */
+/************************************************************************/
+
+//Segment length, including its two bytes. Returns 0 if the segment is truncated.
+static uint32_t _segment(JpgDecoder* d)
+{
+    if (d->pos + 2 > d->size) return 0;
+    auto len = _u16(d->data + d->pos);
+    if (len < 2 || d->pos + len > d->size) return 0;
+    return len;
+}
+
+
+static bool _readDqt(JpgDecoder* d, uint32_t len)
+{
+    auto p = d->data + d->pos + 2;
+    auto end = d->data + d->pos + len;
+    while (p < end) {
+        auto precision = *p >> 4;
+        auto id = *p & 15;
+        ++p;
+        if (id > 3 || precision > 1) return false;
+        if (end - p < (precision ? 128 : 64)) return false;
+        for (uint32_t i = 0; i < 64; ++i) {
+            d->qt[id][i] = precision ? _u16(p + i * 2) : p[i];
+        }
+        d->qtDefined |= 1 << id;
+        p += precision ? 128 : 64;
+    }
+    return true;
+}
+
+
+static bool _readDht(JpgDecoder* d, uint32_t len)
+{
+    auto p = d->data + d->pos + 2;
+    auto end = d->data + d->pos + len;
+    while (p < end) {
+        auto tc = *p >> 4;
+        auto id = *p & 15;
+        ++p;
+        if (tc > 1 || id > 3 || end - p < 16) return false;
+        auto counts = p;
+        p += 16;
+        uint32_t total = 0;
+        for (uint32_t i = 0; i < 16; ++i) total += counts[i];
+        if (total > 256 || end - p < static_cast<ptrdiff_t>(total)) return false;
+        auto h = tc ? &d->hac[id] : &d->hdc[id];
+        if (!_buildHuffman(h, counts)) return false;
+        memcpy(h->values, p, total);
+        if (tc) _buildFastAc(h);
+        p += total;
+    }
+    return true;
+}
+
+
+static bool _readSof(JpgDecoder* d, uint32_t len)
+{
+    auto p = d->data + d->pos + 2;
+    if (len < 8 || d->ncomps > 0) return false;
+    if (p[0] != 8) return false;            //8 bits precision only
+    d->h = _u16(p + 1);
+    d->w = _u16(p + 3);
+    auto ncomps = p[5];
+    if (d->w == 0 || d->h == 0) return false;  //the height by a DNL marker is not supported
+    if (static_cast<uint64_t>(d->w) * d->h > JPG_MAX_PIXELS) return false;
+    if ((ncomps != 1 && ncomps != 3) || len != 8u + ncomps * 3u) return false;
+
+    p += 6;
+    for (uint32_t i = 0; i < ncomps; ++i, p += 3) {
+        auto c = &d->comps[i];
+        c->id = p[0];
+        c->hs = p[1] >> 4;
+        c->vs = p[1] & 15;
+        c->tq = p[2];
+        if (c->hs < 1 || c->hs > 4 || c->vs < 1 || c->vs > 4 || c->tq > 3) return false;
+        if (c->hs > d->hmax) d->hmax = c->hs;
+        if (c->vs > d->vmax) d->vmax = c->vs;
+    }
+    d->ncomps = ncomps;
+
+    //Rgb, tagged by the component ids
+    if (ncomps == 3 && d->comps[0].id == 'R' && d->comps[1].id == 'G' && d->comps[2].id == 'B') d->rgb = true;
+
+    //A single component is a block per mcu, regardless of its sampling factors.
+    if (ncomps == 1) d->comps[0].hs = d->comps[0].vs = d->hmax = d->vmax = 1;
+
+    return true;
+}
+
+
+static bool _readSos(JpgDecoder* d, uint32_t len)
+{
+    auto p = d->data + d->pos + 2;
+    if (len < 6) return false;
+    auto nscomps = p[0];
+    if (nscomps < 1 || nscomps > d->ncomps || len != 6u + nscomps * 2u) return false;
+    ++p;
+    for (uint32_t i = 0; i < nscomps; ++i, p += 2) {
+        JpgComponent* c = nullptr;
+        for (uint32_t j = 0; j < d->ncomps; ++j) {
+            if (d->comps[j].id == p[0]) c = &d->comps[j];
+        }
+        if (!c) return false;
+        c->td = p[1] >> 4;
+        c->ta = p[1] & 15;
+        if (c->td > 3 || c->ta > 3) return false;
+        d->scomps[i] = c;
+    }
+    d->nscomps = nscomps;
+    d->ss = p[0];
+    d->se = p[1];
+    d->ah = p[2] >> 4;
+    d->al = p[2] & 15;
+
+    if (d->progressive) {
+        if (d->ss > 63 || d->se > 63 || d->ss > d->se || d->ah > 13 || d->al > 13) return false;
+        //Dc scans are alone, ac scans have a single component
+        if (d->ss == 0 && d->se != 0) return false;
+        if (d->ss > 0 && nscomps != 1) return false;
+    } else {
+        if (d->ss != 0 || d->se != 63 || d->ah != 0 || d->al != 0) return false;
+    }
+
+    //Tables in use
+    for (uint32_t i = 0; i < nscomps; ++i) {
+        auto c = d->scomps[i];
+        if (d->ss == 0 && d->ah == 0 && !d->hdc[c->td].valid) return false;
+        //Progressive files may define it later, before the coefficients are dequantized.
+        if (!d->progressive && !(d->qtDefined & (1 << c->tq))) return false;
+        if (d->se > 0 && !d->hac[c->ta].valid) return false;
+    }
+    return true;
+}
+
+
+//Seek the next marker after the entropy coded data. Returns false at the end of the data.
+static bool _nextMarker(JpgDecoder* d)
+{
+    while (d->pos + 1 < d->size) {
+        if (d->data[d->pos] == 0xff) {
+            auto m = d->data[d->pos + 1];
+            if (m != 0 && m != 0xff && (m < 0xd0 || m > 0xd7)) return true;
+        }
+        ++d->pos;
+    }
+    return false;
+}
+
+
+static void _resetBits(JpgDecoder* d)
+{
+    d->buffer = 0;
+    d->bits = 0;
+    d->marker = 0;
+    d->eobrun = 0;
+    for (uint32_t i = 0; i < d->ncomps; ++i) d->comps[i].dcpred = 0;
+}
+
+
+//Skip the restart marker, the predictions start over.
+static void _restart(JpgDecoder* d)
+{
+    if (!d->marker) {
+        while (d->pos + 1 < d->size && !(d->data[d->pos] == 0xff && d->data[d->pos + 1] >= 0xd0 && d->data[d->pos + 1] <= 0xd7)) ++d->pos;
+        d->marker = (d->pos + 1 < d->size) ? d->data[d->pos + 1] : 0;
+    }
+    if (d->marker >= 0xd0 && d->marker <= 0xd7) d->pos += 2;
+    _resetBits(d);
+}
+
+
+/************************************************************************/
+/* Frame                                                                */
+/************************************************************************/
+
+static bool _allocate(JpgDecoder* d)
+{
+    d->mcusX = (d->w + d->hmax * 8 - 1) / (d->hmax * 8);
+    d->mcusY = (d->h + d->vmax * 8 - 1) / (d->vmax * 8);
+
+    for (uint32_t i = 0; i < d->ncomps; ++i) {
+        auto c = &d->comps[i];
+        c->bw = d->mcusX * c->hs;
+        c->bh = d->mcusY * c->vs;
+        //Subsampled components are reduced less, to need less upsampling.
+        c->nx = d->n * d->hmax / c->hs;
+        c->ny = d->n * d->vmax / c->vs;
+        if (c->nx > 8 || d->hmax % c->hs) c->nx = 8;
+        if (c->ny > 8 || d->vmax % c->vs) c->ny = 8;
+        c->stride = c->bw * c->nx;
+        //the reduced size of the samples in the image
+        auto w = (d->w * c->hs + d->hmax - 1) / d->hmax;
+        auto h = (d->h * c->vs + d->vmax - 1) / d->vmax;
+        c->w = (w * c->nx + 7) / 8;
+        c->h = (h * c->ny + 7) / 8;
+        c->plane = static_cast<uint8_t*>(calloc(static_cast<size_t>(c->stride) * c->bh, c->ny));
+        if (!c->plane) return false;
+        if (d->progressive) {
+            c->coefs = static_cast<int16_t*>(calloc(static_cast<size_t>(c->bw) * c->bh * 64, sizeof(int16_t)));
+            if (!c->coefs) return false;
+        }
+    }
+    return true;
+}
+
+
+static bool _decodeUnit(JpgDecoder* d, JpgComponent* c, uint32_t bx, uint32_t by)
+{
+    if (d->progressive) return _decodeProgressive(d, c, c->coefs + (static_cast<size_t>(by) * c->bw + bx) * 64);
+
+    int32_t block[64] = {0};
+    uint32_t last;
+    if (!_decodeBlock(d, c, block, &last)) return false;
+    _idct(c, block, last, c->plane + static_cast<size_t>(by) * c->ny * c->stride + bx * c->nx);
+    return true;
+}
+
+
+//The mcu at x, y: a block of a non interleaved scan, or the blocks of every component.
+static bool _decodeMcu(JpgDecoder* d, uint32_t x, uint32_t y)
+{
+    if (d->nscomps == 1) return _decodeUnit(d, d->scomps[0], x, y);
+
+    for (uint32_t i = 0; i < d->nscomps; ++i) {
+        auto c = d->scomps[i];
+        for (uint32_t v = 0; v < c->vs; ++v) {
+            for (uint32_t h = 0; h < c->hs; ++h) {
+                if (!_decodeUnit(d, c, x * c->hs + h, y * c->vs + v)) return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+static bool _decodeScan(JpgDecoder* d)
+{
+    _resetBits(d);
+
+    auto mcusX = d->mcusX;
+    auto mcusY = d->mcusY;
+
+    //Non interleaved, the blocks covering the component only
+    if (d->nscomps == 1) {
+        auto c = d->scomps[0];
+        mcusX = ((d->w * c->hs + d->hmax - 1) / d->hmax + 7) / 8;
+        mcusY = ((d->h * c->vs + d->vmax - 1) / d->vmax + 7) / 8;
+    }
+
+    auto todo = d->restart;
+    auto total = mcusX * mcusY;
+
+    for (uint32_t i = 0; i < total; ++i) {
+        if (!_decodeMcu(d, i % mcusX, i / mcusX)) {
+            if (!d->restart) return false;
+            //The rest of the broken interval is lost, the decoding starts over at the restart marker.
+            i += todo - 1;
+            todo = 1;
+        }
+        if (d->restart && --todo == 0) {
+            _restart(d);
+            todo = d->restart;
+        }
+    }
+    return true;
+}
+
+
+//Progressive coefficients are complete, dequantize and transform them all.
+static void _finishProgressive(JpgDecoder* d)
+{
+    for (uint32_t i = 0; i < d->ncomps; ++i) {
+        auto c = &d->comps[i];
+        auto q = d->qt[c->tq];
+        uint16_t dequant[64];
+        for (uint32_t k = 0; k < 64; ++k) dequant[_zigzag[k]] = q[k];
+
+        auto coefs = c->coefs;
+        for (uint32_t by = 0; by < c->bh; ++by) {
+            for (uint32_t bx = 0; bx < c->bw; ++bx, coefs += 64) {
+                int32_t block[64];
+                uint32_t last = 0;
+                for (uint32_t k = 0; k < 64; ++k) {
+                    block[k] = _dequant(coefs[k], dequant[k]);
+                    if (block[k]) last = k;
+                }
+                _idct(c, block, last, c->plane + static_cast<size_t>(by) * c->ny * c->stride + bx * c->nx);
+            }
+        }
+    }
+}
+
+
+//Read the markers up to the frame header, or through the whole image if decoding.
+static bool _parse(JpgDecoder* d, bool decode)
+{
+    if (d->size < 4 || d->data[0] != 0xff || d->data[1] != 0xd8) return false;
+    d->pos = 2;
+
+    auto frame = false;
+    auto scanned = false;
+
+    while (true) {
+        //Fill bytes before a marker
+        while (d->pos < d->size && d->data[d->pos] == 0xff && d->pos + 1 < d->size && d->data[d->pos + 1] == 0xff) ++d->pos;
+        if (d->pos + 2 > d->size || d->data[d->pos] != 0xff) return scanned;   //truncated: keep what is decoded
+        auto m = d->data[d->pos + 1];
+        d->pos += 2;
+
+        //End of image
+        if (m == 0xd9) return scanned;
+
+        //Markers without a segment
+        if (m == 0x01 || (m >= 0xd0 && m <= 0xd7)) continue;
+
+        auto len = _segment(d);
+        if (len == 0) return scanned;
+
+        switch (m) {
+            //Baseline, extended and progressive huffman frames
+            case 0xc0:
+            case 0xc1:
+            case 0xc2: {
+                if (frame) return false;
+                d->progressive = (m == 0xc2);
+                if (!_readSof(d, len)) return false;
+                if (!decode) return true;
+                if (!_allocate(d)) return false;
+                frame = true;
+                break;
+            }
+            //Lossless, hierarchical and arithmetic coded frames are not supported
+            case 0xc3: case 0xc5: case 0xc6: case 0xc7:
+            case 0xc9: case 0xca: case 0xcb:
+            case 0xcd: case 0xce: case 0xcf: {
+                return false;
+            }
+            case 0xc4: {
+                if (!_readDht(d, len)) return false;
+                break;
+            }
+            case 0xdb: {
+                if (!_readDqt(d, len)) return false;
+                break;
+            }
+            case 0xdd: {
+                if (len != 4) return false;
+                d->restart = _u16(d->data + d->pos + 2);
+                break;
+            }
+            case 0xda: {
+                if (!frame || !_readSos(d, len)) return false;
+                d->pos += len;
+                //Truncated before the coefficients
+                if (d->pos >= d->size) return scanned;
+                //A broken scan still shows the decoded part
+                if (!_decodeScan(d) && !scanned) return false;
+                scanned = true;
+                if (!_nextMarker(d)) return true;
+                continue;
+            }
+            //Adobe: the transform tells the colors are not YCbCr
+            case 0xee: {
+                auto p = d->data + d->pos + 2;
+                if (len >= 14 && !memcmp(p, "Adobe", 5) && d->ncomps == 0) d->rgb = (p[11] == 0);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+        d->pos += len;
+    }
+}
+
+
+/************************************************************************/
+/* Color                                                                */
+/************************************************************************/
+
+struct JpgTap
+{
+    uint32_t i0, i1;                    //neighbor samples
+    uint32_t f;                         //weight of i1, 8 bits fraction
+};
+
+
+//The sample position of an output pixel: s samples per d pixels, centered. Reduced samples are replicated.
+static void _tap(JpgDecoder* d, uint32_t i, uint32_t s, uint32_t n, uint32_t last, JpgTap* tap)
+{
+    int32_t p;
+    if (d->n < 8) p = static_cast<int32_t>((i * s) / n) << 8;
+    else p = static_cast<int32_t>(((2 * i + 1) * s * 128) / n) - 128;
+    if (p < 0) p = 0;
+    tap->i0 = static_cast<uint32_t>(p) >> 8;
+    tap->f = static_cast<uint32_t>(p) & 255;
+    if (tap->i0 >= last) {
+        tap->i0 = last;
+        tap->f = 0;
+    }
+    tap->i1 = (tap->i0 < last) ? tap->i0 + 1 : last;
+}
+
+
+//A component line in the output size, upsampled if subsampled: bilinear, or replicated if reduced since a sample already averages its area.
+static const uint8_t* _upsample(JpgDecoder* d, JpgComponent* c, uint32_t y, uint32_t w, const JpgTap* taps, uint8_t* vline, uint8_t* out)
+{
+    //Full resolution
+    if (!taps) return c->plane + static_cast<size_t>(y) * c->stride;
+
+    JpgTap ty;
+    _tap(d, y, c->vs * c->ny, d->vmax * d->n, c->h - 1, &ty);
+
+    //Vertical
+    auto line = c->plane + static_cast<size_t>(ty.i0) * c->stride;
+    if (ty.f > 0) {
+        auto l1 = c->plane + static_cast<size_t>(ty.i1) * c->stride;
+        for (uint32_t i = 0; i < c->w; ++i) vline[i] = static_cast<uint8_t>((line[i] * (256 - ty.f) + l1[i] * ty.f + 128) >> 8);
+        line = vline;
+    }
+
+    //Horizontal
+    for (uint32_t x = 0; x < w; ++x) {
+        auto& t = taps[x];
+        out[x] = static_cast<uint8_t>((line[t.i0] * (256 - t.f) + line[t.i1] * t.f + 128) >> 8);
+    }
+    return out;
+}
+
+
+static uint32_t* _convert(JpgDecoder* d, uint32_t w, uint32_t h)
+{
+    auto pixels = static_cast<uint32_t*>(malloc(static_cast<size_t>(w) * h * sizeof(uint32_t)));
+    //per component: the horizontal taps, the vertically interpolated and the output lines
+    auto taps = static_cast<JpgTap*>(malloc(static_cast<size_t>(w) * d->ncomps * sizeof(JpgTap)));
+    auto lines = static_cast<uint8_t*>(malloc(static_cast<size_t>(w) * d->ncomps * 2));
+    if (!pixels || !taps || !lines) {
+        free(pixels);
+        free(taps);
+        free(lines);
+        return nullptr;
+    }
+
+    const JpgTap* ctaps[3];
+    for (uint32_t i = 0; i < d->ncomps; ++i) {
+        auto c = &d->comps[i];
+        auto s = c->hs * c->nx;
+        auto n = d->hmax * d->n;
+        if (s == n && c->vs * c->ny == d->vmax * d->n) {
+            ctaps[i] = nullptr;
+            continue;
+        }
+        auto t = taps + i * w;
+        for (uint32_t x = 0; x < w; ++x) _tap(d, x, s, n, c->w - 1, t + x);
+        ctaps[i] = t;
+    }
+
+    const uint8_t* src[3];
+    auto dst = pixels;
+    for (uint32_t y = 0; y < h; ++y, dst += w) {
+        for (uint32_t i = 0; i < d->ncomps; ++i) {
+            src[i] = _upsample(d, &d->comps[i], y, w, ctaps[i], lines + (2 * i) * w, lines + (2 * i + 1) * w);
+        }
+
+        if (d->ncomps == 1) {
+            for (uint32_t x = 0; x < w; ++x) {
+                uint32_t l = src[0][x];
+                dst[x] = 0xff000000 | (l << 16) | (l << 8) | l;
+            }
+        } else if (d->rgb) {
+            for (uint32_t x = 0; x < w; ++x) {
+                dst[x] = 0xff000000 | (src[0][x] << 16) | (src[1][x] << 8) | src[2][x];
+            }
+        } else {
+            //Jfif YCbCr, 16 bits fixed point
+            for (uint32_t x = 0; x < w; ++x) {
+                int32_t l = src[0][x];
+                int32_t cb = src[1][x] - 128;
+                int32_t cr = src[2][x] - 128;
+                auto r = _clamp(l + ((91881 * cr + 32768) >> 16));
+                auto g = _clamp(l + ((-22554 * cb - 46802 * cr + 32768) >> 16));
+                auto b = _clamp(l + ((116130 * cb + 32768) >> 16));
+                dst[x] = 0xff000000 | (r << 16) | (g << 8) | b;
+            }
+        }
+    }
+    free(taps);
+    free(lines);
+    return pixels;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+bool jpgHeader(const unsigned char* data, size_t size, uint32_t* w, uint32_t* h)
+{
+    JpgDecoder d;
+    d.data = data;
+    d.size = size;
+    if (!_parse(&d, false) || d.ncomps == 0) return false;
+
+    *w = d.w;
+    *h = d.h;
+    return true;
+}
+
+
+uint32_t* jpgDecode(const unsigned char* data, size_t size, uint32_t* w, uint32_t* h, uint32_t level)
+{
+    JpgDecoder d;
+    d.data = data;
+    d.size = size;
+    //1/2, 1/4 and 1/8 are decoded with the reduced idct
+    d.n = 8 >> (level > 3 ? 3 : level);
+
+    if (!_parse(&d, true) || d.ncomps == 0) return nullptr;
+    if (d.progressive) _finishProgressive(&d);
+
+    auto width = (d.w * d.n + 7) / 8;
+    auto height = (d.h * d.n + 7) / 8;
+    auto pixels = _convert(&d, width, height);
+    if (!pixels) return nullptr;
+
+    *w = width;
+    *h = height;
+    return pixels;
+}
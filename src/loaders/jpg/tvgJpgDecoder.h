@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#ifndef _TVG_JPG_DECODER_H_
+#define _TVG_JPG_DECODER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//Reads the jpeg header only. Returns false if the data is not a supported jpeg.
+bool jpgHeader(const unsigned char* data, size_t size, uint32_t* w, uint32_t* h);
+
+//Decodes the jpeg data into opaque ARGB8888 pixels, allocated with malloc().
+//A level above 0 reduces the pixels to 1/2^level of the size, up to 1/8 in the DCT domain. w and h return the reduced size.
+uint32_t* jpgDecode(const unsigned char* data, size_t size, uint32_t* w, uint32_t* h, uint32_t level = 0);
+
+#endif //_TVG_JPG_DECODER_H_
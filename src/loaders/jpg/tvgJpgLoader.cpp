@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+#include <memory.h>
+#include "tvgLoaderMgr.h"
+#include "tvgJpgLoader.h"
+#include "tvgJpgDecoder.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+bool JpgLoader::header()
+{
+    uint32_t width, height;
+    if (!jpgHeader(data, size, &width, &height)) return false;
+
+    vw = w = width;
+    vh = h = height;
+
+    return true;
+}
+
+
+//Release the compressed data, the decoded pixels are kept.
+void JpgLoader::clear()
+{
+    if (copy) free((void*)data);
+    file.close();
+    data = nullptr;
+    size = 0;
+    copy = false;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+JpgLoader::JpgLoader()
+{
+    bitmap = true;
+}
+
+
+JpgLoader::~JpgLoader()
+{
+    clear();
+    free((void*)content);
+}
+
+
+bool JpgLoader::open(const string& path)
+{
+    clear();
+
+    if (!file.open(path)) return false;
+
+    data = reinterpret_cast<const unsigned char*>(file.data);
+    size = file.size;
+
+    return header();
+}
+
+
+bool JpgLoader::open(const char* data, uint32_t size, bool copy)
+{
+    clear();
+
+    if (copy) {
+        this->data = static_cast<unsigned char*>(malloc(size));
+        if (!this->data) return false;
+        memcpy((unsigned char*)this->data, data, size);
+    } else this->data = reinterpret_cast<const unsigned char*>(data);
+
+    this->size = size;
+    this->copy = copy;
+
+    return header();
+}
+
+
+bool JpgLoader::read()
+{
+    if (content) return true;
+    if (!data || size == 0) return false;
+
+    //The pixels are decoded lazily, at the level of detail the picture is drawn with.
+    notify(true);
+
+    return true;
+}
+
+
+bool JpgLoader::close()
+{
+    //The compressed data is kept for decoding the other levels of detail.
+    return true;
+}
+
+
+const uint32_t* JpgLoader::pixels()
+{
+    if (content || !data) return content;
+
+    //Decoded straight into the ARGB8888 pixels the raster engine blends, opaque.
+    uint32_t width, height;
+    content = jpgDecode(data, size, &width, &height);
+
+    return content;
+}
+
+
+uint32_t* JpgLoader::decode(uint32_t level, uint32_t* w, uint32_t* h)
+{
+    if (!data) return nullptr;
+    //Reduced in the DCT domain up to 1/8, skipping most of the idct work.
+    return jpgDecode(data, size, w, h, level);
+}
+
+
+void JpgLoader::release()
+{
+    //Nothing to decode them again from.
+    if (!data) return;
+    free((void*)content);
+    content = nullptr;
+}
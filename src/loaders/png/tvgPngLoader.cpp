@@ -19,61 +19,127 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
  * SOFTWARE.
  */
-
+#include <memory.h>
 #include "tvgLoaderMgr.h"
 #include "tvgPngLoader.h"
+#include "tvgLodePng.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+bool PngLoader::header()
+{
+    uint32_t width, height;
+    if (!lodePngHeader(data, size, &width, &height)) return false;
+
+    vw = w = width;
+    vh = h = height;
+
+    return true;
+}
+
+
+//Release the compressed data, the decoded pixels are kept.
+void PngLoader::clear()
+{
+    if (copy) free((void*)data);
+    file.close();
+    data = nullptr;
+    size = 0;
+    copy = false;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
 
 PngLoader::PngLoader()
 {
-    image = static_cast<png_imagep>(calloc(1, sizeof(png_image)));
-    image->version = PNG_IMAGE_VERSION;
-    image->opaque = NULL;
+    bitmap = true;
 }
 
+
 PngLoader::~PngLoader()
 {
-    if (content) {
-        free((void*)content);
-        content = nullptr;
-    }
-    free(image);
+    clear();
+    free((void*)content);
 }
 
+
 bool PngLoader::open(const string& path)
 {
-    image->opaque = NULL;
+    clear();
 
-    if (!png_image_begin_read_from_file(image, path.c_str())) return false;
+    if (!file.open(path)) return false;
 
-    vw = w = image->width;
-    vh = h = image->height;
+    data = reinterpret_cast<const unsigned char*>(file.data);
+    size = file.size;
 
-    return true;
+    return header();
 }
 
+
+bool PngLoader::open(const char* data, uint32_t size, bool copy)
+{
+    clear();
+
+    if (copy) {
+        this->data = static_cast<unsigned char*>(malloc(size));
+        if (!this->data) return false;
+        memcpy((unsigned char*)this->data, data, size);
+    } else this->data = reinterpret_cast<const unsigned char*>(data);
+
+    this->size = size;
+    this->copy = copy;
+
+    return header();
+}
+
+
 bool PngLoader::read()
 {
-    png_bytep buffer;
-    image->format = PNG_FORMAT_BGRA;
-    buffer = static_cast<png_bytep>(malloc(PNG_IMAGE_SIZE((*image))));
-    if (!buffer) {
-        // out of memory, only time when libpng doesnt free its data
-        png_image_free(image);
-        return false;
-    }
-    if (!png_image_finish_read(image, NULL, buffer, 0, NULL)) return false;
-    content = reinterpret_cast<uint32_t*>(buffer);
+    if (content) return true;
+    if (!data || size == 0) return false;
+
+    //The pixels are decoded lazily, at the level of detail the picture is drawn with.
+    notify(true);
 
     return true;
 }
 
+
 bool PngLoader::close()
 {
-    png_image_free(image);
+    //The compressed data is kept for decoding the other levels of detail.
     return true;
 }
 
+
 const uint32_t* PngLoader::pixels()
 {
-    return this->content;
-}
\ No newline at end of file
+    if (content || !data) return content;
+
+    //Decoded straight into the premultiplied pixels the raster engine blends.
+    uint32_t width, height;
+    content = lodePngDecode(data, size, &width, &height);
+
+    return content;
+}
+
+
+uint32_t* PngLoader::decode(uint32_t level, uint32_t* w, uint32_t* h)
+{
+    if (!data) return nullptr;
+    return lodePngDecode(data, size, w, h, level);
+}
+
+
+void PngLoader::release()
+{
+    //Nothing to decode them again from.
+    if (!data) return;
+    free((void*)content);
+    content = nullptr;
+}
@@ -22,24 +22,34 @@
 #ifndef _TVG_PNG_LOADER_H_
 #define _TVG_PNG_LOADER_H_
 
-#include <png.h>
+#include "tvgLoaderMgr.h"
 
 //OPTIMIZE ME: Use Task?
 class PngLoader : public Loader
 {
 public:
-    png_imagep image = nullptr;
+    FileMap file;
+    const unsigned char* data = nullptr;
+    uint32_t size = 0;
     const uint32_t* content = nullptr;
+    bool copy = false;
 
     PngLoader();
     ~PngLoader();
 
     using Loader::open;
     bool open(const string& path) override;
+    bool open(const char* data, uint32_t size, bool copy) override;
     bool read() override;
     bool close() override;
 
     const uint32_t* pixels() override;
+    uint32_t* decode(uint32_t level, uint32_t* w, uint32_t* h) override;
+    void release() override;
+
+private:
+    bool header();
+    void clear();
 };
 
-#endif //_TVG_PNG_LOADER_H_
\ No newline at end of file
+#endif //_TVG_PNG_LOADER_H_
@@ -32,6 +32,12 @@
 /* External Class Implementation                                        */
 /************************************************************************/
 
+RawLoader::RawLoader()
+{
+    bitmap = true;
+}
+
+
 RawLoader::~RawLoader()
 {
     if (copy && content) {
@@ -0,0 +1,723 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "tvgSvgCache.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+//Bump it whenever the layout of the records changes.
+#define SVG_CACHE_VERSION 3
+#define SVG_CACHE_MAX_DEPTH 1024
+
+//The records are written in the native byte order, the other machines reject the file.
+struct SvgCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t endian;
+    uint64_t sourceHash;
+    uint64_t sourceSize;
+    uint64_t payloadHash;
+    uint64_t payloadSize;
+};
+
+static constexpr char SVG_CACHE_MAGIC[8] = {'T', 'V', 'G', 'S', 'V', 'G', 'C', '\0'};
+static constexpr uint32_t SVG_CACHE_ENDIAN = 0x01020304;
+
+
+struct Writer
+{
+    char* data = nullptr;
+    size_t size = 0;
+    size_t reserved = 0;
+    bool failed = false;
+
+    void put(const void* src, size_t len)
+    {
+        if (failed) return;
+        if (size + len > reserved) {
+            auto newReserved = reserved ? reserved * 2 : 65536;
+            while (size + len > newReserved) newReserved *= 2;
+            auto newData = static_cast<char*>(realloc(data, newReserved));
+            if (!newData) {
+                failed = true;
+                return;
+            }
+            data = newData;
+            reserved = newReserved;
+        }
+        memcpy(data + size, src, len);
+        size += len;
+    }
+
+    template<typename T>
+    void put(T value)
+    {
+        put(&value, sizeof(T));
+    }
+
+    //The payload starts 8 bytes aligned, the float arrays are aligned to be read in place.
+    void align()
+    {
+        static const char zero[4] = {0, 0, 0, 0};
+        if (size & 3) put(zero, 4 - (size & 3));
+    }
+
+    void putString(const char* str)
+    {
+        uint32_t len = str ? strlen(str) + 1 : 0;
+        put(len);
+        if (len > 0) put(str, len);
+    }
+
+    void putFloats(const float* values, uint32_t count)
+    {
+        put(count);
+        align();
+        if (count > 0) put(values, count * sizeof(float));
+    }
+
+    ~Writer()
+    {
+        free(data);
+    }
+};
+
+
+struct Reader
+{
+    const char* p;
+    const char* end;
+    bool failed = false;
+
+    const char* block(size_t len)
+    {
+        if (failed || static_cast<size_t>(end - p) < len) {
+            failed = true;
+            return nullptr;
+        }
+        auto ret = p;
+        p += len;
+        return ret;
+    }
+
+    template<typename T>
+    T get()
+    {
+        T value{};
+        auto src = block(sizeof(T));
+        if (src) memcpy(&value, src, sizeof(T));
+        return value;
+    }
+
+    void align()
+    {
+        auto pad = reinterpret_cast<uintptr_t>(p) & 3;
+        if (pad) block(4 - pad);
+    }
+
+    char* getString()
+    {
+        auto len = get<uint32_t>();
+        if (len == 0) return nullptr;
+        auto str = block(len);
+        if (!str || str[len - 1] != '\0') {
+            failed = true;
+            return nullptr;
+        }
+        return const_cast<char*>(str);
+    }
+
+    float* getFloats(uint32_t* count)
+    {
+        *count = get<uint32_t>();
+        align();
+        if (*count == 0) return nullptr;
+        if (*count > static_cast<size_t>(end - p) / sizeof(float)) {
+            failed = true;
+            return nullptr;
+        }
+        return reinterpret_cast<float*>(const_cast<char*>(block(*count * sizeof(float))));
+    }
+
+    //The element counts are bounded by the remaining bytes, not to allocate for a broken file.
+    uint32_t getCount()
+    {
+        auto count = get<uint32_t>();
+        if (count > static_cast<size_t>(end - p)) failed = true;
+        return failed ? 0 : count;
+    }
+};
+
+
+//The composition targets are written once, after the document tree.
+struct CompTable
+{
+    Array<const SvgNode*> nodes;
+    uint32_t* slots = nullptr;      //node index + 1, 0 for an empty slot
+    uint32_t reserved = 0;
+
+    static uint32_t hash(const SvgNode* node)
+    {
+        auto key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(node));
+        return static_cast<uint32_t>((key * 0x9e3779b97f4a7c15ULL) >> 32);
+    }
+
+    void insert(uint32_t idx)
+    {
+        auto mask = reserved - 1;
+        auto i = hash(nodes.data[idx]) & mask;
+        while (slots[i]) i = (i + 1) & mask;
+        slots[i] = idx + 1;
+    }
+
+    //Index + 1 of the node, 0 for none
+    uint32_t index(const SvgNode* node)
+    {
+        if (!node) return 0;
+
+        if (reserved > 0) {
+            auto mask = reserved - 1;
+            for (auto i = hash(node) & mask; slots[i]; i = (i + 1) & mask) {
+                if (nodes.data[slots[i] - 1] == node) return slots[i];
+            }
+        }
+
+        if ((nodes.count + 1) * 2 > reserved) {
+            auto newReserved = reserved ? reserved * 2 : 64;
+            auto newSlots = static_cast<uint32_t*>(calloc(newReserved, sizeof(uint32_t)));
+            if (!newSlots) return 0;
+            free(slots);
+            slots = newSlots;
+            reserved = newReserved;
+            for (uint32_t i = 0; i < nodes.count; ++i) insert(i);
+        }
+        nodes.push(node);
+        insert(nodes.count - 1);
+        return nodes.count;
+    }
+
+    ~CompTable()
+    {
+        free(slots);
+    }
+};
+
+
+static uint64_t _hash(const char* data, size_t size)
+{
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v;
+        memcpy(&v, data + i, 8);
+        hash = (hash ^ v) * 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 29;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data + i, size - i);
+    hash = (hash ^ tail) * 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+
+static void _writeGradient(Writer* w, const SvgStyleGradient* grad)
+{
+    w->put<uint8_t>(grad ? 1 : 0);
+    if (!grad) return;
+
+    w->put<uint8_t>(static_cast<uint8_t>(grad->type));
+    w->put<uint8_t>(static_cast<uint8_t>(grad->spread));
+    w->put<uint8_t>(grad->userSpace);
+    w->put<uint8_t>(grad->usePercentage);
+    w->put<uint8_t>(grad->linear ? 1 : 0);
+    if (grad->linear) w->put(*grad->linear);
+    w->put<uint8_t>(grad->radial ? 1 : 0);
+    if (grad->radial) w->put(*grad->radial);
+    w->put<uint8_t>(grad->transform ? 1 : 0);
+    if (grad->transform) w->put(*grad->transform);
+    w->put(grad->stops.count);
+    for (uint32_t i = 0; i < grad->stops.count; ++i) w->put(*grad->stops.data[i]);
+}
+
+
+static void _writePaint(Writer* w, const SvgPaint* paint)
+{
+    _writeGradient(w, paint->gradient);
+    w->putString(paint->url);
+    w->put(paint->r);
+    w->put(paint->g);
+    w->put(paint->b);
+    w->put<uint8_t>(paint->none);
+    w->put<uint8_t>(paint->curColor);
+}
+
+
+static void _writeStyle(Writer* w, CompTable* comps, const SvgStyleProperty* style)
+{
+    _writePaint(w, &style->fill.paint);
+    w->put(style->fill.flags);
+    w->put(style->fill.opacity);
+    w->put(style->fill.fillRule);
+
+    _writePaint(w, &style->stroke.paint);
+    w->put(style->stroke.flags);
+    w->put(style->stroke.opacity);
+    w->put(style->stroke.scale);
+    w->put(style->stroke.width);
+    w->put(style->stroke.centered);
+    w->put(style->stroke.cap);
+    w->put(style->stroke.join);
+    w->put(style->stroke.dashCount);
+    w->putFloats(style->stroke.dash.array.data, style->stroke.dash.array.count);
+    w->put(style->stroke.dash.offset);
+
+    w->put(style->comp.method);
+    w->put(comps->index(style->comp.node));
+
+    w->put(style->opacity);
+    w->put(style->r);
+    w->put(style->g);
+    w->put(style->b);
+}
+
+
+static void _writeNode(Writer* w, CompTable* comps, const SvgNode* node)
+{
+    w->put<uint8_t>(static_cast<uint8_t>(node->type));
+    w->put<uint8_t>(node->display);
+    w->put<uint8_t>(node->transform ? 1 : 0);
+    if (node->transform) w->put(*node->transform);
+    _writeStyle(w, comps, node->style);
+
+    switch (node->type) {
+        case SvgNodeType::Doc: {
+            auto& doc = node->node.doc;
+            w->put(doc.w);
+            w->put(doc.h);
+            w->put(doc.vx);
+            w->put(doc.vy);
+            w->put(doc.vw);
+            w->put(doc.vh);
+            w->put<uint8_t>(doc.preserveAspect);
+            break;
+        }
+        case SvgNodeType::Circle: {
+            w->put(node->node.circle);
+            break;
+        }
+        case SvgNodeType::Ellipse: {
+            w->put(node->node.ellipse);
+            break;
+        }
+        case SvgNodeType::Rect: {
+            w->put(node->node.rect);
+            break;
+        }
+        case SvgNodeType::Line: {
+            w->put(node->node.line);
+            break;
+        }
+        case SvgNodeType::Path: {
+            w->putString(node->node.path.path);
+            break;
+        }
+        case SvgNodeType::Polygon:
+        case SvgNodeType::Polyline: {
+            w->putFloats(node->node.polygon.points, node->node.polygon.pointsCount);
+            break;
+        }
+        case SvgNodeType::Image: {
+            auto image = node->node.image.image;
+            w->putString(image->href);
+            w->put(image->x);
+            w->put(image->y);
+            w->put(image->w);
+            w->put(image->h);
+            w->put<uint8_t>(static_cast<uint8_t>(image->align));
+            w->put<uint8_t>(static_cast<uint8_t>(image->meetOrSlice));
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    w->put(node->child.count);
+    for (uint32_t i = 0; i < node->child.count; ++i) _writeNode(w, comps, node->child.data[i]);
+}
+
+
+struct Loading
+{
+    SvgArena* arena;
+    Reader r;
+    Array<SvgNode*> comps;          //nodes referring to the composition targets, by index until resolved
+    Array<SvgImage*> images;
+    const SvgLoaderData* loader;
+};
+
+
+//The arrays of a partially read tree
+static void _release(SvgNode* node)
+{
+    if (!node) return;
+    for (uint32_t i = 0; i < node->child.count; ++i) _release(node->child.data[i]);
+    node->child.reset();
+    if (node->style) {
+        node->style->stroke.dash.array.reset();
+        if (node->style->fill.paint.gradient) node->style->fill.paint.gradient->stops.reset();
+        if (node->style->stroke.paint.gradient) node->style->stroke.paint.gradient->stops.reset();
+    }
+}
+
+
+static SvgStyleGradient* _readGradient(Loading* l)
+{
+    auto& r = l->r;
+    if (!r.get<uint8_t>()) return nullptr;
+
+    auto grad = static_cast<SvgStyleGradient*>(l->arena->alloc(sizeof(SvgStyleGradient)));
+    if (!grad) {
+        r.failed = true;
+        return nullptr;
+    }
+    auto type = r.get<uint8_t>();
+    auto spread = r.get<uint8_t>();
+    if (type > static_cast<uint8_t>(SvgGradientType::Radial) || spread > static_cast<uint8_t>(FillSpread::Repeat)) r.failed = true;
+    grad->type = static_cast<SvgGradientType>(type);
+    grad->spread = static_cast<FillSpread>(spread);
+    grad->userSpace = r.get<uint8_t>();
+    grad->usePercentage = r.get<uint8_t>();
+    if (r.get<uint8_t>()) {
+        grad->linear = static_cast<SvgLinearGradient*>(l->arena->alloc(sizeof(SvgLinearGradient)));
+        if (grad->linear) *grad->linear = r.get<SvgLinearGradient>();
+        else r.failed = true;
+    }
+    if (r.get<uint8_t>()) {
+        grad->radial = static_cast<SvgRadialGradient*>(l->arena->alloc(sizeof(SvgRadialGradient)));
+        if (grad->radial) *grad->radial = r.get<SvgRadialGradient>();
+        else r.failed = true;
+    }
+    if (r.get<uint8_t>()) {
+        grad->transform = static_cast<Matrix*>(l->arena->alloc(sizeof(Matrix)));
+        if (grad->transform) *grad->transform = r.get<Matrix>();
+        else r.failed = true;
+    }
+    auto count = r.getCount();
+    if (count > 0) grad->stops.reserve(count);
+    for (uint32_t i = 0; i < count && !r.failed; ++i) {
+        auto stop = static_cast<Fill::ColorStop*>(l->arena->alloc(sizeof(Fill::ColorStop)));
+        if (!stop) {
+            r.failed = true;
+            break;
+        }
+        *stop = r.get<Fill::ColorStop>();
+        grad->stops.push(stop);
+    }
+    return grad;
+}
+
+
+static void _readPaint(Loading* l, SvgPaint* paint)
+{
+    auto& r = l->r;
+    paint->gradient = _readGradient(l);
+    paint->url = r.getString();
+    paint->r = r.get<uint8_t>();
+    paint->g = r.get<uint8_t>();
+    paint->b = r.get<uint8_t>();
+    paint->none = r.get<uint8_t>();
+    paint->curColor = r.get<uint8_t>();
+}
+
+
+static void _readStyle(Loading* l, SvgNode* node)
+{
+    auto& r = l->r;
+    auto style = node->style;
+
+    _readPaint(l, &style->fill.paint);
+    style->fill.flags = r.get<SvgFillFlags>();
+    style->fill.opacity = r.get<int>();
+    style->fill.fillRule = r.get<SvgFillRule>();
+
+    _readPaint(l, &style->stroke.paint);
+    style->stroke.flags = r.get<SvgStrokeFlags>();
+    style->stroke.opacity = r.get<int>();
+    style->stroke.scale = r.get<float>();
+    style->stroke.width = r.get<float>();
+    style->stroke.centered = r.get<float>();
+    style->stroke.cap = r.get<StrokeCap>();
+    style->stroke.join = r.get<StrokeJoin>();
+    style->stroke.dashCount = r.get<int>();
+    uint32_t count;
+    auto dash = r.getFloats(&count);
+    if (count > 0 && dash) {
+        style->stroke.dash.array.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) style->stroke.dash.array.push(dash[i]);
+    }
+    style->stroke.dash.offset = r.get<float>();
+
+    style->comp.method = r.get<CompositeMethod>();
+    auto comp = r.get<uint32_t>();
+    if (comp > 0) {
+        //Resolved once the targets are read
+        style->comp.node = reinterpret_cast<SvgNode*>(static_cast<uintptr_t>(comp));
+        l->comps.push(node);
+    }
+
+    style->opacity = r.get<int>();
+    style->r = r.get<uint8_t>();
+    style->g = r.get<uint8_t>();
+    style->b = r.get<uint8_t>();
+
+    if (static_cast<uint32_t>(style->fill.fillRule) > static_cast<uint32_t>(SvgFillRule::OddEven) ||
+        static_cast<uint32_t>(style->stroke.cap) > static_cast<uint32_t>(StrokeCap::Butt) ||
+        static_cast<uint32_t>(style->stroke.join) > static_cast<uint32_t>(StrokeJoin::Miter) ||
+        static_cast<uint32_t>(style->comp.method) > static_cast<uint32_t>(CompositeMethod::InvAlphaMask)) {
+        r.failed = true;
+    }
+}
+
+
+static SvgNode* _readNode(Loading* l, SvgNode* parent, uint32_t depth)
+{
+    auto& r = l->r;
+    if (depth > SVG_CACHE_MAX_DEPTH) {
+        r.failed = true;
+        return nullptr;
+    }
+
+    auto type = r.get<uint8_t>();
+    if (r.failed || type >= static_cast<uint8_t>(SvgNodeType::Unknown)) {
+        r.failed = true;
+        return nullptr;
+    }
+
+    auto node = static_cast<SvgNode*>(l->arena->alloc(sizeof(SvgNode)));
+    if (!node || !(node->style = static_cast<SvgStyleProperty*>(l->arena->alloc(sizeof(SvgStyleProperty))))) {
+        r.failed = true;
+        return nullptr;
+    }
+    node->type = static_cast<SvgNodeType>(type);
+    node->parent = parent;
+    if (parent) parent->child.push(node);
+
+    node->display = r.get<uint8_t>();
+    if (r.get<uint8_t>()) {
+        node->transform = static_cast<Matrix*>(l->arena->alloc(sizeof(Matrix)));
+        if (!node->transform) {
+            r.failed = true;
+            return node;
+        }
+        *node->transform = r.get<Matrix>();
+    }
+    _readStyle(l, node);
+
+    switch (node->type) {
+        case SvgNodeType::Doc: {
+            auto& doc = node->node.doc;
+            doc.w = r.get<float>();
+            doc.h = r.get<float>();
+            doc.vx = r.get<float>();
+            doc.vy = r.get<float>();
+            doc.vw = r.get<float>();
+            doc.vh = r.get<float>();
+            doc.preserveAspect = r.get<uint8_t>();
+            break;
+        }
+        case SvgNodeType::Circle: {
+            node->node.circle = r.get<SvgCircleNode>();
+            break;
+        }
+        case SvgNodeType::Ellipse: {
+            node->node.ellipse = r.get<SvgEllipseNode>();
+            break;
+        }
+        case SvgNodeType::Rect: {
+            node->node.rect = r.get<SvgRectNode>();
+            break;
+        }
+        case SvgNodeType::Line: {
+            node->node.line = r.get<SvgLineNode>();
+            break;
+        }
+        case SvgNodeType::Path: {
+            node->node.path.path = r.getString();
+            break;
+        }
+        case SvgNodeType::Polygon:
+        case SvgNodeType::Polyline: {
+            uint32_t count;
+            node->node.polygon.points = r.getFloats(&count);
+            node->node.polygon.pointsCount = count;
+            break;
+        }
+        case SvgNodeType::Image: {
+            auto image = new SvgImage;
+            l->images.push(image);
+            auto href = r.getString();
+            if (href) image->href = strdup(href);
+            image->dir = &l->loader->dir;
+            image->canceled = l->loader->canceled;
+            image->nested = l->loader->nested;
+            image->x = r.get<float>();
+            image->y = r.get<float>();
+            image->w = r.get<float>();
+            image->h = r.get<float>();
+            auto align = r.get<uint8_t>();
+            auto meetOrSlice = r.get<uint8_t>();
+            if (align > static_cast<uint8_t>(AspectRatioAlign::XMaxYMax) || meetOrSlice > static_cast<uint8_t>(AspectRatioMeetOrSlice::Slice)) r.failed = true;
+            image->align = static_cast<AspectRatioAlign>(align);
+            image->meetOrSlice = static_cast<AspectRatioMeetOrSlice>(meetOrSlice);
+            node->node.image.image = image;
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    auto count = r.getCount();
+    if (count > 0) node->child.reserve(count);
+    for (uint32_t i = 0; i < count && !r.failed; ++i) _readNode(l, node, depth + 1);
+
+    return node;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+uint64_t svgCacheKey(const char* content, uint32_t size)
+{
+    return _hash(content, size);
+}
+
+
+bool svgCacheSave(const SvgLoaderData* loader, const string& path, uint64_t key, uint32_t size)
+{
+    if (!loader->doc) return false;
+
+    Writer tree, targets;
+    CompTable comps;
+
+    _writeNode(&tree, &comps, loader->doc);
+    //The targets may refer to the other targets, the table grows while it's written.
+    for (uint32_t i = 0; i < comps.nodes.count; ++i) _writeNode(&targets, &comps, comps.nodes.data[i]);
+    tree.put(comps.nodes.count);
+    tree.align();
+    tree.put(targets.data, targets.size);
+    if (tree.failed || targets.failed) return false;
+
+    SvgCacheHeader header;
+    memcpy(header.magic, SVG_CACHE_MAGIC, sizeof(header.magic));
+    header.version = SVG_CACHE_VERSION;
+    header.endian = SVG_CACHE_ENDIAN;
+    header.sourceHash = key;
+    header.sourceSize = size;
+    header.payloadHash = _hash(tree.data, tree.size);
+    header.payloadSize = tree.size;
+
+    //Written aside and renamed, the readers never see a partial file.
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".%p.tmp", (void*)loader);
+    auto temp = path + suffix;
+
+    auto file = fopen(temp.c_str(), "wb");
+    if (!file) return false;
+    auto ret = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(tree.data, tree.size, 1, file) == 1;
+    if (fclose(file) != 0) ret = false;
+    if (ret) ret = (rename(temp.c_str(), path.c_str()) == 0);
+    if (!ret) remove(temp.c_str());
+
+    return ret;
+}
+
+
+bool svgCacheLoad(SvgLoaderData* loader, FileMap* file, const string& path, uint64_t key, uint32_t size)
+{
+    if (!file->open(path)) return false;
+
+    //Header and payload checks, a broken file falls back to the xml parsing.
+    SvgCacheHeader header;
+    if (file->size < sizeof(header)) return false;
+    memcpy(&header, file->data, sizeof(header));
+    if (memcmp(header.magic, SVG_CACHE_MAGIC, sizeof(header.magic)) || header.version != SVG_CACHE_VERSION || header.endian != SVG_CACHE_ENDIAN) return false;
+    if (header.sourceHash != key || header.sourceSize != size) return false;
+    if (header.payloadSize != file->size - sizeof(header)) return false;
+
+    auto payload = file->data + sizeof(header);
+    if (_hash(payload, header.payloadSize) != header.payloadHash) return false;
+
+    auto mark = loader->arena.mark();
+    Loading l = {&loader->arena, {payload, payload + header.payloadSize}, {}, {}, loader};
+
+    auto root = _readNode(&l, nullptr, 0);
+    auto count = l.r.getCount();
+    l.r.align();
+
+    //Kept under a defs node, as the document keeps its definitions.
+    auto defs = static_cast<SvgNode*>(loader->arena.alloc(sizeof(SvgNode)));
+    if (defs) defs->style = static_cast<SvgStyleProperty*>(loader->arena.alloc(sizeof(SvgStyleProperty)));
+    if (!defs || !defs->style) l.r.failed = true;
+    else defs->type = SvgNodeType::Defs;
+
+    for (uint32_t i = 0; i < count && !l.r.failed; ++i) _readNode(&l, defs, 0);
+
+    if (!l.r.failed && (!root || root->type != SvgNodeType::Doc || l.r.p != l.r.end)) l.r.failed = true;
+
+    for (uint32_t i = 0; i < l.comps.count && !l.r.failed; ++i) {
+        auto style = l.comps.data[i]->style;
+        auto idx = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(style->comp.node));
+        if (idx > defs->child.count) l.r.failed = true;
+        else style->comp.node = defs->child.data[idx - 1];
+    }
+
+    if (l.r.failed) {
+        _release(root);
+        _release(defs);
+        for (uint32_t i = 0; i < l.images.count; ++i) delete(l.images.data[i]);
+        loader->arena.rewind(mark);
+        return false;
+    }
+
+    //Replaces the document of the header parsing, as the xml parsing does.
+    root->node.doc.defs = defs;
+    loader->doc = root;
+
+    //Loaded while the scene is built.
+    for (uint32_t i = 0; i < l.images.count; ++i) {
+        auto image = l.images.data[i];
+        loader->images.push(image);
+        if (image->href) TaskScheduler::request(image);
+    }
+
+    return true;
+}
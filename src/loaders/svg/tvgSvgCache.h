@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_SVG_CACHE_H_
+#define _TVG_SVG_CACHE_H_
+
+#include "tvgLoaderMgr.h"
+#include "tvgSvgLoaderCommon.h"
+
+//Key of the svg source. It's not a cryptographic hash, the cache directory must be trusted.
+uint64_t svgCacheKey(const char* content, uint32_t size);
+
+//Write the resolved document of the given source (after the style, gradient and composite updates).
+bool svgCacheSave(const SvgLoaderData* loader, const string& path, uint64_t key, uint32_t size);
+
+//Rebuild the resolved document as loader->doc. The strings and the points refer to the mapped file.
+//Returns false without changing the document if the file is missing, outdated or corrupted.
+bool svgCacheLoad(SvgLoaderData* loader, FileMap* file, const string& path, uint64_t key, uint32_t size);
+
+#endif //_TVG_SVG_CACHE_H_
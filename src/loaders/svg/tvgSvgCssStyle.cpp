@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <string.h>
+#include "tvgSvgCssStyle.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+static constexpr struct
+{
+    const char* tag;
+    SvgNodeType type;
+} cssTypes[] = {
+    {"svg", SvgNodeType::Doc},
+    {"g", SvgNodeType::G},
+    {"use", SvgNodeType::Use},
+    {"path", SvgNodeType::Path},
+    {"rect", SvgNodeType::Rect},
+    {"circle", SvgNodeType::Circle},
+    {"ellipse", SvgNodeType::Ellipse},
+    {"line", SvgNodeType::Line},
+    {"polyline", SvgNodeType::Polyline},
+    {"polygon", SvgNodeType::Polygon},
+    {"image", SvgNodeType::Image},
+    {"clipPath", SvgNodeType::ClipPath},
+    {"mask", SvgNodeType::Mask}
+};
+
+
+static inline bool _isSpace(char c)
+{
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+
+static inline bool _isNameChar(char c)
+{
+    return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z')) || ((c >= '0') && (c <= '9')) || (c == '-') || (c == '_') || (static_cast<unsigned char>(c) >= 0x80);
+}
+
+
+static const char* _skipSpace(const char* str)
+{
+    while (_isSpace(*str)) ++str;
+    return str;
+}
+
+
+//Copy the style sheet without the comments. The copy is tokenized in place.
+static char* _stripComments(SvgArena* arena, const char* str, unsigned len)
+{
+    auto buf = static_cast<char*>(arena->alloc(len + 1));
+    if (!buf) return nullptr;
+
+    auto end = str + len;
+    auto dst = buf;
+    while (str < end) {
+        if (str + 1 < end && str[0] == '/' && str[1] == '*') {
+            str += 2;
+            while (str + 1 < end && !(str[0] == '*' && str[1] == '/')) ++str;
+            str += 2;
+            continue;
+        }
+        *dst++ = *str++;
+    }
+    *dst = '\0';
+    return buf;
+}
+
+
+//@import, @media, @font-face and the others are skipped with their blocks.
+static char* _skipAtRule(char* str)
+{
+    while (*str && *str != ';' && *str != '{') ++str;
+    if (*str == ';') return str + 1;
+
+    auto depth = 0;
+    while (*str) {
+        if (*str == '{') ++depth;
+        else if (*str == '}' && --depth == 0) return str + 1;
+        ++str;
+    }
+    return str;
+}
+
+
+static bool _hasClass(const char* list, const char* name, size_t len)
+{
+    while (*list) {
+        list = _skipSpace(list);
+        auto begin = list;
+        while (*list && !_isSpace(*list)) ++list;
+        if (static_cast<size_t>(list - begin) == len && !strncmp(begin, name, len)) return true;
+    }
+    return false;
+}
+
+
+static void _chain(SvgIdIndex* index, SvgCss* css, const char* key, SvgCssSelector* selector)
+{
+    auto head = static_cast<SvgCssSelector*>(index->find(key, css));
+    if (!head) {
+        index->push(key, selector, css);
+        return;
+    }
+    while (head->next) head = head->next;
+    head->next = selector;
+}
+
+
+//A compound selector: [type|*][.class]*[#id]
+static void _addSelector(SvgCss* css, SvgArena* arena, const char* str, const char* end, const char* decls)
+{
+    while (str < end && _isSpace(*str)) ++str;
+    while (end > str && _isSpace(end[-1])) --end;
+    if (str == end) return;
+
+    auto type = SvgNodeType::Unknown;
+    const char* id = nullptr;
+    size_t idLen = 0;
+    auto classes = static_cast<char*>(arena->alloc(end - str + 1));
+    if (!classes) return;
+    size_t classesLen = 0;
+    auto firstLen = 0;
+    uint32_t classCnt = 0;
+    auto typed = false;
+
+    while (str < end) {
+        auto prefix = *str;
+        if (prefix == '*') {
+            ++str;
+            continue;
+        }
+        if (prefix == '.' || prefix == '#') ++str;
+        auto name = str;
+        while (str < end && _isNameChar(*str)) ++str;
+        auto len = str - name;
+        //combinators, pseudo classes and attribute selectors
+        if (len == 0) return;
+
+        if (prefix == '.') {
+            if (classesLen > 0) classes[classesLen++] = ' ';
+            else firstLen = len;
+            memcpy(classes + classesLen, name, len);
+            classesLen += len;
+            ++classCnt;
+        } else if (prefix == '#') {
+            if (id) return;
+            id = name;
+            idLen = len;
+        } else {
+            if (typed) return;
+            unsigned i = 0;
+            for (; i < sizeof(cssTypes) / sizeof(cssTypes[0]); ++i) {
+                if (!strncmp(cssTypes[i].tag, name, len) && cssTypes[i].tag[len] == '\0') break;
+            }
+            //Not a drawn element
+            if (i == sizeof(cssTypes) / sizeof(cssTypes[0])) return;
+            type = cssTypes[i].type;
+            typed = true;
+        }
+    }
+
+    auto selector = static_cast<SvgCssSelector*>(arena->alloc(sizeof(SvgCssSelector)));
+    if (!selector) return;
+    selector->id = id ? arena->strdup(id, idLen) : nullptr;
+    selector->classes = (classCnt > 0) ? classes : nullptr;
+    selector->decls = decls;
+    selector->type = type;
+    selector->specificity = (id ? 10000 : 0) + classCnt * 100 + (typed ? 1 : 0);
+    selector->order = css->count++;
+
+    if (selector->id) _chain(&css->ids, css, selector->id, selector);
+    else if (classCnt > 0) _chain(&css->classes, css, arena->strdup(classes, firstLen), selector);
+    else {
+        auto head = &css->types[static_cast<int>(type)];
+        while (*head) head = &(*head)->next;
+        *head = selector;
+    }
+}
+
+
+static void _collect(SvgCss* css, SvgCssSelector* selector, const SvgNode* node)
+{
+    for (; selector; selector = selector->next) {
+        if (selector->type != SvgNodeType::Unknown && selector->type != node->type) continue;
+        if (selector->id && (!node->id || strcmp(selector->id, node->id))) continue;
+        if (selector->classes) {
+            if (!node->cls) continue;
+            auto matched = true;
+            auto name = selector->classes;
+            while (*name && matched) {
+                auto len = strcspn(name, " ");
+                matched = _hasClass(node->cls, name, len);
+                name += len;
+                if (*name) ++name;
+            }
+            if (!matched) continue;
+        }
+        //The element may have a class twice
+        auto dup = false;
+        for (uint32_t i = 0; i < css->matched.count; ++i) {
+            if (css->matched.data[i] == selector) {
+                dup = true;
+                break;
+            }
+        }
+        if (!dup) css->matched.push(selector);
+    }
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+void svgCssParse(SvgCss* css, SvgArena* arena, const char* str, unsigned len)
+{
+    auto p = _stripComments(arena, str, len);
+    if (!p) return;
+
+    while (true) {
+        p = const_cast<char*>(_skipSpace(p));
+        if (*p == '\0') break;
+
+        if (*p == '@') {
+            p = _skipAtRule(p);
+            continue;
+        }
+
+        auto open = strchr(p, '{');
+        if (!open) break;
+        auto close = strchr(open + 1, '}');
+        auto next = close ? close + 1 : open + strlen(open);
+
+        //The declarations are terminated in place.
+        *open = '\0';
+        if (close) *close = '\0';
+
+        auto selector = p;
+        while (true) {
+            auto comma = strchr(selector, ',');
+            auto end = comma ? comma : open;
+            _addSelector(css, arena, selector, end, open + 1);
+            if (!comma) break;
+            selector = comma + 1;
+        }
+        p = next;
+    }
+}
+
+
+uint32_t svgCssMatch(SvgCss* css, const SvgNode* node)
+{
+    css->matched.clear();
+    if (css->count == 0) return 0;
+
+    _collect(css, css->types[static_cast<int>(SvgNodeType::Unknown)], node);
+    _collect(css, css->types[static_cast<int>(node->type)], node);
+    if (node->id) _collect(css, static_cast<SvgCssSelector*>(css->ids.find(node->id, css)), node);
+
+    if (node->cls) {
+        const char* name = node->cls;
+        while (*name) {
+            name = _skipSpace(name);
+            auto len = 0;
+            while (name[len] && !_isSpace(name[len])) ++len;
+            if (len > 0) _collect(css, static_cast<SvgCssSelector*>(css->classes.find(name, len, css)), node);
+            name += len;
+        }
+    }
+
+    //The later and the more specific selectors override the others.
+    auto matched = css->matched.data;
+    for (uint32_t i = 1; i < css->matched.count; ++i) {
+        auto selector = matched[i];
+        auto j = i;
+        for (; j > 0; --j) {
+            auto prev = matched[j - 1];
+            if (prev->specificity < selector->specificity || (prev->specificity == selector->specificity && prev->order < selector->order)) break;
+            matched[j] = prev;
+        }
+        matched[j] = selector;
+    }
+    return css->matched.count;
+}
@@ -22,14 +22,16 @@
 
 #define _USE_MATH_DEFINES       //Math Constants are not defined in Standard C/C++.
 
-#include <fstream>
 #include <float.h>
 #include <math.h>
+#include <mutex>
 #include "tvgLoaderMgr.h"
 #include "tvgXmlParser.h"
 #include "tvgSvgLoader.h"
 #include "tvgSvgSceneBuilder.h"
 #include "tvgSvgUtil.h"
+#include "tvgSvgCssStyle.h"
+#include "tvgSvgCache.h"
 
 /************************************************************************/
 /* Internal Class Implementation                                        */
@@ -39,6 +41,10 @@ typedef SvgNode* (*FactoryMethod)(SvgLoaderData* loader, SvgNode* parent, const
 typedef SvgStyleGradient* (*GradientFactoryMethod)(SvgLoaderData* loader, const char* buf, unsigned bufLength);
 
 
+static string _cacheDir;
+static mutex _cacheMtx;
+
+
 static char* _skipSpace(const char* str, const char* end)
 {
     while (((end && str < end) || (!end && *str != '\0')) && isspace(*str)) {
@@ -48,11 +54,11 @@ static char* _skipSpace(const char* str, const char* end)
 }
 
 
-static string* _copyId(const char* str)
+static char* _copyId(SvgLoaderData* loader, const char* str)
 {
     if (!str) return nullptr;
 
-    return new string(str);
+    return loader->arena.strdup(str);
 }
 
 
@@ -76,6 +82,24 @@ static bool _parseNumber(const char** content, float* number)
     return true;
 }
 
+
+//The viewBox takes any number, the global area is saturated into its integers.
+static int _globalPos(float value)
+{
+    if (value != value) return 0;
+    if (value >= 2147483648.0f) return INT32_MAX;
+    if (value <= -2147483648.0f) return INT32_MIN;
+    return static_cast<int>(value);
+}
+
+
+static uint32_t _globalSize(float value)
+{
+    if (!(value > 0.0f)) return 0;
+    if (value >= 4294967296.0f) return UINT32_MAX;
+    return static_cast<uint32_t>(value);
+}
+
 /**
  * According to https://www.w3.org/TR/SVG/coords.html#Units
  *
@@ -260,11 +284,8 @@ _parseDashArray(const char *str, SvgDash* dash)
     if ((*dash).array.count == 1) (*dash).array.push((*dash).array.data[0]);
 }
 
-static string* _idFromUrl(const char* url)
+static char* _idFromUrl(SvgLoaderData* loader, const char* url)
 {
-    char tmp[50];
-    int i = 0;
-
     url = _skipSpace(url, nullptr);
     if ((*url) == '(') {
         ++url;
@@ -273,13 +294,10 @@ static string* _idFromUrl(const char* url)
 
     if ((*url) == '#') ++url;
 
-    while ((*url) != ')') {
-        tmp[i++] = *url;
-        ++url;
-    }
-    tmp[i] = '\0';
+    auto end = url;
+    while ((*end) != ')' && (*end) != '\0') ++end;
 
-    return new string(tmp);
+    return loader->arena.strdup(url, end - url);
 }
 
 
@@ -456,7 +474,7 @@ static constexpr struct
 };
 
 
-static void _toColor(const char* str, uint8_t* r, uint8_t* g, uint8_t* b, string** ref)
+static void _toColor(SvgLoaderData* loader, const char* str, uint8_t* r, uint8_t* g, uint8_t* b, char** ref)
 {
     unsigned int len = strlen(str);
     char *red, *green, *blue;
@@ -503,7 +521,7 @@ static void _toColor(const char* str, uint8_t* r, uint8_t* g, uint8_t* b, string
             }
         }
     } else if (len >= 3 && !strncmp(str, "url", 3)) {
-        *ref = _idFromUrl((const char*)(str + 3));
+        if (ref) *ref = _idFromUrl(loader, (const char*)(str + 3));
     } else {
         //Handle named color
         for (unsigned int i = 0; i < (sizeof(colors) / sizeof(colors[0])); i++) {
@@ -598,13 +616,12 @@ static void _matrixCompose(const Matrix* m1, const Matrix* m2, Matrix* dst)
 /* parse transform attribute
  * https://www.w3.org/TR/SVG/coords.html#TransformAttribute
  */
-static Matrix* _parseTransformationMatrix(const char* value)
+static Matrix* _parseTransformationMatrix(SvgLoaderData* loader, const char* value)
 {
     const int POINT_CNT = 8;
 
-    auto matrix = (Matrix*)malloc(sizeof(Matrix));
-    if (!matrix) return nullptr;
-    *matrix = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    Matrix m = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    auto matrix = &m;
 
     float points[POINT_CNT];
     int ptCount = 0;
@@ -674,9 +691,10 @@ static Matrix* _parseTransformationMatrix(const char* value)
             _matrixCompose(matrix, &tmp, matrix);
         }
     }
+    matrix = (Matrix*)loader->arena.alloc(sizeof(Matrix));
+    if (matrix) *matrix = m;
     return matrix;
 error:
-    if (matrix) free(matrix);
     return nullptr;
 }
 
@@ -717,7 +735,15 @@ static float _parseLength(const char* str, SvgLengthType* type)
 }
 
 
+//The classes are matched by the <style> rules once the document is parsed.
+static void _handleCssClassAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
+{
+    node->cls = _copyId(loader, value);
+}
+
+
 static bool _parseStyleAttr(void* data, const char* key, const char* value);
+static bool _parseInlineStyle(SvgLoaderData* loader, SvgNode* node, const char* value);
 
 
 static bool _attrParseSvgNode(void* data, const char* key, const char* value)
@@ -737,17 +763,19 @@ static bool _attrParseSvgNode(void* data, const char* key, const char* value)
             if (_parseNumber(&value, &doc->vy)) {
                 if (_parseNumber(&value, &doc->vw)) {
                     _parseNumber(&value, &doc->vh);
-                    loader->svgParse->global.h = doc->vh;
+                    loader->svgParse->global.h = _globalSize(doc->vh);
                 }
-                loader->svgParse->global.w = doc->vw;
+                loader->svgParse->global.w = _globalSize(doc->vw);
             }
-            loader->svgParse->global.y = doc->vy;
+            loader->svgParse->global.y = _globalPos(doc->vy);
         }
-        loader->svgParse->global.x = doc->vx;
+        loader->svgParse->global.x = _globalPos(doc->vx);
     } else if (!strcmp(key, "preserveAspectRatio")) {
         if (!strcmp(value, "none")) doc->preserveAspect = false;
     } else if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     }
 #ifdef THORVG_LOG_ENABLED
     else if (!strcmp(key, "x") || !strcmp(key, "y")) {
@@ -762,7 +790,7 @@ static bool _attrParseSvgNode(void* data, const char* key, const char* value)
 
 
 //https://www.w3.org/TR/SVGTiny12/painting.html#SpecifyingPaint
-static void _handlePaintAttr(SvgPaint* paint, const char* value)
+static void _handlePaintAttr(SvgLoaderData* loader, SvgPaint* paint, const char* value)
 {
     if (!strcmp(value, "none")) {
         //No paint property
@@ -774,30 +802,30 @@ static void _handlePaintAttr(SvgPaint* paint, const char* value)
         paint->curColor = true;
         return;
     }
-    _toColor(value, &paint->r, &paint->g, &paint->b, &paint->url);
+    _toColor(loader, value, &paint->r, &paint->g, &paint->b, &paint->url);
 }
 
 
-static void _handleColorAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
+static void _handleColorAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     SvgStyleProperty* style = node->style;
-    _toColor(value, &style->r, &style->g, &style->b, nullptr);
+    _toColor(loader, value, &style->r, &style->g, &style->b, nullptr);
 }
 
 
-static void _handleFillAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
+static void _handleFillAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     SvgStyleProperty* style = node->style;
     style->fill.flags = (SvgFillFlags)((int)style->fill.flags | (int)SvgFillFlags::Paint);
-    _handlePaintAttr(&style->fill.paint, value);
+    _handlePaintAttr(loader, &style->fill.paint, value);
 }
 
 
-static void _handleStrokeAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
+static void _handleStrokeAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     SvgStyleProperty* style = node->style;
     style->stroke.flags = (SvgStrokeFlags)((int)style->stroke.flags | (int)SvgStrokeFlags::Paint);
-    _handlePaintAttr(&style->stroke.paint, value);
+    _handlePaintAttr(loader, &style->stroke.paint, value);
 }
 
 
@@ -813,6 +841,12 @@ static void _handleStrokeDashArrayAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode
     _parseDashArray(value, &node->style->stroke.dash);
 }
 
+static void _handleStrokeDashOffsetAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
+{
+    node->style->stroke.flags = (SvgStrokeFlags)((int)node->style->stroke.flags | (int)SvgStrokeFlags::DashOffset);
+    node->style->stroke.dash.offset = _toFloat(loader->svgParse, value, SvgParserLengthType::Horizontal);
+}
+
 static void _handleStrokeWidthAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     node->style->stroke.flags = (SvgStrokeFlags)((int)node->style->stroke.flags | (int)SvgStrokeFlags::Width);
@@ -854,13 +888,13 @@ static void _handleFillOpacityAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* no
 }
 
 
-static void _handleTransformAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
+static void _handleTransformAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
-    node->transform = _parseTransformationMatrix(value);
+    node->transform = _parseTransformationMatrix(loader, value);
 }
 
 
-static void _handleClipPathAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
+static void _handleClipPathAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     SvgStyleProperty* style = node->style;
 #ifdef THORVG_LOG_ENABLED
@@ -868,11 +902,11 @@ static void _handleClipPathAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node,
 #endif
     style->comp.method = CompositeMethod::ClipPath;
     int len = strlen(value);
-    if (len >= 3 && !strncmp(value, "url", 3)) style->comp.url = _idFromUrl((const char*)(value + 3));
+    if (len >= 3 && !strncmp(value, "url", 3)) style->comp.url = _idFromUrl(loader, (const char*)(value + 3));
 }
 
 
-static void _handleMaskAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
+static void _handleMaskAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     SvgStyleProperty* style = node->style;
 #ifdef THORVG_LOG_ENABLED
@@ -882,8 +916,7 @@ static void _handleMaskAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, con
     int len = strlen(value);
     if (len >= 3 && !strncmp(value, "url", 3)) {
         //FIXME: Support multiple composition.
-        if (style->comp.url) delete(style->comp.url);
-        style->comp.url = _idFromUrl((const char*)(value + 3));
+        style->comp.url = _idFromUrl(loader, (const char*)(value + 3));
     }
 }
 
@@ -920,6 +953,7 @@ static constexpr struct
     STYLE_DEF(stroke-linecap, StrokeLineCap),
     STYLE_DEF(stroke-opacity, StrokeOpacity),
     STYLE_DEF(stroke-dasharray, StrokeDashArray),
+    STYLE_DEF(stroke-dashoffset, StrokeDashOffset),
     STYLE_DEF(transform, Transform),
     STYLE_DEF(clip-path, ClipPath),
     STYLE_DEF(mask, Mask),
@@ -950,6 +984,15 @@ static bool _parseStyleAttr(void* data, const char* key, const char* value)
     return false;
 }
 
+
+//The inline style is kept to be applied again over the <style> rules.
+static bool _parseInlineStyle(SvgLoaderData* loader, SvgNode* node, const char* value)
+{
+    node->inlineStyle = _copyId(loader, value);
+    return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+}
+
+
 /* parse g node
  * https://www.w3.org/TR/SVG/struct.html#Groups
  */
@@ -959,11 +1002,13 @@ static bool _attrParseGNode(void* data, const char* key, const char* value)
     SvgNode* node = loader->svgParse->node;
 
     if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "transform")) {
-        node->transform = _parseTransformationMatrix(value);
+        node->transform = _parseTransformationMatrix(loader, value);
     } else if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
@@ -984,11 +1029,13 @@ static bool _attrParseClipPathNode(void* data, const char* key, const char* valu
     SvgNode* node = loader->svgParse->node;
 
     if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "transform")) {
-        node->transform = _parseTransformationMatrix(value);
+        node->transform = _parseTransformationMatrix(loader, value);
     } else if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else {
         return _parseStyleAttr(loader, key, value);
     }
@@ -1002,11 +1049,13 @@ static bool _attrParseMaskNode(void* data, const char* key, const char* value)
     SvgNode* node = loader->svgParse->node;
 
     if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "transform")) {
-        node->transform = _parseTransformationMatrix(value);
+        node->transform = _parseTransformationMatrix(loader, value);
     } else if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else {
         return _parseStyleAttr(loader, key, value);
     }
@@ -1014,19 +1063,16 @@ static bool _attrParseMaskNode(void* data, const char* key, const char* value)
 }
 
 
-static SvgNode* _createNode(SvgNode* parent, SvgNodeType type)
+static SvgNode* _createNode(SvgLoaderData* loader, SvgNode* parent, SvgNodeType type)
 {
-    SvgNode* node = (SvgNode*)calloc(1, sizeof(SvgNode));
+    SvgNode* node = (SvgNode*)loader->arena.alloc(sizeof(SvgNode));
 
     if (!node) return nullptr;
 
     //Default fill property
-    node->style = (SvgStyleProperty*)calloc(1, sizeof(SvgStyleProperty));
+    node->style = (SvgStyleProperty*)loader->arena.alloc(sizeof(SvgStyleProperty));
 
-    if (!node->style) {
-        free(node);
-        return nullptr;
-    }
+    if (!node->style) return nullptr;
 
     //Update the default value of stroke and fill
     //https://www.w3.org/TR/SVGTiny12/painting.html#SpecifyingPaint
@@ -1061,18 +1107,18 @@ static SvgNode* _createNode(SvgNode* parent, SvgNodeType type)
 }
 
 
-static SvgNode* _createDefsNode(TVG_UNUSED SvgLoaderData* loader, TVG_UNUSED SvgNode* parent, const char* buf, unsigned bufLength)
+static SvgNode* _createDefsNode(SvgLoaderData* loader, TVG_UNUSED SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    SvgNode* node = _createNode(nullptr, SvgNodeType::Defs);
+    SvgNode* node = _createNode(loader, nullptr, SvgNodeType::Defs);
     if (!node) return nullptr;
     simpleXmlParseAttributes(buf, bufLength, nullptr, node);
     return node;
 }
 
 
-static SvgNode* _createGNode(TVG_UNUSED SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
+static SvgNode* _createGNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::G);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::G);
     if (!loader->svgParse->node) return nullptr;
 
     simpleXmlParseAttributes(buf, bufLength, _attrParseGNode, loader);
@@ -1082,7 +1128,7 @@ static SvgNode* _createGNode(TVG_UNUSED SvgLoaderData* loader, SvgNode* parent,
 
 static SvgNode* _createSvgNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Doc);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Doc);
     if (!loader->svgParse->node) return nullptr;
     SvgDocNode* doc = &(loader->svgParse->node->node.doc);
 
@@ -1092,8 +1138,8 @@ static SvgNode* _createSvgNode(SvgLoaderData* loader, SvgNode* parent, const cha
     doc->preserveAspect = true;
     simpleXmlParseAttributes(buf, bufLength, _attrParseSvgNode, loader);
 
-    if (loader->svgParse->global.w == 0) loader->svgParse->global.w = loader->svgParse->node->node.doc.w;
-    if (loader->svgParse->global.h == 0) loader->svgParse->global.h = loader->svgParse->node->node.doc.h;
+    if (loader->svgParse->global.w == 0) loader->svgParse->global.w = _globalSize(loader->svgParse->node->node.doc.w);
+    if (loader->svgParse->global.h == 0) loader->svgParse->global.h = _globalSize(loader->svgParse->node->node.doc.h);
 
     return loader->svgParse->node;
 }
@@ -1101,7 +1147,7 @@ static SvgNode* _createSvgNode(SvgLoaderData* loader, SvgNode* parent, const cha
 
 static SvgNode* _createMaskNode(SvgLoaderData* loader, SvgNode* parent, TVG_UNUSED const char* buf, TVG_UNUSED unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Mask);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Mask);
     if (!loader->svgParse->node) return nullptr;
 
     simpleXmlParseAttributes(buf, bufLength, _attrParseMaskNode, loader);
@@ -1112,7 +1158,7 @@ static SvgNode* _createMaskNode(SvgLoaderData* loader, SvgNode* parent, TVG_UNUS
 
 static SvgNode* _createClipPathNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::ClipPath);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::ClipPath);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1131,15 +1177,17 @@ static bool _attrParsePathNode(void* data, const char* key, const char* value)
 
     if (!strcmp(key, "d")) {
         //Temporary: need to copy
-        path->path = _copyId(value);
+        path->path = _copyId(loader, value);
     } else if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
         _handleMaskAttr(loader, node, value);
     } else if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else {
         return _parseStyleAttr(loader, key, value);
     }
@@ -1149,7 +1197,7 @@ static bool _attrParsePathNode(void* data, const char* key, const char* value)
 
 static SvgNode* _createPathNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Path);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Path);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1192,13 +1240,15 @@ static bool _attrParseCircleNode(void* data, const char* key, const char* value)
     }
 
     if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
         _handleMaskAttr(loader, node, value);
     } else if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else {
         return _parseStyleAttr(loader, key, value);
     }
@@ -1208,7 +1258,7 @@ static bool _attrParseCircleNode(void* data, const char* key, const char* value)
 
 static SvgNode* _createCircleNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Circle);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Circle);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1251,9 +1301,11 @@ static bool _attrParseEllipseNode(void* data, const char* key, const char* value
     }
 
     if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
@@ -1267,7 +1319,7 @@ static bool _attrParseEllipseNode(void* data, const char* key, const char* value
 
 static SvgNode* _createEllipseNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Ellipse);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Ellipse);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1276,40 +1328,23 @@ static SvgNode* _createEllipseNode(SvgLoaderData* loader, SvgNode* parent, const
 }
 
 
-static bool _attrParsePolygonPoints(const char* str, float** points, int* ptCount)
+static bool _attrParsePolygonPoints(SvgLoaderData* loader, const char* str, float** points, int* ptCount)
 {
-    float tmp[50];
-    int tmpCount = 0;
-    int count = 0;
+    Array<float> tmp;
     float num;
-    float *pointArray = nullptr, *tmpArray;
 
-    while (_parseNumber(&str, &num)) {
-        tmp[tmpCount++] = num;
-        if (tmpCount == 50) {
-            tmpArray = (float*)realloc(pointArray, (count + tmpCount) * sizeof(float));
-            if (!tmpArray) goto error_alloc;
-            pointArray = tmpArray;
-            memcpy(&pointArray[count], tmp, tmpCount * sizeof(float));
-            count += tmpCount;
-            tmpCount = 0;
-        }
-    }
+    while (_parseNumber(&str, &num)) tmp.push(num);
 
-    if (tmpCount > 0) {
-        tmpArray = (float*)realloc(pointArray, (count + tmpCount) * sizeof(float));
-        if (!tmpArray) goto error_alloc;
-        pointArray = tmpArray;
-        memcpy(&pointArray[count], tmp, tmpCount * sizeof(float));
-        count += tmpCount;
+    if (tmp.count > 0) {
+        *points = (float*)loader->arena.alloc(tmp.count * sizeof(float));
+        if (!*points) {
+            //LOG: allocation for point array failed. out of memory
+            return false;
+        }
+        memcpy(*points, tmp.data, tmp.count * sizeof(float));
     }
-    *ptCount = count;
-    *points = pointArray;
+    *ptCount = tmp.count;
     return true;
-
-error_alloc:
-    //LOG: allocation for point array failed. out of memory
-    return false;
 }
 
 
@@ -1326,15 +1361,17 @@ static bool _attrParsePolygonNode(void* data, const char* key, const char* value
     else polygon = &(node->node.polyline);
 
     if (!strcmp(key, "points")) {
-        return _attrParsePolygonPoints(value, &polygon->points, &polygon->pointsCount);
+        return _attrParsePolygonPoints(loader, value, &polygon->points, &polygon->pointsCount);
     } else if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
         _handleMaskAttr(loader, node, value);
     } else if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else {
         return _parseStyleAttr(loader, key, value);
     }
@@ -1344,7 +1381,7 @@ static bool _attrParsePolygonNode(void* data, const char* key, const char* value
 
 static SvgNode* _createPolygonNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Polygon);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Polygon);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1355,7 +1392,7 @@ static SvgNode* _createPolygonNode(SvgLoaderData* loader, SvgNode* parent, const
 
 static SvgNode* _createPolylineNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Polyline);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Polyline);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1407,9 +1444,11 @@ static bool _attrParseRectNode(void* data, const char* key, const char* value)
     }
 
     if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else if (!strcmp(key, "style")) {
-        ret = simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        ret = _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
@@ -1424,7 +1463,7 @@ static bool _attrParseRectNode(void* data, const char* key, const char* value)
 
 static SvgNode* _createRectNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Rect);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Rect);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1469,9 +1508,11 @@ static bool _attrParseLineNode(void* data, const char* key, const char* value)
     }
 
     if (!strcmp(key, "id")) {
-        node->id = _copyId(value);
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
     } else if (!strcmp(key, "style")) {
-        return simpleXmlParseW3CAttribute(value, _parseStyleAttr, loader);
+        return _parseInlineStyle(loader, node, value);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
@@ -1485,7 +1526,7 @@ static bool _attrParseLineNode(void* data, const char* key, const char* value)
 
 static SvgNode* _createLineNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Line);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Line);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1494,11 +1535,135 @@ static SvgNode* _createLineNode(SvgLoaderData* loader, SvgNode* parent, const ch
 }
 
 
-static string* _idFromHref(const char* href)
+static constexpr struct
+{
+    AspectRatioAlign align;
+    const char* tag;
+} alignTags[] = {
+    { AspectRatioAlign::XMinYMin, "xMinYMin" },
+    { AspectRatioAlign::XMidYMin, "xMidYMin" },
+    { AspectRatioAlign::XMaxYMin, "xMaxYMin" },
+    { AspectRatioAlign::XMinYMid, "xMinYMid" },
+    { AspectRatioAlign::XMidYMid, "xMidYMid" },
+    { AspectRatioAlign::XMaxYMid, "xMaxYMid" },
+    { AspectRatioAlign::XMinYMax, "xMinYMax" },
+    { AspectRatioAlign::XMidYMax, "xMidYMax" },
+    { AspectRatioAlign::XMaxYMax, "xMaxYMax" }
+};
+
+
+//The word at str, up to a whitespace.
+static bool _isWord(const char* str, const char* word)
+{
+    auto len = strlen(word);
+    return !strncmp(str, word, len) && (str[len] == '\0' || isspace(str[len]));
+}
+
+
+/* "[defer] <align> [<meetOrSlice>]", an invalid value is ignored as the spec says.
+ * https://www.w3.org/TR/SVG11/coords.html#PreserveAspectRatioAttribute
+ */
+static void _parseAspectRatio(const char* str, AspectRatioAlign* align, AspectRatioMeetOrSlice* meetOrSlice)
+{
+    auto value = AspectRatioAlign::XMidYMid;
+    auto fit = AspectRatioMeetOrSlice::Meet;
+
+    str = _skipSpace(str, nullptr);
+    //It matters to the svg documents as images only, ignored.
+    if (_isWord(str, "defer")) str = _skipSpace(str + 5, nullptr);
+
+    if (_isWord(str, "none")) {
+        value = AspectRatioAlign::None;
+        str += 4;
+    } else {
+        unsigned i = 0;
+        for (; i < sizeof(alignTags) / sizeof(alignTags[0]); ++i) {
+            if (_isWord(str, alignTags[i].tag)) break;
+        }
+        if (i == sizeof(alignTags) / sizeof(alignTags[0])) return;
+        value = alignTags[i].align;
+        str += 8;
+    }
+
+    str = _skipSpace(str, nullptr);
+    if (_isWord(str, "meet")) str += 4;
+    else if (_isWord(str, "slice")) {
+        fit = AspectRatioMeetOrSlice::Slice;
+        str += 5;
+    }
+    if (*_skipSpace(str, nullptr) != '\0') return;
+
+    *align = value;
+    *meetOrSlice = fit;
+}
+
+
+/* parse the attributes for an image element.
+ * https://www.w3.org/TR/SVG11/struct.html#ImageElement
+ */
+static bool _attrParseImageNode(void* data, const char* key, const char* value)
+{
+    SvgLoaderData* loader = (SvgLoaderData*)data;
+    SvgNode* node = loader->svgParse->node;
+    SvgImage* image = node->node.image.image;
+
+    if (!strcmp(key, "x")) {
+        image->x = _toFloat(loader->svgParse, value, SvgParserLengthType::Horizontal);
+    } else if (!strcmp(key, "y")) {
+        image->y = _toFloat(loader->svgParse, value, SvgParserLengthType::Vertical);
+    } else if (!strcmp(key, "width")) {
+        image->w = _toFloat(loader->svgParse, value, SvgParserLengthType::Horizontal);
+    } else if (!strcmp(key, "height")) {
+        image->h = _toFloat(loader->svgParse, value, SvgParserLengthType::Vertical);
+    } else if (!strcmp(key, "href") || !strcmp(key, "xlink:href")) {
+        free(image->href);
+        image->href = strdup(value);
+    } else if (!strcmp(key, "preserveAspectRatio")) {
+        _parseAspectRatio(value, &image->align, &image->meetOrSlice);
+    } else if (!strcmp(key, "id")) {
+        node->id = _copyId(loader, value);
+    } else if (!strcmp(key, "class")) {
+        _handleCssClassAttr(loader, node, value);
+    } else if (!strcmp(key, "style")) {
+        return _parseInlineStyle(loader, node, value);
+    } else if (!strcmp(key, "clip-path")) {
+        _handleClipPathAttr(loader, node, value);
+    } else if (!strcmp(key, "mask")) {
+        _handleMaskAttr(loader, node, value);
+    } else {
+        return _parseStyleAttr(loader, key, value);
+    }
+    return true;
+}
+
+
+static SvgNode* _createImageNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
+{
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Image);
+
+    if (!loader->svgParse->node) return nullptr;
+
+    auto image = new SvgImage;
+    image->dir = &loader->dir;
+    image->canceled = loader->canceled;
+    image->nested = loader->nested;
+    loader->images.push(image);
+    loader->svgParse->node->node.image.image = image;
+
+    simpleXmlParseAttributes(buf, bufLength, _attrParseImageNode, loader);
+
+    //Load it while the rest of the document is parsed.
+    if (image->href) TaskScheduler::request(image);
+
+    return loader->svgParse->node;
+}
+
+
+static char* _idFromHref(SvgLoaderData* loader, const char* href)
 {
     href = _skipSpace(href, nullptr);
     if ((*href) == '#') href++;
-    return new string(href);
+    return loader->arena.strdup(href);
 }
 
 
@@ -1516,94 +1681,98 @@ static SvgNode* _getDefsNode(SvgNode* node)
 }
 
 
-static SvgNode* _findChildById(const SvgNode* node, const char* id)
+static SvgNode* _rootNode(SvgNode* node)
+{
+    while (node->parent) node = node->parent;
+    return node;
+}
+
+
+static void _registerNode(SvgLoaderData* loader, SvgNode* node)
+{
+    if (!node || !node->id) return;
+    loader->nodes.push(node->id, node, _rootNode(node));
+}
+
+
+static SvgNode* _findChildById(SvgLoaderData* loader, const SvgNode* node, const char* id)
 {
     if (!node) return nullptr;
 
+    //The first node of the tree usually is the child. Otherwise, look for a later sibling.
+    auto result = static_cast<SvgNode*>(loader->nodes.find(id, node));
+    if (!result || result->parent == node) return result;
+
     auto child = node->child.data;
     for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-        if (((*child)->id != nullptr) && !strcmp((*child)->id->c_str(), id)) return (*child);
+        if (((*child)->id != nullptr) && !strcmp((*child)->id, id)) return (*child);
     }
     return nullptr;
 }
 
-static SvgNode* _findNodeById(SvgNode *node, string* id)
-{
-    SvgNode* result = nullptr;
-    if (node->id && !node->id->compare(*id)) return node;
 
-    if (node->child.count > 0) {
-        auto child = node->child.data;
-        for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-            result = _findNodeById(*child, id);
-            if (result) break;
-        }
-    }
-    return result;
+static SvgNode* _findNodeById(SvgLoaderData* loader, const SvgNode* root, const char* id)
+{
+    return static_cast<SvgNode*>(loader->nodes.find(id, root));
 }
 
-static void _cloneGradStops(Array<Fill::ColorStop*>* dst, const Array<Fill::ColorStop*>* src)
+
+static void _cloneGradStops(SvgLoaderData* loader, Array<Fill::ColorStop*>* dst, const Array<Fill::ColorStop*>* src)
 {
     for (uint32_t i = 0; i < src->count; ++i) {
-        auto stop = static_cast<Fill::ColorStop *>(malloc(sizeof(Fill::ColorStop)));
+        auto stop = static_cast<Fill::ColorStop *>(loader->arena.alloc(sizeof(Fill::ColorStop)));
+        if (!stop) return;
         *stop = *src->data[i];
         dst->push(stop);
     }
 }
 
 
-static SvgStyleGradient* _cloneGradient(SvgStyleGradient* from)
+static SvgStyleGradient* _cloneGradient(SvgLoaderData* loader, SvgStyleGradient* from)
 {
     SvgStyleGradient* grad;
 
     if (!from) return nullptr;
 
-    grad = (SvgStyleGradient*)calloc(1, sizeof(SvgStyleGradient));
+    grad = (SvgStyleGradient*)loader->arena.alloc(sizeof(SvgStyleGradient));
     if (!grad) return nullptr;
     grad->type = from->type;
-    grad->id = from->id ? _copyId(from->id->c_str()) : nullptr;
-    grad->ref = from->ref ? _copyId(from->ref->c_str()) : nullptr;
+    //The strings are never modified, they can be shared.
+    grad->id = from->id;
+    grad->ref = from->ref;
     grad->spread = from->spread;
     grad->usePercentage = from->usePercentage;
     grad->userSpace = from->userSpace;
     if (from->transform) {
-        grad->transform = (Matrix*)calloc(1, sizeof(Matrix));
+        grad->transform = (Matrix*)loader->arena.alloc(sizeof(Matrix));
         if (grad->transform) memcpy(grad->transform, from->transform, sizeof(Matrix));
     }
     if (grad->type == SvgGradientType::Linear) {
-        grad->linear = (SvgLinearGradient*)calloc(1, sizeof(SvgLinearGradient));
-        if (!grad->linear) goto error_grad_alloc;
+        grad->linear = (SvgLinearGradient*)loader->arena.alloc(sizeof(SvgLinearGradient));
+        if (!grad->linear) return nullptr;
         memcpy(grad->linear, from->linear, sizeof(SvgLinearGradient));
     } else if (grad->type == SvgGradientType::Radial) {
-        grad->radial = (SvgRadialGradient*)calloc(1, sizeof(SvgRadialGradient));
-        if (!grad->radial) goto error_grad_alloc;
+        grad->radial = (SvgRadialGradient*)loader->arena.alloc(sizeof(SvgRadialGradient));
+        if (!grad->radial) return nullptr;
         memcpy(grad->radial, from->radial, sizeof(SvgRadialGradient));
     }
 
-    _cloneGradStops(&grad->stops, &from->stops);
+    _cloneGradStops(loader, &grad->stops, &from->stops);
     return grad;
-error_grad_alloc:
-    //LOG: allocation failed. out of memory
-    if (grad->transform) free(grad->transform);
-    if (grad->ref) delete grad->ref;
-    if (grad->id) delete grad->id;
-    if (grad) free(grad);
-    return nullptr;
 }
 
 
-static void _copyAttr(SvgNode* to, const SvgNode* from)
+static void _copyAttr(SvgLoaderData* loader, SvgNode* to, const SvgNode* from)
 {
     //Copy matrix attribute
     if (from->transform) {
-        to->transform = (Matrix*)malloc(sizeof(Matrix));
+        to->transform = (Matrix*)loader->arena.alloc(sizeof(Matrix));
         if (to->transform) *to->transform = *from->transform;
     }
-    //Copy style attribute
+    //Copy style attribute (urls are shared with the origin)
     *to->style = *from->style;
-    if (from->style->fill.paint.url) to->style->fill.paint.url = new string(from->style->fill.paint.url->c_str());
-    if (from->style->stroke.paint.url) to->style->stroke.paint.url = new string(from->style->stroke.paint.url->c_str());
-    if (from->style->comp.url) to->style->comp.url = new string(from->style->comp.url->c_str());
+    to->cls = from->cls;
+    to->inlineStyle = from->inlineStyle;
 
     //Copy node attribute
     switch (from->type) {
@@ -1639,19 +1808,21 @@ static void _copyAttr(SvgNode* to, const SvgNode* from)
             break;
         }
         case SvgNodeType::Path: {
-            if (from->node.path.path) to->node.path.path = new string(from->node.path.path->c_str());
+            to->node.path.path = from->node.path.path;
             break;
         }
         case SvgNodeType::Polygon: {
             to->node.polygon.pointsCount = from->node.polygon.pointsCount;
-            to->node.polygon.points = (float*)malloc(to->node.polygon.pointsCount * sizeof(float));
-            memcpy(to->node.polygon.points, from->node.polygon.points, to->node.polygon.pointsCount * sizeof(float));
+            to->node.polygon.points = from->node.polygon.points;
             break;
         }
         case SvgNodeType::Polyline: {
             to->node.polyline.pointsCount = from->node.polyline.pointsCount;
-            to->node.polyline.points = (float*)malloc(to->node.polyline.pointsCount * sizeof(float));
-            memcpy(to->node.polyline.points, from->node.polyline.points, to->node.polyline.pointsCount * sizeof(float));
+            to->node.polyline.points = from->node.polyline.points;
+            break;
+        }
+        case SvgNodeType::Image: {
+            to->node.image.image = from->node.image.image;
             break;
         }
         default: {
@@ -1661,20 +1832,20 @@ static void _copyAttr(SvgNode* to, const SvgNode* from)
 }
 
 
-static void _cloneNode(SvgNode* from, SvgNode* parent)
+static void _cloneNode(SvgLoaderData* loader, SvgNode* from, SvgNode* parent)
 {
     SvgNode* newNode;
     if (!from || !parent) return;
 
-    newNode = _createNode(parent, from->type);
+    newNode = _createNode(loader, parent, from->type);
 
     if (!newNode) return;
 
-    _copyAttr(newNode, from);
+    _copyAttr(loader, newNode, from);
 
     auto child = from->child.data;
     for (uint32_t i = 0; i < from->child.count; ++i, ++child) {
-        _cloneNode(*child, newNode);
+        _cloneNode(loader, *child, newNode);
     }
 }
 
@@ -1683,14 +1854,13 @@ static bool _attrParseUseNode(void* data, const char* key, const char* value)
 {
     SvgLoaderData* loader = (SvgLoaderData*)data;
     SvgNode *defs, *nodeFrom, *node = loader->svgParse->node;
-    string* id;
 
     if (!strcmp(key, "xlink:href")) {
-        id = _idFromHref(value);
+        auto id = _skipSpace(value, nullptr);
+        if ((*id) == '#') ++id;
         defs = _getDefsNode(node);
-        nodeFrom = _findChildById(defs, id->c_str());
-        _cloneNode(nodeFrom, node);
-        delete id;
+        nodeFrom = _findChildById(loader, defs, id);
+        _cloneNode(loader, nodeFrom, node);
     } else if (!strcmp(key, "clip-path")) {
         _handleClipPathAttr(loader, node, value);
     } else if (!strcmp(key, "mask")) {
@@ -1704,7 +1874,7 @@ static bool _attrParseUseNode(void* data, const char* key, const char* value)
 
 static SvgNode* _createUseNode(SvgLoaderData* loader, SvgNode* parent, const char* buf, unsigned bufLength)
 {
-    loader->svgParse->node = _createNode(parent, SvgNodeType::Use);
+    loader->svgParse->node = _createNode(loader, parent, SvgNodeType::Use);
 
     if (!loader->svgParse->node) return nullptr;
 
@@ -1726,7 +1896,8 @@ static constexpr struct
     {"polygon", sizeof("polygon"), _createPolygonNode},
     {"rect", sizeof("rect"), _createRectNode},
     {"polyline", sizeof("polyline"), _createPolylineNode},
-    {"line", sizeof("line"), _createLineNode}
+    {"line", sizeof("line"), _createLineNode},
+    {"image", sizeof("image"), _createImageNode}
 };
 
 
@@ -1881,15 +2052,15 @@ static bool _attrParseRadialGradientNode(void* data, const char* key, const char
     }
 
     if (!strcmp(key, "id")) {
-        grad->id = _copyId(value);
+        grad->id = _copyId(loader, value);
     } else if (!strcmp(key, "spreadMethod")) {
         grad->spread = _parseSpreadValue(value);
     } else if (!strcmp(key, "xlink:href")) {
-        grad->ref = _idFromHref(value);
+        grad->ref = _idFromHref(loader, value);
     } else if (!strcmp(key, "gradientUnits") && !strcmp(value, "userSpaceOnUse")) {
         grad->userSpace = true;
     } else if (!strcmp(key, "gradientTransform")) {
-        grad->transform = _parseTransformationMatrix(value);
+        grad->transform = _parseTransformationMatrix(loader, value);
     } else {
         return false;
     }
@@ -1900,17 +2071,14 @@ static bool _attrParseRadialGradientNode(void* data, const char* key, const char
 
 static SvgStyleGradient* _createRadialGradient(SvgLoaderData* loader, const char* buf, unsigned bufLength)
 {
-    SvgStyleGradient* grad = (SvgStyleGradient*)calloc(1, sizeof(SvgStyleGradient));
+    SvgStyleGradient* grad = (SvgStyleGradient*)loader->arena.alloc(sizeof(SvgStyleGradient));
     if (!grad) return nullptr;
     loader->svgParse->styleGrad = grad;
 
     grad->type = SvgGradientType::Radial;
     grad->userSpace = false;
-    grad->radial = (SvgRadialGradient*)calloc(1, sizeof(SvgRadialGradient));
-    if (!grad->radial) {
-        free(grad);
-        return nullptr;
-    }
+    grad->radial = (SvgRadialGradient*)loader->arena.alloc(sizeof(SvgRadialGradient));
+    if (!grad->radial) return nullptr;
     /**
     * Default values of gradient
     */
@@ -1945,7 +2113,7 @@ static bool _attrParseStops(void* data, const char* key, const char* value)
     } else if (!strcmp(key, "stop-opacity")) {
         stop->a = _toOpacity(value);
     } else if (!strcmp(key, "stop-color")) {
-        _toColor(value, &stop->r, &stop->g, &stop->b, nullptr);
+        _toColor(loader, value, &stop->r, &stop->g, &stop->b, nullptr);
     } else if (!strcmp(key, "style")) {
         simpleXmlParseW3CAttribute(value, _attrParseStops, data);
     } else {
@@ -2043,15 +2211,15 @@ static bool _attrParseLinearGradientNode(void* data, const char* key, const char
     }
 
     if (!strcmp(key, "id")) {
-        grad->id = _copyId(value);
+        grad->id = _copyId(loader, value);
     } else if (!strcmp(key, "spreadMethod")) {
         grad->spread = _parseSpreadValue(value);
     } else if (!strcmp(key, "xlink:href")) {
-        grad->ref = _idFromHref(value);
+        grad->ref = _idFromHref(loader, value);
     } else if (!strcmp(key, "gradientUnits") && !strcmp(value, "userSpaceOnUse")) {
         grad->userSpace = true;
     } else if (!strcmp(key, "gradientTransform")) {
-        grad->transform = _parseTransformationMatrix(value);
+        grad->transform = _parseTransformationMatrix(loader, value);
     } else {
         return false;
     }
@@ -2062,17 +2230,14 @@ static bool _attrParseLinearGradientNode(void* data, const char* key, const char
 
 static SvgStyleGradient* _createLinearGradient(SvgLoaderData* loader, const char* buf, unsigned bufLength)
 {
-    SvgStyleGradient* grad = (SvgStyleGradient*)calloc(1, sizeof(SvgStyleGradient));
+    SvgStyleGradient* grad = (SvgStyleGradient*)loader->arena.alloc(sizeof(SvgStyleGradient));
     if (!grad) return nullptr;
     loader->svgParse->styleGrad = grad;
 
     grad->type = SvgGradientType::Linear;
     grad->userSpace = false;
-    grad->linear = (SvgLinearGradient*)calloc(1, sizeof(SvgLinearGradient));
-    if (!grad->linear) {
-        free(grad);
-        return nullptr;
-    }
+    grad->linear = (SvgLinearGradient*)loader->arena.alloc(sizeof(SvgLinearGradient));
+    if (!grad->linear) return nullptr;
     /**
     * Default value of x2 is 100%
     */
@@ -2142,6 +2307,8 @@ static void _svgLoaderParerXmlClose(SvgLoaderData* loader, const char* content)
 {
     content = _skipSpace(content, nullptr);
 
+    if (!strncmp(content, "style", 5)) loader->openStyle = false;
+
     for (unsigned int i = 0; i < sizeof(popArray) / sizeof(popArray[0]); i++) {
         if (!strncmp(content, popArray[i].tag, popArray[i].sz - 1)) {
             loader->stack.pop();
@@ -2193,6 +2360,7 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
             else parent = loader->doc;
             node = method(loader, parent, attrs, attrsLength);
         }
+        _registerNode(loader, node);
 
         if (node->type == SvgNodeType::Defs) {
             loader->doc->node.doc.defs = node;
@@ -2205,6 +2373,7 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
         if (loader->stack.count > 0) parent = loader->stack.data[loader->stack.count - 1];
         else parent = loader->doc;
         node = method(loader, parent, attrs, attrsLength);
+        _registerNode(loader, node);
     } else if ((gradientMethod = _findGradientFactory(tagName))) {
         SvgStyleGradient* gradient;
         gradient = gradientMethod(loader, attrs, attrsLength);
@@ -2216,12 +2385,14 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
         //       refer to: https://developer.mozilla.org/en-US/docs/Web/SVG/Element/defs
         if (loader->def && loader->doc->node.doc.defs) {
             loader->def->node.defs.gradients.push(gradient);
+            loader->gradientIds.push(gradient->id, gradient, &loader->def->node.defs.gradients);
         } else {
             loader->gradients.push(gradient);
+            loader->gradientIds.push(gradient->id, gradient, &loader->gradients);
         }
         loader->latestGradient = gradient;
     } else if (!strcmp(tagName, "stop")) {
-        auto stop = static_cast<Fill::ColorStop*>(calloc(1, sizeof(Fill::ColorStop)));
+        auto stop = static_cast<Fill::ColorStop*>(loader->arena.alloc(sizeof(Fill::ColorStop)));
         if (!stop) return;
         loader->svgParse->gradStop = stop;
         /* default value for opacity */
@@ -2230,6 +2401,8 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
         if (loader->latestGradient) {
             loader->latestGradient->stops.push(stop);
         }
+    } else if (!strcmp(tagName, "style")) {
+        loader->openStyle = !empty;
     }
 #ifdef THORVG_LOG_ENABLED
     else {
@@ -2243,6 +2416,8 @@ static bool _svgLoaderParser(void* data, SimpleXMLType type, const char* content
 {
     SvgLoaderData* loader = (SvgLoaderData*)data;
 
+    if (*loader->canceled) return false;
+
     switch (type) {
         case SimpleXMLType::Open: {
             _svgLoaderParserXmlOpen(loader, content, length, false);
@@ -2257,7 +2432,10 @@ static bool _svgLoaderParser(void* data, SimpleXMLType type, const char* content
             break;
         }
         case SimpleXMLType::Data:
-        case SimpleXMLType::CData:
+        case SimpleXMLType::CData: {
+            if (loader->openStyle) svgCssParse(&loader->css, &loader->arena, content, length);
+            break;
+        }
         case SimpleXMLType::DoctypeChild: {
             break;
         }
@@ -2286,7 +2464,7 @@ static void _styleInherit(SvgStyleProperty* child, const SvgStyleProperty* paren
         child->fill.paint.b = parent->fill.paint.b;
         child->fill.paint.none = parent->fill.paint.none;
         child->fill.paint.curColor = parent->fill.paint.curColor;
-        if (parent->fill.paint.url) child->fill.paint.url = _copyId(parent->fill.paint.url->c_str());
+        child->fill.paint.url = parent->fill.paint.url;
     }
     if (!((int)child->fill.flags & (int)SvgFillFlags::Opacity)) {
         child->fill.opacity = parent->fill.opacity;
@@ -2301,7 +2479,7 @@ static void _styleInherit(SvgStyleProperty* child, const SvgStyleProperty* paren
         child->stroke.paint.b = parent->stroke.paint.b;
         child->stroke.paint.none = parent->stroke.paint.none;
         child->stroke.paint.curColor = parent->stroke.paint.curColor;
-        child->stroke.paint.url = parent->stroke.paint.url ? _copyId(parent->stroke.paint.url->c_str()) : nullptr;
+        child->stroke.paint.url = parent->stroke.paint.url;
     }
     if (!((int)child->stroke.flags & (int)SvgStrokeFlags::Opacity)) {
         child->stroke.opacity = parent->stroke.opacity;
@@ -2318,6 +2496,9 @@ static void _styleInherit(SvgStyleProperty* child, const SvgStyleProperty* paren
             }
         }
     }
+    if (!((int)child->stroke.flags & (int)SvgStrokeFlags::DashOffset)) {
+        child->stroke.dash.offset = parent->stroke.dash.offset;
+    }
     if (!((int)child->stroke.flags & (int)SvgStrokeFlags::Cap)) {
         child->stroke.cap = parent->stroke.cap;
     }
@@ -2335,7 +2516,7 @@ static void _inefficientNodeCheck(SvgNode* node){
 
     switch (node->type) {
         case SvgNodeType::Path: {
-            if (!node->node.path.path || node->node.path.path->empty()) printf("SVG: Inefficient elements used [Empty path][Node Type : %s]\n", simpleXmlNodeTypeToString(node->type).c_str());
+            if (!node->node.path.path || node->node.path.path[0] == '\0') printf("SVG: Inefficient elements used [Empty path][Node Type : %s]\n", simpleXmlNodeTypeToString(node->type).c_str());
             break;
         }
         case SvgNodeType::Ellipse: {
@@ -2364,8 +2545,34 @@ static void _inefficientNodeCheck(SvgNode* node){
 }
 #endif
 
-static void _updateStyle(SvgNode* node, SvgStyleProperty* parentStyle)
+//The <style> rules override the presentation attributes and the inline style overrides them.
+static void _applyCss(SvgLoaderData* loader, SvgNode* node)
 {
+    auto css = &loader->css;
+    if (svgCssMatch(css, node) == 0) return;
+
+    loader->svgParse->node = node;
+    for (uint32_t i = 0; i < css->matched.count; ++i) {
+        simpleXmlParseW3CAttribute(css->matched.data[i]->decls, _parseStyleAttr, loader);
+    }
+    if (node->inlineStyle) simpleXmlParseW3CAttribute(node->inlineStyle, _parseStyleAttr, loader);
+}
+
+
+static void _applyCssTree(SvgLoaderData* loader, SvgNode* node)
+{
+    _applyCss(loader, node);
+
+    auto child = node->child.data;
+    for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
+        _applyCssTree(loader, *child);
+    }
+}
+
+
+static void _updateStyle(SvgLoaderData* loader, SvgNode* node, SvgStyleProperty* parentStyle)
+{
+    _applyCss(loader, node);
     _styleInherit(node->style, parentStyle);
 #ifdef THORVG_LOG_ENABLED
     _inefficientNodeCheck(node);
@@ -2373,107 +2580,79 @@ static void _updateStyle(SvgNode* node, SvgStyleProperty* parentStyle)
 
     auto child = node->child.data;
     for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-        _updateStyle(*child, node->style);
+        _updateStyle(loader, *child, node->style);
     }
 }
 
 
-static SvgStyleGradient* _gradientDup(Array<SvgStyleGradient*>* gradients, const string* id)
+static SvgStyleGradient* _gradientDup(SvgLoaderData* loader, Array<SvgStyleGradient*>* gradients, const char* id)
 {
-    SvgStyleGradient* result = nullptr;
-
-    auto gradList = gradients->data;
+    auto from = static_cast<SvgStyleGradient*>(loader->gradientIds.find(id, gradients));
+    if (!from) return nullptr;
 
-    for (uint32_t i = 0; i < gradients->count; ++i) {
-        if (!((*gradList)->id->compare(*id))) {
-            result = _cloneGradient(*gradList);
-            break;
-        }
-        ++gradList;
-    }
+    auto result = _cloneGradient(loader, from);
 
     if (result && result->ref) {
-        gradList = gradients->data;
-        for (uint32_t i = 0; i < gradients->count; ++i) {
-            if (!((*gradList)->id->compare(*result->ref))) {
-                if (result->stops.count == 0) {
-                    _cloneGradStops(&result->stops, &(*gradList)->stops);
-                }
-                //TODO: Properly inherit other property
-                break;
-            }
-            ++gradList;
+        auto ref = static_cast<SvgStyleGradient*>(loader->gradientIds.find(result->ref, gradients));
+        if (ref && result->stops.count == 0) {
+            _cloneGradStops(loader, &result->stops, &ref->stops);
         }
+        //TODO: Properly inherit other property
     }
 
     return result;
 }
 
 
-static void _updateGradient(SvgNode* node, Array<SvgStyleGradient*>* gradients)
+static void _updateGradient(SvgLoaderData* loader, SvgNode* node, Array<SvgStyleGradient*>* gradients)
 {
     if (node->child.count > 0) {
         auto child = node->child.data;
         for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-            _updateGradient(*child, gradients);
+            _updateGradient(loader, *child, gradients);
         }
     } else {
         if (node->style->fill.paint.url) {
-            node->style->fill.paint.gradient = _gradientDup(gradients, node->style->fill.paint.url);
+            node->style->fill.paint.gradient = _gradientDup(loader, gradients, node->style->fill.paint.url);
         }
         if (node->style->stroke.paint.url) {
-            node->style->stroke.paint.gradient = _gradientDup(gradients, node->style->stroke.paint.url);
+            node->style->stroke.paint.gradient = _gradientDup(loader, gradients, node->style->stroke.paint.url);
         }
     }
 }
 
-static void _updateComposite(SvgNode* node, SvgNode* root)
+static void _updateComposite(SvgLoaderData* loader, SvgNode* node, SvgNode* root)
 {
     if (node->style->comp.url && !node->style->comp.node) {
-        SvgNode *findResult = _findNodeById(root, node->style->comp.url);
+        SvgNode *findResult = _findNodeById(loader, root, node->style->comp.url);
         if (findResult) node->style->comp.node = findResult;
     }
     if (node->child.count > 0) {
         auto child = node->child.data;
         for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-            _updateComposite(*child, root);
+            _updateComposite(loader, *child, root);
         }
     }
 }
 
+//The document lives in the loader arena. Only the array storages need to be released here.
 static void _freeGradientStyle(SvgStyleGradient* grad)
 {
     if (!grad) return;
-
-    delete grad->id;
-    delete grad->ref;
-    free(grad->radial);
-    free(grad->linear);
-    if (grad->transform) free(grad->transform);
-
-    for (uint32_t i = 0; i < grad->stops.count; ++i) {
-        auto colorStop = grad->stops.data[i];
-        free(colorStop);
-    }
     grad->stops.reset();
-    free(grad);
 }
 
+
 static void _freeNodeStyle(SvgStyleProperty* style)
 {
     if (!style) return;
 
-    //style->comp.node has only the addresses of node. Therefore, style->comp.node is released from _freeNode.
-    delete style->comp.url;
-
     _freeGradientStyle(style->fill.paint.gradient);
-    delete style->fill.paint.url;
     _freeGradientStyle(style->stroke.paint.gradient);
-    if (style->stroke.dash.array.count > 0) style->stroke.dash.array.reset();
-    delete style->stroke.paint.url;
-    free(style);
+    style->stroke.dash.array.reset();
 }
 
+
 static void _freeNode(SvgNode* node)
 {
     if (!node) return;
@@ -2484,22 +2663,8 @@ static void _freeNode(SvgNode* node)
     }
     node->child.reset();
 
-    delete node->id;
-    free(node->transform);
     _freeNodeStyle(node->style);
     switch (node->type) {
-         case SvgNodeType::Path: {
-             delete node->node.path.path;
-             break;
-         }
-         case SvgNodeType::Polygon: {
-             free(node->node.polygon.points);
-             break;
-         }
-         case SvgNodeType::Polyline: {
-             free(node->node.polyline.points);
-             break;
-         }
          case SvgNodeType::Doc: {
              _freeNode(node->node.doc.defs);
              break;
@@ -2517,7 +2682,6 @@ static void _freeNode(SvgNode* node)
              break;
          }
     }
-    free(node);
 }
 
 
@@ -2553,6 +2717,7 @@ static bool _svgLoaderParserForValidCheckXmlOpen(SvgLoaderData* loader, const ch
             node = method(loader, nullptr, attrs, attrsLength);
             loader->doc = node;
             loader->stack.push(node);
+            _registerNode(loader, node);
             return false;
         }
     }
@@ -2581,6 +2746,390 @@ static bool _svgLoaderParserForValidCheck(void* data, SimpleXMLType type, const
 }
 
 
+//Style urls and composition point to the other elements, the node tree is required.
+static bool _streamReferred(const SvgNode* node)
+{
+    auto style = node->style;
+    return style->fill.paint.url || style->stroke.paint.url || style->comp.url || style->comp.method != CompositeMethod::None;
+}
+
+
+//The paint scene of the current parent, nullptr if its children are not drawn.
+static Scene* _streamTarget(SvgLoaderData* loader)
+{
+    auto stream = &loader->stream;
+    if (loader->stack.count == 0) return stream->root;
+    if (!svgGroupVisible(loader->stack.data[loader->stack.count - 1])) return nullptr;
+    return stream->scenes.data[stream->scenes.count - 1];
+}
+
+
+static SvgNode* _streamNode(SvgLoaderData* loader, FactoryMethod method, const char* attrs, unsigned attrsLength)
+{
+    auto parent = (loader->stack.count > 0) ? loader->stack.data[loader->stack.count - 1] : loader->doc;
+    auto node = method(loader, parent, attrs, attrsLength);
+    if (!node) return nullptr;
+
+    //The node is consumed at once, it doesn't stay in the tree.
+    parent->child.pop();
+
+    if (_streamReferred(node)) {
+        node->style->stroke.dash.array.reset();
+        return nullptr;
+    }
+
+    _styleInherit(node->style, parent->style);
+#ifdef THORVG_LOG_ENABLED
+    _inefficientNodeCheck(node);
+#endif
+    return node;
+}
+
+
+static bool _streamPop(SvgLoaderData* loader)
+{
+    auto stream = &loader->stream;
+    if (loader->stack.count == 0) return false;
+
+    auto node = loader->stack.data[loader->stack.count - 1];
+    auto scene = stream->scenes.data[stream->scenes.count - 1];
+    auto mark = stream->marks.data[stream->marks.count - 1];
+    loader->stack.pop();
+    stream->scenes.pop();
+    stream->marks.pop();
+
+    //The doc is the root, it's finished after the parsing.
+    if (node == loader->doc) {
+        stream->root = scene;
+        return true;
+    }
+
+    if (scene) {
+        if (svgGroupVisible(node)) scene->opacity(node->style->opacity);
+        auto target = _streamTarget(loader);
+        if (target) target->push(unique_ptr<Scene>(scene));
+        else delete(scene);
+    }
+    node->child.reset();
+    node->style->stroke.dash.array.reset();
+    loader->arena.rewind(mark);
+    return true;
+}
+
+
+static bool _svgLoaderStreamXmlOpen(SvgLoaderData* loader, const char* content, unsigned int length)
+{
+    const char* attrs = nullptr;
+    int attrsLength = 0;
+    int sz = length;
+    char tagName[20] = "";
+    FactoryMethod method;
+    auto stream = &loader->stream;
+
+    attrs = simpleXmlFindAttributesTag(content, length);
+
+    if (!attrs) {
+        //Parse the empty tag
+        attrs = content;
+        while ((attrs != nullptr) && *attrs != '>') attrs++;
+    }
+
+    if (attrs) {
+        sz = attrs - content;
+        attrsLength = length - sz;
+        while ((sz > 0) && (isspace(content[sz - 1]))) sz--;
+        if ((unsigned)sz >= sizeof(tagName)) return true;
+        strncpy(tagName, content, sz);
+        tagName[sz] = '\0';
+    }
+
+    if ((method = _findGroupFactory(tagName))) {
+        if (!strcmp(tagName, "svg")) return true; //Already loadded <svg>(SvgNodeType::Doc) tag
+        //defs, mask and clipPath are referred by the others
+        if (strcmp(tagName, "g")) return false;
+
+        auto mark = loader->arena.mark();
+        auto target = _streamTarget(loader);
+        auto node = _streamNode(loader, method, attrs, attrsLength);
+        if (!node) return false;
+
+        loader->stack.push(node);
+        stream->scenes.push(target ? svgGroupBuild(node).release() : nullptr);
+        stream->marks.push(mark);
+    } else if ((method = _findGraphicsFactory(tagName))) {
+        if (!strcmp(tagName, "use")) return false;
+
+        auto mark = loader->arena.mark();
+        auto node = _streamNode(loader, method, attrs, attrsLength);
+        if (!node) return false;
+
+        auto target = _streamTarget(loader);
+        if (target) {
+            if (node->type == SvgNodeType::Image) {
+                auto image = svgImageBuild(node, stream->vx, stream->vy, stream->vw, stream->vh);
+                if (image) target->push(move(image));
+            } else {
+                auto shape = svgShapeBuild(node, stream->vx, stream->vy, stream->vw, stream->vh);
+                if (shape) target->push(move(shape));
+            }
+        }
+        node->style->stroke.dash.array.reset();
+        loader->arena.rewind(mark);
+    } else if (_findGradientFactory(tagName)) {
+        return false;
+    } else if (!strcmp(tagName, "style")) {
+        //The rules apply to the whole document, the elements parsed so far included.
+        return false;
+    }
+#ifdef THORVG_LOG_ENABLED
+    else if (strcmp(tagName, "stop")) {
+        if (!isIgnoreUnsupportedLogElements(tagName)) printf("SVG: Unsupported elements used [Elements: %s]\n", tagName);
+    }
+#endif
+    return true;
+}
+
+
+static void _svgLoaderStreamXmlClose(SvgLoaderData* loader, const char* content)
+{
+    content = _skipSpace(content, nullptr);
+
+    for (unsigned int i = 0; i < sizeof(popArray) / sizeof(popArray[0]); i++) {
+        if (!strncmp(content, popArray[i].tag, popArray[i].sz - 1)) {
+            _streamPop(loader);
+            break;
+        }
+    }
+}
+
+
+static bool _svgLoaderStream(void* data, SimpleXMLType type, const char* content, unsigned int length)
+{
+    SvgLoaderData* loader = (SvgLoaderData*)data;
+
+    if (*loader->canceled) {
+        loader->stream.failed = true;
+        return false;
+    }
+
+    switch (type) {
+        case SimpleXMLType::Open:
+        case SimpleXMLType::OpenEmpty: {
+            if (!_svgLoaderStreamXmlOpen(loader, content, length)) {
+                loader->stream.failed = true;
+                return false;
+            }
+            break;
+        }
+        case SimpleXMLType::Close: {
+            _svgLoaderStreamXmlClose(loader, content);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    return true;
+}
+
+
+//Build the paints while parsing, the node tree is not kept.
+//Returns nullptr if the document has references, then it needs to be loaded through the tree.
+static unique_ptr<Scene> _streamBuild(SvgLoaderData* loader, const char* content, uint32_t size, float vx, float vy, float vw, float vh)
+{
+    auto doc = loader->doc;
+    auto stream = &loader->stream;
+
+    if (!doc || _streamReferred(doc) || loader->stack.count != 1) return nullptr;
+
+#ifdef THORVG_LOG_ENABLED
+    _inefficientNodeCheck(doc);
+#endif
+
+    auto start = loader->arena.mark();
+
+    stream->failed = false;
+    stream->root = nullptr;
+    stream->vx = vx;
+    stream->vy = vy;
+    stream->vw = vw;
+    stream->vh = vh;
+    stream->scenes.push(svgGroupBuild(doc).release());
+    stream->marks.push(start);
+
+    simpleXmlParse(content, size, true, _svgLoaderStream, loader);
+
+    //Close the groups left open
+    while (!stream->failed && _streamPop(loader));
+
+    unique_ptr<Scene> docNode(stream->root);
+    stream->root = nullptr;
+
+    if (stream->failed) {
+        //Roll back to the header state.
+        for (uint32_t i = 0; i < stream->scenes.count; ++i) delete(stream->scenes.data[i]);
+        for (uint32_t i = 1; i < loader->stack.count; ++i) {
+            loader->stack.data[i]->child.reset();
+            loader->stack.data[i]->style->stroke.dash.array.reset();
+        }
+        loader->arena.rewind(start);
+        for (uint32_t i = 0; i < loader->images.count; ++i) {
+            loader->images.data[i]->dropped = true;
+            loader->images.data[i]->targets.clear();
+        }
+        loader->stack.clear();
+        loader->stack.push(doc);
+        doc->child.clear();
+        stream->scenes.reset();
+        stream->marks.reset();
+        return nullptr;
+    }
+
+    stream->scenes.reset();
+    stream->marks.reset();
+
+    if (svgGroupVisible(doc)) docNode->opacity(doc->style->opacity);
+    return svgRootBuild(move(docNode), vx, vy, vw, vh);
+}
+
+
+//Put the loaded images in the built scene. It waits for the image tasks,
+//so it's done by the scene() caller, not by the loading task.
+static void _resolveImages(SvgLoaderData* loader)
+{
+    for (uint32_t i = 0; i < loader->images.count; ++i) {
+        auto image = loader->images.data[i];
+        image->done();
+
+        if (!image->picture || image->targets.count == 0) continue;
+
+        float w, h;
+        image->picture->size(&w, &h);
+        if (w < FLT_EPSILON || h < FLT_EPSILON) continue;
+
+        //The missing dimensions follow the image size.
+        auto iw = image->w;
+        auto ih = image->h;
+        if (iw <= 0 && ih <= 0) {
+            iw = w;
+            ih = h;
+        } else if (iw <= 0) iw = w * ih / h;
+        else if (ih <= 0) ih = h * iw / w;
+
+        auto sx = iw / w;
+        auto sy = ih / h;
+        auto tx = image->x;
+        auto ty = image->y;
+        if (image->align != AspectRatioAlign::None) {
+            auto slice = (image->meetOrSlice == AspectRatioMeetOrSlice::Slice);
+            sx = sy = ((sx < sy) != slice) ? sx : sy;
+            //0, 0.5 or 1 of the space left, by the column and the row of the alignment
+            auto align = static_cast<int>(image->align) - 1;
+            tx += (iw - w * sx) * 0.5f * static_cast<float>(align % 3);
+            ty += (ih - h * sy) * 0.5f * static_cast<float>(align / 3);
+            //The sliced image overflows, it's clipped to its viewport.
+            if (slice) {
+                auto clip = Shape::gen();
+                clip->appendRect(image->x, image->y, iw, ih, 0, 0);
+                image->picture->composite(move(clip), CompositeMethod::ClipPath);
+            }
+        }
+        Matrix m = {sx, 0, tx, 0, sy, ty, 0, 0, 1};
+        image->picture->transform(m);
+
+        //The last instance takes the picture, the others share its loader.
+        for (uint32_t j = 0; j + 1 < image->targets.count; ++j) {
+            image->targets.data[j]->push(unique_ptr<Paint>(image->picture->duplicate()));
+        }
+        image->targets.data[image->targets.count - 1]->push(unique_ptr<Picture>(image->picture));
+        image->picture = nullptr;
+        image->targets.clear();
+    }
+}
+
+
+//Set while an image is opened, the svg documents opened in the meantime are images themselves.
+static thread_local bool _imageOpening = false;
+
+
+//Svg documents loaded as images don't load the files they refer to, as the browsers do.
+//They are loaded from the memory, so a cached document can't end up inside itself either.
+static Result _loadDocument(Picture* picture, const char* data, size_t size)
+{
+    auto opening = _imageOpening;
+    _imageOpening = true;
+    auto result = picture->load(data, static_cast<uint32_t>(size), true);
+    _imageOpening = opening;
+    return result;
+}
+
+
+/* The documents may come from anywhere, their images are read from the files in the document directory
+   and below only: the relative paths not going up beyond it. */
+static bool _localPath(const string& dir, const char* href, string& path)
+{
+    //Loaded from the memory, no directory to read from.
+    if (dir.empty()) return false;
+    //Absolute paths, drives and urls
+    if (href[0] == '/' || href[0] == '\\' || strchr(href, ':')) return false;
+
+    int depth = 0;
+    auto name = href;
+    while (true) {
+        auto end = name;
+        while (*end && *end != '/' && *end != '\\') ++end;
+        auto len = end - name;
+        if (len == 2 && name[0] == '.' && name[1] == '.') {
+            if (--depth < 0) return false;
+        } else if (len > 0 && !(len == 1 && name[0] == '.')) ++depth;
+        if (!*end) break;
+        name = end + 1;
+    }
+    if (depth == 0) return false;
+
+    path = dir + href;
+    return true;
+}
+
+
+void SvgImage::run(unsigned tid)
+{
+    if (dropped || *canceled) return;
+
+    auto picture = Picture::gen();
+
+    if (!strncmp(href, "data:", 5)) {
+        //The media type is not checked, the loaders know their formats.
+        auto payload = strchr(href, ',');
+        if (!payload) return;
+        char* data;
+        size_t size;
+        if (payload - href >= 7 && !strncmp(payload - 7, ";base64", 7)) size = svgUtilBase64Decode(payload + 1, strlen(payload + 1), &data);
+        else size = svgUtilURLDecode(payload + 1, strlen(payload + 1), &data);
+        if (size == 0) return;
+        auto result = _loadDocument(picture.get(), data, size);
+        free(data);
+        if (result != Result::Success) return;
+    } else {
+        if (nested) return;
+        string fullPath;
+        if (!_localPath(*dir, href, fullPath)) return;
+
+        FileMap file;
+        if (!file.open(fullPath)) return;
+        auto type = LoaderMgr::type(file.data, file.size);
+        //The images are shared through the loader cache, the documents are not.
+        if (type == FileType::Png || type == FileType::Jpg || type == FileType::Tvg) {
+            file.close();
+            if (picture->load(fullPath) != Result::Success) return;
+        } else if (_loadDocument(picture.get(), file.data, file.size) != Result::Success) return;
+    }
+
+    this->picture = picture.release();
+}
+
+
 void SvgLoader::clear()
 {
     if (copy) free((char*)content);
@@ -2596,6 +3145,8 @@ void SvgLoader::clear()
 
 SvgLoader::SvgLoader()
 {
+    loaderData.canceled = &canceled;
+    cancelable = true;
 }
 
 
@@ -2607,19 +3158,51 @@ SvgLoader::~SvgLoader()
 
 void SvgLoader::run(unsigned tid)
 {
-    if (!simpleXmlParse(content, size, true, _svgLoaderParser, &(loaderData))) return;
+    string cachePath;
+    uint64_t cacheKey = 0;
+    {
+        lock_guard<mutex> lock(_cacheMtx);
+        if (!_cacheDir.empty()) {
+            cacheKey = svgCacheKey(content, size);
+            char name[32];
+            snprintf(name, sizeof(name), "/%016llx.svgc", (unsigned long long)cacheKey);
+            cachePath = _cacheDir + name;
+        }
+    }
+
+    //The resolved document of the previous loads, it skips the xml parsing and the style updates.
+    if (!cachePath.empty()) {
+        if (svgCacheLoad(&loaderData, &cacheFile, cachePath, cacheKey, size)) {
+            root = svgSceneBuild(loaderData.doc, vx, vy, vw, vh);
+            notify(root != nullptr);
+            return;
+        }
+        cacheFile.close();
+    }
+
+    //Documents without references are built in a single pass, the others go through the node tree.
+    //The single pass doesn't keep the nodes, so it's skipped when they are cached.
+    if (cachePath.empty()) root = _streamBuild(&loaderData, content, size, vx, vy, vw, vh);
+
+    if (!root && simpleXmlParse(content, size, true, _svgLoaderParser, &(loaderData))) {
+        if (loaderData.doc) {
+            auto defs = loaderData.doc->node.doc.defs;
+            if (defs && loaderData.css.count > 0) _applyCssTree(&loaderData, defs);
+            _updateStyle(&loaderData, loaderData.doc, nullptr);
+            if (defs) _updateGradient(&loaderData, loaderData.doc, &defs->node.defs.gradients);
 
-    if (loaderData.doc) {
-        _updateStyle(loaderData.doc, nullptr);
-        auto defs = loaderData.doc->node.doc.defs;
-        if (defs) _updateGradient(loaderData.doc, &defs->node.defs.gradients);
+            if (loaderData.gradients.count > 0) _updateGradient(&loaderData, loaderData.doc, &loaderData.gradients);
 
-        if (loaderData.gradients.count > 0) _updateGradient(loaderData.doc, &loaderData.gradients);
+            _updateComposite(&loaderData, loaderData.doc, loaderData.doc);
+            if (defs) _updateComposite(&loaderData, loaderData.doc, defs);
 
-        _updateComposite(loaderData.doc, loaderData.doc);
-        if (defs) _updateComposite(loaderData.doc, defs);
+            //Before the scene building, it updates the gradients in place.
+            if (!cachePath.empty()) svgCacheSave(&loaderData, cachePath, cacheKey, size);
+        }
+        root = svgSceneBuild(loaderData.doc, vx, vy, vw, vh);
     }
-    root = svgSceneBuild(loaderData.doc, vx, vy, vw, vh);
+
+    notify(root != nullptr);
 };
 
 
@@ -2631,6 +3214,8 @@ bool SvgLoader::header()
     loaderData.svgParse = (SvgParser*)malloc(sizeof(SvgParser));
     if (!loaderData.svgParse) return false;
 
+    loaderData.nested = _imageOpening;
+
     simpleXmlParse(content, size, true, _svgLoaderParserForValidCheck, &(loaderData));
 
     if (loaderData.doc && loaderData.doc->type == SvgNodeType::Doc) {
@@ -2664,10 +3249,13 @@ bool SvgLoader::open(const char* data, uint32_t size, bool copy)
 {
     clear();
 
+    //The parsers rely on the string functions, the copy is terminated.
     if (copy) {
-        content = (char*)malloc(size);
-        if (!content) return false;
-        memcpy((char*)content, data, size);
+        auto buffer = (char*)malloc(size + 1);
+        if (!buffer) return false;
+        memcpy(buffer, data, size);
+        buffer[size] = '\0';
+        content = buffer;
     } else content = data;
 
     this->size = size;
@@ -2681,18 +3269,15 @@ bool SvgLoader::open(const string& path)
 {
     clear();
 
-    ifstream f;
-    f.open(path);
-
-    if (!f.is_open()) return false;
-
-    getline(f, filePath, '\0');
-    f.close();
+    //The mapping is kept until the loader is destroyed.
+    if (!file.open(path, true)) return false;
 
-    if (filePath.empty()) return false;
+    //The relative paths of the images are resolved against it.
+    auto sep = path.find_last_of("/\\");
+    loaderData.dir = (sep == string::npos) ? string("./") : path.substr(0, sep + 1);
 
-    content = filePath.c_str();
-    size = filePath.size();
+    content = file.data;
+    size = file.size;
 
     return header();
 }
@@ -2723,9 +3308,24 @@ bool SvgLoader::close()
     }
     loaderData.gradients.reset();
 
+    for (uint32_t i = 0; i < loaderData.images.count; ++i) {
+        loaderData.images.data[i]->dropped = true;
+    }
+    for (uint32_t i = 0; i < loaderData.images.count; ++i) {
+        loaderData.images.data[i]->done();
+        delete(loaderData.images.data[i]);
+    }
+    loaderData.images.reset();
+
     _freeNode(loaderData.doc);
     loaderData.doc = nullptr;
     loaderData.stack.reset();
+    loaderData.nodes.reset();
+    loaderData.gradientIds.reset();
+    loaderData.css.reset();
+    loaderData.openStyle = false;
+    cacheFile.close();
+    loaderData.arena.clear();
 
     clear();
 
@@ -2736,6 +3336,14 @@ bool SvgLoader::close()
 unique_ptr<Scene> SvgLoader::scene()
 {
     this->done();
-    if (root) return move(root);
-    else return nullptr;
+    if (!root) return nullptr;
+    _resolveImages(&loaderData);
+    return move(root);
+}
+
+
+void SvgLoader::cacheDir(const string& dir)
+{
+    lock_guard<mutex> lock(_cacheMtx);
+    _cacheDir = dir;
 }
@@ -23,12 +23,14 @@
 #define _TVG_SVG_LOADER_H_
 
 #include "tvgTaskScheduler.h"
+#include "tvgLoaderMgr.h"
 #include "tvgSvgLoaderCommon.h"
 
 class SvgLoader : public Loader, public Task
 {
 public:
-    string filePath;
+    FileMap file;
+    FileMap cacheFile;          //keeps the strings and the points of a cached document
     const char* content = nullptr;
     uint32_t size = 0;
 
@@ -51,6 +53,9 @@ public:
 
     unique_ptr<Scene> scene() override;
 
+    //Directory of the resolved documents, reused by the next loads of the same source. Empty disables it.
+    static void cacheDir(const string& dir);
+
 private:
     void clear();
 };
@@ -22,8 +22,10 @@
 #ifndef _TVG_SVG_LOADER_COMMON_H_
 #define _TVG_SVG_LOADER_COMMON_H_
 
+#include <atomic>
 #include "tvgCommon.h"
 #include "tvgArray.h"
+#include "tvgTaskScheduler.h"
 
 enum class SvgNodeType
 {
@@ -83,6 +85,7 @@ enum class SvgStrokeFlags
     Cap = 0x20,
     Join = 0x40,
     Dash = 0x80,
+    DashOffset = 0x100,
 };
 
 enum class SvgGradientType
@@ -111,6 +114,27 @@ enum class SvgFillRule
     OddEven = 1
 };
 
+//preserveAspectRatio: the x alignments in a row of the min, mid and max y ones
+enum class AspectRatioAlign
+{
+    None,
+    XMinYMin,
+    XMidYMin,
+    XMaxYMin,
+    XMinYMid,
+    XMidYMid,
+    XMaxYMid,
+    XMinYMax,
+    XMidYMax,
+    XMaxYMax
+};
+
+enum class AspectRatioMeetOrSlice
+{
+    Meet,
+    Slice
+};
+
 //Length type to recalculate %, pt, pc, mm, cm etc
 enum class SvgParserLengthType
 {
@@ -122,6 +146,7 @@ enum class SvgParserLengthType
 
 struct SvgNode;
 struct SvgStyleGradient;
+struct SvgImage;
 
 
 struct SvgDocNode
@@ -186,7 +211,7 @@ struct SvgLineNode
 
 struct SvgPathNode
 {
-    string* path;
+    char* path;
 };
 
 struct SvgPolygonNode
@@ -195,6 +220,11 @@ struct SvgPolygonNode
     float* points;
 };
 
+struct SvgImageNode
+{
+    SvgImage* image;
+};
+
 struct SvgLinearGradient
 {
     float x1;
@@ -224,14 +254,14 @@ struct SvgGradientStop
 struct SvgComposite
 {
     CompositeMethod method;     //TODO: Currently support either one method
-    string *url;
+    char *url;
     SvgNode* node;
 };
 
 struct SvgPaint
 {
     SvgStyleGradient* gradient;
-    string *url;
+    char *url;
     uint8_t r;
     uint8_t g;
     uint8_t b;
@@ -242,13 +272,14 @@ struct SvgPaint
 struct SvgDash
 {
     Array<float> array;
+    float offset;
 };
 
 struct SvgStyleGradient
 {
     SvgGradientType type;
-    string *id;
-    string *ref;
+    char *id;
+    char *ref;
     FillSpread spread;
     SvgRadialGradient* radial;
     SvgLinearGradient* linear;
@@ -296,7 +327,9 @@ struct SvgNode
     SvgNodeType type;
     SvgNode* parent;
     Array<SvgNode*> child;
-    string *id;
+    char *id;
+    char *cls;                  //class attribute, for the <style> rules
+    char *inlineStyle;          //style attribute, applied again over the <style> rules
     SvgStyleProperty *style;
     Matrix* transform;
     union {
@@ -311,6 +344,7 @@ struct SvgNode
         SvgRectNode rect;
         SvgPathNode path;
         SvgLineNode line;
+        SvgImageNode image;
     } node;
     bool display;
 };
@@ -332,6 +366,271 @@ struct SvgParser
     } gradient;
 };
 
+//Bump allocator for the svg document: nodes, styles, gradients, ids and attribute strings.
+//Nothing is released individually, clear() frees all the blocks at once and rewind() drops
+//everything allocated after the given mark.
+struct SvgArena
+{
+    static constexpr size_t BLOCK_SIZE = 65536;
+    static constexpr size_t ALIGN = 8;
+
+    struct Block
+    {
+        Block* next;
+        size_t size;
+        size_t used;
+    };
+
+    struct Mark
+    {
+        Block* head;
+        Block* big;
+        size_t used;
+    };
+
+    Block* head = nullptr;
+    Block* big = nullptr;       //dedicated blocks of the big chunks
+
+    void* alloc(size_t size)
+    {
+        size = (size + ALIGN - 1) & ~(ALIGN - 1);
+
+        //Big chunks get a dedicated block so that the current one keeps serving small requests.
+        if (size > BLOCK_SIZE / 4) {
+            auto block = static_cast<Block*>(malloc(HEADER + size));
+            if (!block) return nullptr;
+            block->size = block->used = size;
+            block->next = big;
+            big = block;
+            return memset(reinterpret_cast<char*>(block) + HEADER, 0, size);
+        }
+
+        if (!head || head->used + size > head->size) {
+            auto block = static_cast<Block*>(malloc(HEADER + BLOCK_SIZE));
+            if (!block) return nullptr;
+            block->size = BLOCK_SIZE;
+            block->used = 0;
+            block->next = head;
+            head = block;
+        }
+        auto ptr = reinterpret_cast<char*>(head) + HEADER + head->used;
+        head->used += size;
+        return memset(ptr, 0, size);
+    }
+
+    char* strdup(const char* str, size_t len)
+    {
+        auto ret = static_cast<char*>(alloc(len + 1));
+        if (!ret) return nullptr;
+        memcpy(ret, str, len);
+        return ret;
+    }
+
+    char* strdup(const char* str)
+    {
+        return strdup(str, strlen(str));
+    }
+
+    Mark mark() const
+    {
+        return {head, big, head ? head->used : 0};
+    }
+
+    void rewind(const Mark& mark)
+    {
+        _release(head, mark.head);
+        _release(big, mark.big);
+        if (head) head->used = mark.used;
+    }
+
+    void clear()
+    {
+        _release(head, nullptr);
+        _release(big, nullptr);
+    }
+
+    ~SvgArena()
+    {
+        clear();
+    }
+
+private:
+    static constexpr size_t HEADER = (sizeof(Block) + ALIGN - 1) & ~(ALIGN - 1);
+
+    static void _release(Block*& list, Block* until)
+    {
+        while (list && list != until) {
+            auto next = list->next;
+            free(list);
+            list = next;
+        }
+    }
+};
+
+//Open addressing id index for the reference resolution (<use>, url(#id), gradient href).
+//Each element is registered with its owner (the tree root for nodes, the list for gradients).
+//Elements with a duplicated id are probed in the insertion order, so the first one
+//of the given owner wins as the document order search does.
+struct SvgIdIndex
+{
+    struct Entry
+    {
+        const char* id;
+        void* value;
+        const void* owner;
+        uint32_t hash;
+    };
+
+    Array<Entry> entries;           //in the insertion order
+    uint32_t* slots = nullptr;      //entry index + 1, 0 for an empty slot
+    uint32_t reserved = 0;
+
+    bool push(const char* id, void* value, const void* owner)
+    {
+        if (!id || !value) return false;
+        if ((entries.count + 1) * 2 > reserved && !grow()) return false;
+
+        entries.push({id, value, owner, _hash(id, strlen(id))});
+        insert(entries.count - 1);
+        return true;
+    }
+
+    void* find(const char* id, const void* owner) const
+    {
+        if (!id) return nullptr;
+        return find(id, strlen(id), owner);
+    }
+
+    //The id is not null terminated
+    void* find(const char* id, size_t len, const void* owner) const
+    {
+        if (!id || entries.count == 0) return nullptr;
+
+        auto hash = _hash(id, len);
+        auto mask = reserved - 1;
+        for (auto i = hash & mask; slots[i]; i = (i + 1) & mask) {
+            auto entry = &entries.data[slots[i] - 1];
+            if (entry->hash == hash && entry->owner == owner && !strncmp(entry->id, id, len) && entry->id[len] == '\0') return entry->value;
+        }
+        return nullptr;
+    }
+
+    void reset()
+    {
+        entries.reset();
+        free(slots);
+        slots = nullptr;
+        reserved = 0;
+    }
+
+    ~SvgIdIndex()
+    {
+        free(slots);
+    }
+
+private:
+    static uint32_t _hash(const char* str, size_t len)
+    {
+        //FNV-1a
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < len; ++i) {
+            hash ^= static_cast<uint8_t>(str[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void insert(uint32_t idx)
+    {
+        auto mask = reserved - 1;
+        auto i = entries.data[idx].hash & mask;
+        while (slots[i]) i = (i + 1) & mask;
+        slots[i] = idx + 1;
+    }
+
+    bool grow()
+    {
+        auto newReserved = reserved ? reserved * 2 : 64;
+        auto newSlots = static_cast<uint32_t*>(calloc(newReserved, sizeof(uint32_t)));
+        if (!newSlots) return false;
+
+        free(slots);
+        slots = newSlots;
+        reserved = newReserved;
+
+        //Rehash in the insertion order to keep the duplicated ids in order.
+        for (uint32_t i = 0; i < entries.count; ++i) insert(i);
+        return true;
+    }
+};
+
+//Compiled selector of a <style> rule, chained with the others of the same key.
+struct SvgCssSelector
+{
+    const char* id;             //nullptr if not given
+    const char* classes;        //space separated, nullptr if not given
+    const char* decls;          //declaration block, parsed as an inline style
+    SvgCssSelector* next;
+    SvgNodeType type;           //Unknown for any element
+    uint32_t specificity;
+    uint32_t order;
+};
+
+//<style> rules indexed by the selector keys: the id, the first class or the element type.
+//An element looks up its id, its classes and its type only, not all the rules.
+struct SvgCss
+{
+    SvgIdIndex ids;
+    SvgIdIndex classes;
+    SvgCssSelector* types[static_cast<int>(SvgNodeType::Unknown) + 1] = {};    //Unknown for the universal selector
+    Array<SvgCssSelector*> matched;     //selectors of the last matched element in the cascade order
+    uint32_t count = 0;
+
+    void reset()
+    {
+        ids.reset();
+        classes.reset();
+        memset(types, 0, sizeof(types));
+        matched.reset();
+        count = 0;
+    }
+};
+
+//Embedded image, loaded by a task in parallel with the parsing.
+//The pictures are put in the built scene once the loading is done.
+struct SvgImage : Task
+{
+    char* href = nullptr;           //data uri or file path
+    const string* dir = nullptr;    //base of the relative paths, empty if the document has no file
+    const atomic<bool>* canceled = nullptr;
+    bool nested = false;            //in a document loaded as an image, the files are not loaded
+    Picture* picture = nullptr;
+    Array<Scene*> targets;          //instances in the built scene
+    float x = 0, y = 0, w = 0, h = 0;
+    AspectRatioAlign align = AspectRatioAlign::XMidYMid;
+    AspectRatioMeetOrSlice meetOrSlice = AspectRatioMeetOrSlice::Meet;
+    atomic<bool> dropped{false};    //no more used, skip the loading
+
+    ~SvgImage()
+    {
+        free(href);
+        delete(picture);
+    }
+
+    void run(unsigned tid) override;
+};
+
+//Single pass building state: the documents without references are turned into paints
+//while parsing, without keeping the node tree.
+struct SvgStream
+{
+    Array<Scene*> scenes;               //paints of the open groups, parallel to the node stack
+    Array<SvgArena::Mark> marks;        //arena position before each open group
+    Scene* root = nullptr;              //the doc scene once its entry is popped
+    float vx, vy, vw, vh;
+    bool failed = false;                //a reference is found, the document needs the tree
+};
+
 struct SvgLoaderData
 {
     Array<SvgNode *> stack = {nullptr, 0, 0};
@@ -340,8 +639,18 @@ struct SvgLoaderData
     Array<SvgStyleGradient*> gradients;
     SvgStyleGradient* latestGradient = nullptr; //For stops
     SvgParser* svgParse = nullptr;
+    SvgArena arena;
+    SvgIdIndex nodes;               //id -> SvgNode
+    SvgIdIndex gradientIds;         //id -> SvgStyleGradient
+    SvgStream stream;
+    Array<SvgImage*> images;
+    SvgCss css;
+    string dir;                     //directory of the svg file
+    const atomic<bool>* canceled = nullptr;
+    bool nested = false;            //loaded as an image of another document
     int level = 0;
     bool result = false;
+    bool openStyle = false;         //inside a <style> element
 };
 
 /*
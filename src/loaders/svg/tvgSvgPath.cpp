@@ -23,7 +23,6 @@
 #define _USE_MATH_DEFINES       //Math Constants are not defined in Standard C/C++.
 
 #include <math.h>
-#include <clocale>
 #include <ctype.h>
 #include "tvgSvgLoaderCommon.h"
 #include "tvgSvgPath.h"
@@ -498,6 +497,26 @@ static char* _nextCommand(char* path, char* cmd, float* arr, int* count)
 }
 
 
+//Parse the implicit repetition of a lineto ("L 1 2 3 4 ...") straight into the point array
+static char* _lineToRun(char* path, Array<PathCommand>* cmds, Array<Point>* pts, bool relative, Point* cur)
+{
+    Point p;
+    while (!isalpha(*path)) {
+        auto next = path;
+        if (!_parseNumber(&next, &p.x) || !_parseNumber(&next, &p.y)) break;
+        if (relative) {
+            p.x += cur->x;
+            p.y += cur->y;
+        }
+        cmds->push(PathCommand::LineTo);
+        pts->push(p);
+        *cur = p;
+        path = _skipComma(next);
+    }
+    return path;
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -513,20 +532,29 @@ bool svgPathToTvgPath(const char* svgPath, Array<PathCommand>& cmds, Array<Point
     char cmd = 0;
     bool isQuadratic = false;
     char* path = (char*)svgPath;
-    char* curLocale;
-
-    curLocale = setlocale(LC_NUMERIC, NULL);
-    if (curLocale) curLocale = strdup(curLocale);
-    setlocale(LC_NUMERIC, "POSIX");
 
+    //The number parsing is locale independent, no need to switch LC_NUMERIC here.
     while ((path[0] != '\0')) {
         path = _nextCommand(path, &cmd, numberArray, &numberCount);
         if (!path) break;
         _processCommand(&cmds, &pts, cmd, numberArray, numberCount, &cur, &curCtl, &startPoint, &isQuadratic);
-    }
 
-    setlocale(LC_NUMERIC, curLocale);
-    if (curLocale) free(curLocale);
+        switch (cmd) {
+            case 'M':
+            case 'L': {
+                path = _lineToRun(path, &cmds, &pts, false, &cur);
+                break;
+            }
+            case 'm':
+            case 'l': {
+                path = _lineToRun(path, &cmds, &pts, true, &cur);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
 
     return true;
 }
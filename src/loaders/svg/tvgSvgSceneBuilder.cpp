@@ -238,7 +238,7 @@ static void _applyProperty(SvgNode* node, Shape* vg, float vx, float vy, float v
     vg->stroke(style->stroke.cap);
     vg->stroke(style->stroke.join);
     if (style->stroke.dash.array.count > 0) {
-        vg->stroke(style->stroke.dash.array.data, style->stroke.dash.array.count);
+        vg->stroke(style->stroke.dash.array.data, style->stroke.dash.array.count, style->stroke.dash.offset);
     }
 
     //If stroke property is nullptr then do nothing
@@ -284,7 +284,7 @@ static bool _appendShape(SvgNode* node, Shape* shape, float vx, float vy, float
     switch (node->type) {
         case SvgNodeType::Path: {
             if (node->node.path.path) {
-                if (svgPathToTvgPath(node->node.path.path->c_str(), cmds, pts)) {
+                if (svgPathToTvgPath(node->node.path.path, cmds, pts)) {
                     shape->appendPath(cmds.data, cmds.count, pts.data, pts.count);
                 }
             }
@@ -334,17 +334,34 @@ static bool _appendShape(SvgNode* node, Shape* shape, float vx, float vy, float
 }
 
 
+//The image is put in the scene once it's loaded, see SvgImage.
+static unique_ptr<Scene> _imageBuildHelper(SvgNode* node, float vx, float vy, float vw, float vh)
+{
+    auto image = node->node.image.image;
+    if (!image || !image->href || !svgGroupVisible(node)) return nullptr;
+
+    auto scene = svgGroupBuild(node);
+    if (node->style->opacity < 255) scene->opacity(node->style->opacity);
+    _applyComposition(scene.get(), node, vx, vy, vw, vh);
+    image->targets.push(scene.get());
+
+    return scene;
+}
+
+
 static unique_ptr<Scene> _sceneBuildHelper(const SvgNode* node, float vx, float vy, float vw, float vh)
 {
     if (_isGroupType(node->type)) {
-        auto scene = Scene::gen();
-        if (node->transform) scene->transform(*node->transform);
+        auto scene = svgGroupBuild(node);
 
-        if (node->display && node->style->opacity != 0) {
+        if (svgGroupVisible(node)) {
             auto child = node->child.data;
             for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
                 if (_isGroupType((*child)->type)) {
                     scene->push(_sceneBuildHelper(*child, vx, vy, vw, vh));
+                } else if ((*child)->type == SvgNodeType::Image) {
+                    auto image = _imageBuildHelper(*child, vx, vy, vw, vh);
+                    if (image) scene->push(move(image));
                 } else {
                     auto shape = _shapeBuildHelper(*child, vx, vy, vw, vh);
                     if (shape) scene->push(move(shape));
@@ -367,8 +384,38 @@ unique_ptr<Scene> svgSceneBuild(SvgNode* node, float vx, float vy, float vw, flo
 {
     if (!node || (node->type != SvgNodeType::Doc)) return nullptr;
 
-    auto docNode = _sceneBuildHelper(node, vx, vy, vw, vh);
+    return svgRootBuild(_sceneBuildHelper(node, vx, vy, vw, vh), vx, vy, vw, vh);
+}
 
+
+unique_ptr<Shape> svgShapeBuild(SvgNode* node, float vx, float vy, float vw, float vh)
+{
+    return _shapeBuildHelper(node, vx, vy, vw, vh);
+}
+
+
+unique_ptr<Scene> svgImageBuild(SvgNode* node, float vx, float vy, float vw, float vh)
+{
+    return _imageBuildHelper(node, vx, vy, vw, vh);
+}
+
+
+unique_ptr<Scene> svgGroupBuild(const SvgNode* node)
+{
+    auto scene = Scene::gen();
+    if (node->transform) scene->transform(*node->transform);
+    return scene;
+}
+
+
+bool svgGroupVisible(const SvgNode* node)
+{
+    return node->display && node->style->opacity != 0;
+}
+
+
+unique_ptr<Scene> svgRootBuild(unique_ptr<Scene> docNode, float vx, float vy, float vw, float vh)
+{
     auto viewBoxClip = Shape::gen();
     viewBoxClip->appendRect(vx, vy ,vw, vh, 0, 0);
     viewBoxClip->fill(0, 0, 0, 255);
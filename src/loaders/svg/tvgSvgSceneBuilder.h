@@ -27,4 +27,11 @@
 
 unique_ptr<Scene> svgSceneBuild(SvgNode* node, float vx, float vy, float vw, float vh);
 
+//Single pass building: the loader hands over the nodes while parsing
+unique_ptr<Shape> svgShapeBuild(SvgNode* node, float vx, float vy, float vw, float vh);
+unique_ptr<Scene> svgImageBuild(SvgNode* node, float vx, float vy, float vw, float vh);
+unique_ptr<Scene> svgGroupBuild(const SvgNode* node);
+bool svgGroupVisible(const SvgNode* node);
+unique_ptr<Scene> svgRootBuild(unique_ptr<Scene> docNode, float vx, float vy, float vw, float vh);
+
 #endif //_TVG_SVG_SCENE_BUILDER_H_
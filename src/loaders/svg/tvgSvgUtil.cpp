@@ -22,8 +22,9 @@
 
 #include <math.h>
 #include <memory.h>
-#include <ctype.h>
-#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <locale.h>
 #include "tvgSvgUtil.h"
 
 
@@ -31,9 +32,124 @@
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
-static inline bool _floatExact(float a, float b)
+//Significant digits fitting in the 64 bits mantissa
+#define MAX_DIGITS 19
+
+static constexpr float pow10f[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+static constexpr double pow10d[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+
+static inline bool _isDigit(char c)
+{
+    return static_cast<unsigned>(c - '0') < 10;
+}
+
+
+static inline bool _isSpace(char c)
+{
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+
+static inline char _toLower(char c)
+{
+    return c | 0x20;
+}
+
+
+//6 bits value of the base64 characters, 64 for the padding and 0xff for the others
+static constexpr struct Base64Table
+{
+    uint8_t value[256];
+
+    constexpr Base64Table() : value()
+    {
+        for (int i = 0; i < 256; ++i) value[i] = 0xff;
+        for (int i = 0; i < 26; ++i) {
+            value['A' + i] = i;
+            value['a' + i] = 26 + i;
+        }
+        for (int i = 0; i < 10; ++i) value['0' + i] = 52 + i;
+        value['+'] = value['-'] = 62;
+        value['/'] = value['_'] = 63;
+        value['='] = 64;
+    }
+} _base64;
+
+
+static inline int _hexToInt(char c)
 {
-    return memcmp(&a, &b, sizeof (float)) == 0;
+    if (_isDigit(c)) return c - '0';
+    c = _toLower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+
+static bool _matchWord(const char* str, const char* word)
+{
+    for (; *word; ++str, ++word) {
+        if (_toLower(*str) != *word) return false;
+    }
+    return true;
+}
+
+
+//The double lands on the half way of two floats
+static bool _floatTie(double val)
+{
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    return (bits & 0x1fffffffULL) == 0x10000000ULL;
+}
+
+
+//Clinger's fast path: the mantissa and the power of ten are exact, so a single operation rounds correctly.
+static bool _fastPath(uint64_t mantissa, int exponent, float& val)
+{
+    if (mantissa <= (1ULL << 24) && exponent >= -10 && exponent <= 10) {
+        val = (exponent < 0) ? (float(mantissa) / pow10f[-exponent]) : (float(mantissa) * pow10f[exponent]);
+        return true;
+    }
+    if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+        auto dval = (exponent < 0) ? (double(mantissa) / pow10d[-exponent]) : (double(mantissa) * pow10d[exponent]);
+        //Rounding the double again to float could go wrong on a tie
+        if (_floatTie(dval)) return false;
+        val = float(dval);
+        return true;
+    }
+    return false;
+}
+
+
+//Rare long or extreme literals: hand over to the C library with the decimal point of the current locale.
+static float _slowStrtof(const char* str, const char* end)
+{
+    const char* point = localeconv()->decimal_point;
+    auto pointLen = point ? strlen(point) : 0;
+    if (pointLen == 0) {
+        point = ".";
+        pointLen = 1;
+    }
+
+    char buf[128];
+    auto size = (end - str) + pointLen;
+    auto tmp = (size < sizeof(buf)) ? buf : static_cast<char*>(malloc(size));
+    if (!tmp) return 0.0f;
+
+    auto dst = tmp;
+    for (; str < end; ++str) {
+        if (*str == '.') {
+            memcpy(dst, point, pointLen);
+            dst += pointLen;
+        } else *dst++ = *str;
+    }
+    *dst = '\0';
+
+    auto val = strtof(tmp, nullptr);
+    if (tmp != buf) free(tmp);
+    return val;
 }
 
 
@@ -53,186 +169,188 @@ static inline bool _floatExact(float a, float b)
  *
  * No hexadecimal form supported
  * no sequence supported after NAN
+ *
+ * The radix is always '.' regardless of the locale and the result is correctly rounded.
  */
 float svgUtilStrtof(const char *nPtr, char **endPtr)
 {
-    const char *iter;
-    const char *a;
-    float val;
-    unsigned long long integerPart;
-    int minus;
-
     if (endPtr) *endPtr = (char*)nPtr;
     if (!nPtr) return 0.0f;
 
-    a = iter = nPtr;
+    auto iter = nPtr;
 
     //ignore leading whitespaces
-    while (isspace(*iter)) iter++;
+    while (_isSpace(*iter)) iter++;
+
+    auto number = iter;
 
     //signed or not
-    minus = 1;
-    if (*iter == '-')
-    {
-        minus = -1;
+    auto minus = false;
+    if (*iter == '-') {
+        minus = true;
         iter++;
-    }
-    else if (*iter == '+') iter++;
-
-    if (tolower(*iter) == 'i')
-    {
-        if ((tolower(*(iter + 1)) == 'n') && (tolower(*(iter + 2)) == 'f'))
-        {
-            iter += 3;
-        }
-        else goto on_error;
-
-        if (tolower(*(iter + 3)) == 'i')
-        {
-            if ((tolower(*(iter + 4)) == 'n') &&
-                (tolower(*(iter + 5)) == 'i') &&
-                (tolower(*(iter + 6)) == 't') &&
-                (tolower(*(iter + 7)) == 'y'))
-            {
-               iter += 5;
-            }
-            else goto on_error;
-         }
-         if (endPtr) *endPtr = (char *)iter;
-         return (minus == -1) ? -INFINITY : INFINITY;
+    } else if (*iter == '+') iter++;
+
+    if (_toLower(*iter) == 'i') {
+        if (!_matchWord(iter, "inf")) return 0.0f;
+        iter += 3;
+        if (_matchWord(iter, "inity")) iter += 5;
+        if (endPtr) *endPtr = (char*)iter;
+        return minus ? -INFINITY : INFINITY;
     }
 
-    if (tolower(*iter) == 'n')
-    {
-         if ((tolower(*(iter + 1)) == 'a') && (tolower(*(iter + 2)) == 'n')) iter += 3;
-         else goto on_error;
-
-         if (endPtr) *endPtr = (char *)iter;
-         return (minus == -1) ? -NAN : NAN;
+    if (_toLower(*iter) == 'n') {
+        if (!_matchWord(iter, "nan")) return 0.0f;
+        if (endPtr) *endPtr = (char*)(iter + 3);
+        return minus ? -NAN : NAN;
     }
 
-    integerPart = 0;
+    uint64_t mantissa = 0;
+    auto digits = 0;        //significant digits in the mantissa
+    auto exponent = 0;      //decimal exponent of the mantissa
+    auto truncated = false; //non zero digits dropped beyond MAX_DIGITS
 
     //(optional) integer part before dot
-    if (isdigit(*iter))
-    {
-        for (; isdigit(*iter); iter++) integerPart = integerPart * 10ULL + (unsigned long long)(*iter - '0');
-
-        a = iter;
-    }
-    else if (*iter != '.')
-    {
-        val = 0.0;
-        goto on_success;
+    auto begin = iter;
+    for (; _isDigit(*iter); iter++) {
+        if (digits < MAX_DIGITS) {
+            mantissa = mantissa * 10 + (*iter - '0');
+            if (mantissa > 0) ++digits;
+        } else {
+            ++exponent;
+            if (*iter != '0') truncated = true;
+        }
     }
-
-    val = (float)integerPart;
+    auto count = iter - begin;
 
     //(optional) decimal part after dot
-    if (*iter == '.')
-    {
-        unsigned long long decimalPart;
-        unsigned long long pow10;
-        int count;
-
-        iter++;
+    if (*iter == '.') {
+        begin = ++iter;
+        for (; _isDigit(*iter); iter++) {
+            if (digits < MAX_DIGITS) {
+                mantissa = mantissa * 10 + (*iter - '0');
+                if (mantissa > 0) ++digits;
+                --exponent;
+            } else if (*iter != '0') truncated = true;
+        }
+        count += iter - begin;
+    }
 
-        decimalPart = 0;
-        count = 0;
-        pow10 = 1;
-
-        if (isdigit(*iter))
-        {
-            for (; isdigit(*iter); iter++, count++)
-            {
-                if (count < 19)
-                {
-                    decimalPart = decimalPart * 10ULL +  + (unsigned long long)(*iter - '0');
-                    pow10 *= 10ULL;
-                }
+    //No digits at all, it's not a number
+    if (count == 0) return 0.0f;
+
+    //(optional) exponent, taken only when digits follow
+    if ((*iter == 'e') || (*iter == 'E')) {
+        auto p = iter + 1;
+        auto minusE = false;
+        if (*p == '-') {
+            minusE = true;
+            p++;
+        } else if (*p == '+') p++;
+
+        if (_isDigit(*p)) {
+            auto expo = 0;
+            for (; _isDigit(*p); p++) {
+                if (expo < 100000) expo = expo * 10 + (*p - '0');
             }
+            exponent += minusE ? -expo : expo;
+            iter = p;
         }
-        val += (float)decimalPart / (float)pow10;
-        a = iter;
     }
 
-    //(optional) exponent
-    if ((*iter == 'e') || (*iter == 'E'))
-    {
-        float scale = 1.0f;
-        unsigned int expo_part;
-        int minus_e;
+    if (endPtr) *endPtr = (char*)iter;
 
-        iter++;
+    auto val = 0.0f;
+    if (mantissa > 0 && (truncated || !_fastPath(mantissa, exponent, val))) return _slowStrtof(number, iter);
 
-        //signed or not
-        minus_e = 1;
-        if (*iter == '-')
-        {
-            minus_e = -1;
-            iter++;
-        }
-        else if (*iter == '+') iter++;
+    return minus ? -val : val;
+}
 
-        //exponential part
-        expo_part = 0;
-        if (isdigit(*iter))
-        {
-            while (*iter == 0) iter++;
 
-            for (; isdigit(*iter); iter++)
-            {
-                expo_part = expo_part * 10U + (unsigned int)(*iter - '0');
+size_t svgUtilBase64Decode(const char* src, size_t len, char** out)
+{
+    *out = nullptr;
+    if (!src || len == 0) return 0;
+
+    auto dst = static_cast<uint8_t*>(malloc((len / 4 + 1) * 3));
+    if (!dst) return 0;
+
+    auto in = reinterpret_cast<const uint8_t*>(src);
+    auto end = in + len;
+    size_t size = 0;
+    uint32_t acc = 0;
+    auto n = 0;
+
+    while (in < end) {
+        //Fast path: 4 characters without white spaces and paddings
+        if (n == 0) {
+            while (end - in >= 4) {
+                auto a = _base64.value[in[0]];
+                auto b = _base64.value[in[1]];
+                auto c = _base64.value[in[2]];
+                auto d = _base64.value[in[3]];
+                if ((a | b | c | d) & 0xc0) break;
+                auto v = (a << 18) | (b << 12) | (c << 6) | d;
+                dst[size++] = v >> 16;
+                dst[size++] = v >> 8;
+                dst[size++] = v;
+                in += 4;
             }
+            if (in == end) break;
         }
-        else if (!isdigit(*(a - 1)))
-        {
-            a = nPtr;
-            goto on_success;
-        }
-        else if (*iter == 0) goto on_success;
-
-        if ((_floatExact(val, 2.2250738585072011)) && ((minus_e * (int)expo_part) == -308))
-        {
-            val *= 1.0e-308;
-            a = iter;
-            errno = ERANGE;
-            goto on_success;
+        auto v = _base64.value[*in++];
+        if (v == 64) break;
+        if (v == 0xff) {
+            if (_isSpace(in[-1])) continue;
+            break;
         }
-
-        if ((_floatExact(val, 2.2250738585072012)) && ((minus_e * (int)expo_part) <= -308))
-        {
-            val *= 1.0e-308;
-            a = iter;
-            goto on_success;
-        }
-
-        a = iter;
-
-        while (expo_part >= 8U)
-        {
-            scale *= 1E8;
-            expo_part -= 8U;
-        }
-        while (expo_part > 0U)
-        {
-            scale *= 10.0f;
-            expo_part--;
+        acc = (acc << 6) | v;
+        if (++n == 4) {
+            dst[size++] = acc >> 16;
+            dst[size++] = acc >> 8;
+            dst[size++] = acc;
+            acc = 0;
+            n = 0;
         }
+    }
 
-        val = (minus_e == -1) ? (val / scale) : (val * scale);
+    //Trailing bits of the padded end
+    if (n == 2) dst[size++] = acc >> 4;
+    else if (n == 3) {
+        dst[size++] = acc >> 10;
+        dst[size++] = acc >> 2;
     }
-    else if ((iter > nPtr) && !isdigit(*(iter - 1)))
-    {
-        a = nPtr;
-        goto on_success;
+
+    if (size == 0) {
+        free(dst);
+        return 0;
     }
+    *out = reinterpret_cast<char*>(dst);
+    return size;
+}
 
-on_success:
-    if (endPtr) *endPtr = (char *)a;
-    return minus * val;
 
-on_error:
-    if (endPtr) *endPtr = (char *)nPtr;
-    return 0.0f;
+size_t svgUtilURLDecode(const char* src, size_t len, char** out)
+{
+    *out = nullptr;
+    if (!src || len == 0) return 0;
+
+    auto dst = static_cast<char*>(malloc(len));
+    if (!dst) return 0;
+
+    size_t size = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (src[i] == '%' && i + 2 < len) {
+            auto hi = _hexToInt(src[i + 1]);
+            auto lo = _hexToInt(src[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                dst[size++] = static_cast<char>((hi << 4) | lo);
+                i += 2;
+                continue;
+            }
+        }
+        dst[size++] = src[i];
+    }
+    *out = dst;
+    return size;
 }
@@ -23,6 +23,12 @@
 #ifndef _TVG_SVG_UTIL_H_
 #define _TVG_SVG_UTIL_H_
 
+#include <stddef.h>
+
 float svgUtilStrtof(const char *nPtr, char **endPtr);
 
+//Decode the data uri payloads into a new buffer the caller frees. Return the decoded size, 0 on failure.
+size_t svgUtilBase64Decode(const char* src, size_t len, char** out);
+size_t svgUtilURLDecode(const char* src, size_t len, char** out);
+
 #endif //_TVG_SVG_UTIL_H_
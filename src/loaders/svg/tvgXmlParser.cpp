@@ -20,7 +20,6 @@
  * SOFTWARE.
  */
 
-#include <ctype.h>
 #include <string>
 
 #ifdef _WIN32
@@ -29,6 +28,12 @@
     #include <alloca.h>
 #endif
 
+#if defined(__SSE2__)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    #include <arm_neon.h>
+#endif
+
 #include "tvgXmlParser.h"
 
 /************************************************************************/
@@ -112,10 +117,45 @@ bool _isIgnoreUnsupportedLogAttributes(const char* tagAttribute, const char* tag
 
 #endif
 
-static const char* _simpleXmlFindWhiteSpace(const char* itr, const char* itrEnd)
+//isspace() of the "C" locale without the locale lookup
+static inline bool _isSpace(char c)
 {
+    return (c == ' ') || ((c >= '\t') && (c <= '\r'));
+}
+
+
+//Find the first whitespace or the given delimiter, 16 bytes at once where the cpu allows.
+static const char* _simpleXmlFindWhiteSpace(const char* itr, const char* itrEnd, char delimiter = ' ')
+{
+#if defined(__SSE2__)
+    const auto space = _mm_set1_epi8(' ');
+    const auto tab = _mm_set1_epi8('\t');
+    const auto range = _mm_set1_epi8('\r' - '\t');
+    const auto delim = _mm_set1_epi8(delimiter);
+    for (; itr + 16 <= itrEnd; itr += 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(itr));
+        //'\t' ~ '\r': the unsigned distance from '\t' is within the range
+        auto dist = _mm_sub_epi8(chunk, tab);
+        auto controls = _mm_cmpeq_epi8(_mm_min_epu8(dist, range), dist);
+        auto match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, space), controls), _mm_cmpeq_epi8(chunk, delim));
+        auto mask = _mm_movemask_epi8(match);
+        if (mask) return itr + __builtin_ctz(mask);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const auto space = vdupq_n_u8(' ');
+    const auto tab = vdupq_n_u8('\t');
+    const auto range = vdupq_n_u8('\r' - '\t');
+    const auto delim = vdupq_n_u8(delimiter);
+    for (; itr + 16 <= itrEnd; itr += 16) {
+        auto chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(itr));
+        auto controls = vcleq_u8(vsubq_u8(chunk, tab), range);
+        auto match = vorrq_u8(vorrq_u8(vceqq_u8(chunk, space), controls), vceqq_u8(chunk, delim));
+        //Pin down the exact position in the scalar loop below
+        if (vmaxvq_u8(match)) break;
+    }
+#endif
     for (; itr < itrEnd; itr++) {
-        if (isspace((unsigned char)*itr)) break;
+        if (_isSpace(*itr) || (*itr == delimiter)) break;
     }
     return itr;
 }
@@ -124,7 +164,7 @@ static const char* _simpleXmlFindWhiteSpace(const char* itr, const char* itrEnd)
 static const char* _simpleXmlSkipWhiteSpace(const char* itr, const char* itrEnd)
 {
     for (; itr < itrEnd; itr++) {
-        if (!isspace((unsigned char)*itr)) break;
+        if (!_isSpace(*itr)) break;
     }
     return itr;
 }
@@ -133,7 +173,7 @@ static const char* _simpleXmlSkipWhiteSpace(const char* itr, const char* itrEnd)
 static const char* _simpleXmlUnskipWhiteSpace(const char* itr, const char* itrStart)
 {
     for (itr--; itr > itrStart; itr--) {
-        if (!isspace((unsigned char)*itr)) break;
+        if (!_isSpace(*itr)) break;
     }
     return itr + 1;
 }
@@ -208,58 +248,83 @@ static const char* _simpleXmlFindStartTag(const char* itr, const char* itrEnd)
 }
 
 
-static const char* _simpleXmlFindEndTag(const char* itr, const char* itrEnd)
+//Find the first '<', '>' or '"', 16 bytes at once where the cpu allows.
+static const char* _simpleXmlFindTagDelimiter(const char* itr, const char* itrEnd)
 {
-    bool insideQuote = false;
+#if defined(__SSE2__)
+    const auto lt = _mm_set1_epi8('<');
+    const auto gt = _mm_set1_epi8('>');
+    const auto quote = _mm_set1_epi8('"');
+    for (; itr + 16 <= itrEnd; itr += 16) {
+        auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(itr));
+        auto match = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, lt), _mm_cmpeq_epi8(chunk, gt)), _mm_cmpeq_epi8(chunk, quote));
+        auto mask = _mm_movemask_epi8(match);
+        if (mask) return itr + __builtin_ctz(mask);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    const auto lt = vdupq_n_u8('<');
+    const auto gt = vdupq_n_u8('>');
+    const auto quote = vdupq_n_u8('"');
+    for (; itr + 16 <= itrEnd; itr += 16) {
+        auto chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(itr));
+        auto match = vorrq_u8(vorrq_u8(vceqq_u8(chunk, lt), vceqq_u8(chunk, gt)), vceqq_u8(chunk, quote));
+        //Pin down the exact position in the scalar loop below
+        if (vmaxvq_u8(match)) break;
+    }
+#endif
     for (; itr < itrEnd; itr++) {
-        if (*itr == '"') insideQuote = !insideQuote;
-        if (!insideQuote) {
-            if ((*itr == '>') || (*itr == '<'))
-                return itr;
-        }
+        if ((*itr == '<') || (*itr == '>') || (*itr == '"')) return itr;
     }
     return nullptr;
 }
 
 
-static const char* _simpleXmlFindEndCommentTag(const char* itr, const char* itrEnd)
+static const char* _simpleXmlFindEndTag(const char* itr, const char* itrEnd)
 {
-    for (; itr < itrEnd; itr++) {
-        if ((*itr == '-') && ((itr + 1 < itrEnd) && (*(itr + 1) == '-')) && ((itr + 2 < itrEnd) && (*(itr + 2) == '>'))) return itr + 2;
+    while (itr < itrEnd) {
+        itr = _simpleXmlFindTagDelimiter(itr, itrEnd);
+        if (!itr || *itr != '"') return itr;
+        //Skip the quoted value
+        itr = (const char*)memchr(itr + 1, '"', itrEnd - itr - 1);
+        if (!itr) return nullptr;
+        itr++;
     }
     return nullptr;
 }
 
 
-static const char* _simpleXmlFindEndCdataTag(const char* itr, const char* itrEnd)
+//Find the '>' of the given terminator ("-->", "]]>")
+static const char* _simpleXmlFindTerminator(const char* itr, const char* itrEnd, char c)
 {
-    for (; itr < itrEnd; itr++) {
-        if ((*itr == ']') && ((itr + 1 < itrEnd) && (*(itr + 1) == ']')) && ((itr + 2 < itrEnd) && (*(itr + 2) == '>'))) return itr + 2;
+    while ((itr = (const char*)memchr(itr, c, itrEnd - itr))) {
+        if ((itr + 2 < itrEnd) && (itr[1] == c) && (itr[2] == '>')) return itr + 2;
+        itr++;
     }
     return nullptr;
 }
 
 
-static const char* _simpleXmlFindDoctypeChildEndTag(const char* itr, const char* itrEnd)
+static const char* _simpleXmlFindEndCommentTag(const char* itr, const char* itrEnd)
 {
-    for (; itr < itrEnd; itr++) {
-        if (*itr == '>') return itr;
-    }
-    return nullptr;
+    return _simpleXmlFindTerminator(itr, itrEnd, '-');
 }
 
 
-/************************************************************************/
-/* External Class Implementation                                        */
-/************************************************************************/
+static const char* _simpleXmlFindEndCdataTag(const char* itr, const char* itrEnd)
+{
+    return _simpleXmlFindTerminator(itr, itrEnd, ']');
+}
 
 
-bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttributeCb func, const void* data)
+static const char* _simpleXmlFindDoctypeChildEndTag(const char* itr, const char* itrEnd)
 {
-    const char *itr = buf, *itrEnd = buf + bufLength;
-    char* tmpBuf = (char*)alloca(bufLength + 1);
+    return (const char*)memchr(itr, '>', itrEnd - itr);
+}
 
-    if (!buf || !func) return false;
+
+static bool _simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttributeCb func, const void* data, char* tmpBuf)
+{
+    const char *itr = buf, *itrEnd = buf + bufLength;
 
     while (itr < itrEnd) {
         const char* p = _skipWhiteSpacesAndXmlEntities(itr, itrEnd);
@@ -269,11 +334,13 @@ bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttr
         if (p == itrEnd) return true;
 
         key = p;
-        for (keyEnd = key; keyEnd < itrEnd; keyEnd++) {
-            if ((*keyEnd == '=') || (isspace((unsigned char)*keyEnd))) break;
-        }
+        keyEnd = _simpleXmlFindWhiteSpace(key, itrEnd, '=');
         if (keyEnd == itrEnd) return false;
-        if (keyEnd == key) continue;
+        //A value without the key ("=value"), skip the separator not to loop forever.
+        if (keyEnd == key) {
+            itr = keyEnd + 1;
+            continue;
+        }
 
         if (*keyEnd == '=') value = keyEnd + 1;
         else {
@@ -305,15 +372,23 @@ bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttr
         tval = tmpBuf + (keyEnd - key) + 1;
         int i = 0;
         while (value < valueEnd) {
-            value = _simpleXmlSkipXmlEntities(value, valueEnd);
-            tval[i++] = *value;
-            value++;
+            //Copy the plain run up to the next entity at once
+            auto entity = (const char*)memchr(value, '&', valueEnd - value);
+            auto run = (entity ? entity : valueEnd) - value;
+            memcpy(tval + i, value, run);
+            i += run;
+            value += run;
+            if (value < valueEnd) {
+                value = _simpleXmlSkipXmlEntities(value, valueEnd);
+                tval[i++] = *value;
+                value++;
+            }
         }
         tval[i] = '\0';
 
 #ifdef THORVG_LOG_ENABLED
         if (!func((void*)data, tmpBuf, tval)) {
-            if (!_isIgnoreUnsupportedLogAttributes(tmpBuf, tval)) printf("SVG: Unsupported attributes used [Elements type: %s][Id : %s][Attribute: %s][Value: %s]\n", simpleXmlNodeTypeToString(((SvgLoaderData*)data)->svgParse->node->type).c_str(), ((SvgLoaderData*)data)->svgParse->node->id ? ((SvgLoaderData*)data)->svgParse->node->id->c_str() : "NO_ID", tmpBuf, tval ? tval : "NONE");
+            if (!_isIgnoreUnsupportedLogAttributes(tmpBuf, tval)) printf("SVG: Unsupported attributes used [Elements type: %s][Id : %s][Attribute: %s][Value: %s]\n", simpleXmlNodeTypeToString(((SvgLoaderData*)data)->svgParse->node->type).c_str(), ((SvgLoaderData*)data)->svgParse->node->id ? ((SvgLoaderData*)data)->svgParse->node->id : "NO_ID", tmpBuf, tval ? tval : "NONE");
         }
 #else
         func((void*)data, tmpBuf, tval);
@@ -323,6 +398,25 @@ bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttr
 }
 
 
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttributeCb func, const void* data)
+{
+    if (!buf || !func) return false;
+
+    //The big attributes such as the embedded images don't fit in the stack.
+    if (bufLength < 4096) return _simpleXmlParseAttributes(buf, bufLength, func, data, (char*)alloca(bufLength + 1));
+
+    auto tmpBuf = (char*)malloc(bufLength + 1);
+    if (!tmpBuf) return false;
+    auto ret = _simpleXmlParseAttributes(buf, bufLength, func, data, tmpBuf);
+    free(tmpBuf);
+    return ret;
+}
+
+
 bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb func, const void* data)
 {
     const char *itr = buf, *itrEnd = buf + bufLength;
@@ -355,7 +449,7 @@ bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb
                     type = SimpleXMLType::Processing;
                     toff = 1;
                 } else if (itr[1] == '!') {
-                    if ((itr + sizeof("<!DOCTYPE>") - 1 < itrEnd) && (!memcmp(itr + 2, "DOCTYPE", sizeof("DOCTYPE") - 1)) && ((itr[2 + sizeof("DOCTYPE") - 1] == '>') || (isspace((unsigned char)itr[2 + sizeof("DOCTYPE") - 1])))) {
+                    if ((itr + sizeof("<!DOCTYPE>") - 1 < itrEnd) && (!memcmp(itr + 2, "DOCTYPE", sizeof("DOCTYPE") - 1)) && ((itr[2 + sizeof("DOCTYPE") - 1] == '>') || (_isSpace(itr[2 + sizeof("DOCTYPE") - 1])))) {
                         type = SimpleXMLType::Doctype;
                         toff = sizeof("!DOCTYPE") - 1;
                     } else if ((itr + sizeof("<!---->") - 1 < itrEnd) && (!memcmp(itr + 2, "--", sizeof("--") - 1))) {
@@ -510,7 +604,7 @@ bool simpleXmlParseW3CAttribute(const char* buf, simpleXMLAttributeCb func, cons
 
 #ifdef THORVG_LOG_ENABLED
             if (!func((void*)data, key, val)) {
-                if (!_isIgnoreUnsupportedLogAttributes(key, val)) printf("SVG: Unsupported attributes used [Elements type: %s][Id : %s][Attribute: %s][Value: %s]\n", simpleXmlNodeTypeToString(((SvgLoaderData*)data)->svgParse->node->type).c_str(), ((SvgLoaderData*)data)->svgParse->node->id ? ((SvgLoaderData*)data)->svgParse->node->id->c_str() : "NO_ID", key, val ? val : "NONE");
+                if (!_isIgnoreUnsupportedLogAttributes(key, val)) printf("SVG: Unsupported attributes used [Elements type: %s][Id : %s][Attribute: %s][Value: %s]\n", simpleXmlNodeTypeToString(((SvgLoaderData*)data)->svgParse->node->type).c_str(), ((SvgLoaderData*)data)->svgParse->node->id ? ((SvgLoaderData*)data)->svgParse->node->id : "NO_ID", key, val ? val : "NONE");
             }
 #else
             func((void*)data, key, val);
@@ -529,7 +623,7 @@ const char* simpleXmlFindAttributesTag(const char* buf, unsigned bufLength)
     const char *itr = buf, *itrEnd = buf + bufLength;
 
     for (; itr < itrEnd; itr++) {
-        if (!isspace((unsigned char)*itr)) {
+        if (!_isSpace(*itr)) {
             //User skip tagname and already gave it the attributes.
             if (*itr == '=') return buf;
         } else {
@@ -20,7 +20,6 @@
  * SOFTWARE.
  */
 
-#include <fstream>
 #include <memory.h>
 #include "tvgLoaderMgr.h"
 #include "tvgTvgLoader.h"
@@ -45,6 +44,12 @@ void TvgLoader::clear()
 /* External Class Implementation                                        */
 /************************************************************************/
 
+TvgLoader::TvgLoader()
+{
+    cancelable = true;
+}
+
+
 TvgLoader::~TvgLoader()
 {
     close();
@@ -55,31 +60,10 @@ bool TvgLoader::open(const string &path)
 {
     clear();
 
-    ifstream f;
-    f.open(path, ifstream::in | ifstream::binary | ifstream::ate);
-
-    if (!f.is_open()) return false;
-
-    size = f.tellg();
-    f.seekg(0, ifstream::beg);
-
-    copy = true;
-    data = (char*)malloc(size);
-    if (!data) {
-        clear();
-        f.close();
-        return false;
-    }
-
-    if (!f.read((char*)data, size))
-    {
-        clear();
-        f.close();
-        return false;
-    }
-
-    f.close();
+    if (!file.open(path)) return false;
 
+    data = file.data;
+    size = file.size;
     pointer = data;
 
     return tvgValidateData(pointer, size);
@@ -121,8 +105,9 @@ bool TvgLoader::close()
 void TvgLoader::run(unsigned tid)
 {
     if (root) root.reset();
-    root = tvgLoadData(pointer, size);
+    if (!canceled) root = tvgLoadData(pointer, size);
     if (!root) clear();
+    notify(root != nullptr);
 }
 
 unique_ptr<Scene> TvgLoader::scene()
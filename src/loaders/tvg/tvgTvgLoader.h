@@ -24,10 +24,12 @@
 #define _TVG_TVG_LOADER_H_
 
 #include "tvgTaskScheduler.h"
+#include "tvgLoaderMgr.h"
 
 class TvgLoader : public Loader, public Task
 {
 public:
+    FileMap file;
     const char* data = nullptr;
     const char* pointer = nullptr;
     uint32_t size = 0;
@@ -36,6 +38,7 @@ public:
 
     bool copy = false;
 
+    TvgLoader();
     ~TvgLoader();
 
     using Loader::open;
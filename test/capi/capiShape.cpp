@@ -145,6 +145,29 @@ TEST_CASE("Stroke dash", "[capiStrokeDash]")
     REQUIRE(tvg_paint_del(paint) == TVG_RESULT_SUCCESS);
 }
 
+TEST_CASE("Stroke dash offset", "[capiStrokeDashOffset]")
+{
+    Tvg_Paint* paint = tvg_shape_new();
+    REQUIRE(paint);
+
+    float dash[2] = {20, 10};
+    float offset;
+
+    REQUIRE(tvg_shape_set_stroke_dash_offset(paint, 5) == TVG_RESULT_INSUFFICIENT_CONDITION);
+    REQUIRE(tvg_shape_get_stroke_dash_offset(paint, &offset) == TVG_RESULT_SUCCESS);
+    REQUIRE(offset == 0);
+
+    REQUIRE(tvg_shape_set_stroke_dash(paint, dash, 2) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_shape_set_stroke_dash_offset(paint, -7.5f) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_shape_get_stroke_dash_offset(paint, &offset) == TVG_RESULT_SUCCESS);
+    REQUIRE(offset == -7.5f);
+
+    REQUIRE(tvg_shape_set_stroke_dash_offset(NULL, 5) == TVG_RESULT_INVALID_ARGUMENT);
+    REQUIRE(tvg_shape_get_stroke_dash_offset(paint, NULL) == TVG_RESULT_INVALID_ARGUMENT);
+
+    REQUIRE(tvg_paint_del(paint) == TVG_RESULT_SUCCESS);
+}
+
 TEST_CASE("Stroke cap", "[capiStrokeCap]")
 {
     Tvg_Paint* paint = tvg_shape_new();
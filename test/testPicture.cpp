@@ -0,0 +1,935 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <thorvg.h>
+#include <fstream>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <atomic>
+#ifndef _WIN32
+    #include <dirent.h>
+    #include <unistd.h>
+    #include <utime.h>
+    #include <sys/stat.h>
+#endif
+#include "config.h"
+#include "catch.hpp"
+
+using namespace tvg;
+
+#ifdef THORVG_SVG_LOADER_SUPPORT
+
+static const char* svgPath = "testPicture.svg";
+static const char* otherPath = "testPicture2.svg";
+static const char* pngPath = "testPicture.png";
+
+//The default budget of the loader cache
+#define LOADER_CACHE_BUDGET (32 * 1024 * 1024)
+
+
+static void _writeSvg(const char* path, const char* data)
+{
+    std::ofstream file(path, std::ios::binary);
+    file << data;
+}
+
+
+//Removes the written files at the end of the test, even if it fails.
+struct TempFiles
+{
+    ~TempFiles()
+    {
+        remove(svgPath);
+        remove(otherPath);
+        remove(pngPath);
+    }
+};
+
+
+TEST_CASE("Load Mapped File", "[tvgPicture]")
+{
+    TempFiles files;
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    //Bypass the loader cache, every file is mapped again.
+    REQUIRE(Initializer::cache(0) == Result::Success);
+
+    const char* svg = "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"#0000ff\"/></svg>";
+    const char* truncated = "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"#0000ff\"/><rect width=\"5";
+
+    //The common page sizes, the data ends on the page boundary without any terminator
+    for (auto size : {4095, 4096, 4097, 16384}) {
+        for (auto doc : {svg, truncated}) {
+            std::string data(doc);
+            data.insert(data.find("<rect"), size - data.size(), ' ');
+            REQUIRE(data.size() == static_cast<size_t>(size));
+            _writeSvg(svgPath, data.c_str());
+
+            //The same as the data loaded from the memory
+            auto picture = Picture::gen();
+            auto picture2 = Picture::gen();
+            auto result = picture->load(svgPath);
+            REQUIRE(picture2->load(data.data(), data.size(), true) == result);
+            if (result != Result::Success) continue;
+
+            float w, h, w2, h2;
+            REQUIRE(picture->size(&w, &h) == Result::Success);
+            REQUIRE(picture2->size(&w2, &h2) == Result::Success);
+            REQUIRE(w == w2);
+            REQUIRE(h == h2);
+            REQUIRE(w == 100.0f);
+        }
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+TEST_CASE("Load Cache", "[tvgPicture]")
+{
+    TempFiles files;
+
+    REQUIRE(Initializer::cache(1024) == Result::InsufficientCondition);
+
+    _writeSvg(svgPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"blue\"/><circle cx=\"50\" cy=\"50\" r=\"20\"/></svg>");
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    uint32_t hits, misses;
+    size_t bytes;
+
+    SECTION("Shared Loads") {
+        auto picture = Picture::gen();
+        REQUIRE(picture->load(svgPath) == Result::Success);
+        auto picture2 = Picture::gen();
+        REQUIRE(picture2->load(svgPath) == Result::Success);
+
+        REQUIRE(Initializer::cache(&hits, &misses, &bytes) == Result::Success);
+        REQUIRE(hits == 1);
+        REQUIRE(misses == 1);
+        REQUIRE(bytes > 0);
+
+        //Both pictures have the same content
+        float w, h, w2, h2;
+        REQUIRE(picture->size(&w, &h) == Result::Success);
+        REQUIRE(picture2->size(&w2, &h2) == Result::Success);
+        REQUIRE(w == w2);
+        REQUIRE(h == h2);
+
+        REQUIRE(Initializer::cache(nullptr, nullptr, nullptr) == Result::Success);
+    }
+
+    SECTION("Scene Charged") {
+        auto canvas = SwCanvas::gen();
+        uint32_t buffer[100 * 100];
+        REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+        auto picture = Picture::gen();
+        REQUIRE(picture->load(svgPath) == Result::Success);
+        REQUIRE(canvas->push(move(picture)) == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+
+        //The document is charged with its parsed scene, not with its file size
+        REQUIRE(Initializer::cache(nullptr, nullptr, &bytes) == Result::Success);
+        std::ifstream file(svgPath, std::ios::binary | std::ios::ate);
+        REQUIRE(bytes != static_cast<size_t>(file.tellg()));
+        REQUIRE(bytes > 0);
+    }
+
+    SECTION("Disabled Cache") {
+        REQUIRE(Initializer::cache(0) == Result::Success);
+
+        auto picture = Picture::gen();
+        REQUIRE(picture->load(svgPath) == Result::Success);
+        auto picture2 = Picture::gen();
+        REQUIRE(picture2->load(svgPath) == Result::Success);
+
+        REQUIRE(Initializer::cache(&hits, &misses, &bytes) == Result::Success);
+        REQUIRE(hits == 0);
+        REQUIRE(bytes == 0);
+    }
+
+    SECTION("Concurrent Loads") {
+        //Long to open, the loads overlap
+        {
+            std::ofstream file(svgPath, std::ios::binary);
+            for (int i = 0; i < 100000; ++i) file << "<!-- -->";
+            file << "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"blue\"/></svg>";
+        }
+        auto picture = Picture::gen();
+        REQUIRE(picture->load(svgPath) == Result::Success);
+        uint32_t prevHits, prevMisses;
+        size_t single;
+        REQUIRE(Initializer::cache(&prevHits, &prevMisses, &single) == Result::Success);
+
+        //Start over, the same file is loaded by the threads at once
+        REQUIRE(Initializer::cache(0) == Result::Success);
+        REQUIRE(Initializer::cache(LOADER_CACHE_BUDGET) == Result::Success);
+
+        std::unique_ptr<Picture> pictures[8];
+        std::thread threads[8];
+        std::atomic<bool> start(false);
+        for (int i = 0; i < 8; ++i) {
+            pictures[i] = Picture::gen();
+            threads[i] = std::thread([&pictures, &start, i]() {
+                while (!start) std::this_thread::yield();
+                pictures[i]->load(svgPath);
+            });
+        }
+        start = true;
+        for (auto& thread : threads) thread.join();
+
+        //The file is kept once
+        REQUIRE(Initializer::cache(&hits, &misses, &bytes) == Result::Success);
+        REQUIRE(hits + misses == prevHits + prevMisses + 8);
+        REQUIRE(bytes == single);
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+TEST_CASE("Load Sniffed Format", "[tvgPicture]")
+{
+    TempFiles files;
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    const std::string svg = "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"blue\"/></svg>";
+    float w, h;
+
+    //The contents decide, not the extension
+    _writeSvg(pngPath, svg.c_str());
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(pngPath) == Result::Success);
+    REQUIRE(picture->size(&w, &h) == Result::Success);
+    REQUIRE(w == 100.0f);
+
+#ifdef THORVG_PNG_LOADER_SUPPORT
+    {
+        std::ifstream png(EXAMPLE_DIR"/logo.png", std::ios::binary);
+        std::ofstream file(svgPath, std::ios::binary);
+        file << png.rdbuf();
+    }
+    REQUIRE(picture->load(svgPath) == Result::Success);
+    uint32_t pw, ph;
+    REQUIRE(picture->data(&pw, &ph));
+    REQUIRE(pw > 0);
+#endif
+
+    //The document starts after a bom, the blanks, the declaration or a comment
+    for (auto head : {"\xef\xbb\xbf", " \r\n\t", "<?xml version=\"1.0\"?>\n", "<!-- > -->", "<!DOCTYPE svg>"}) {
+        auto data = std::string(head) + svg;
+        REQUIRE(picture->load(data.data(), data.size(), true) == Result::Success);
+        REQUIRE(picture->size(&w, &h) == Result::Success);
+        REQUIRE(w == 100.0f);
+    }
+
+    //Nothing recognizes it
+    const char* unknown = "GIF89a\x01\x00\x01\x00";
+    REQUIRE(picture->load(unknown, 10, true) != Result::Success);
+    _writeSvg(pngPath, unknown);
+    REQUIRE(picture->load(pngPath) != Result::Success);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+static void _loaded(Picture* picture, Result result, void* data)
+{
+    *static_cast<Result*>(data) = result;
+}
+
+
+TEST_CASE("Load Callback", "[tvgPicture]")
+{
+    TempFiles files;
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    auto picture = Picture::gen();
+    auto result = Result::Unknown;
+
+    //Loaded in place without threads
+    _writeSvg(svgPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"blue\"/></svg>");
+    REQUIRE(picture->load(svgPath, _loaded, &result) == Result::Success);
+    REQUIRE(result == Result::Success);
+
+    //Not loaded, the function isn't called
+    result = Result::Unknown;
+    _writeSvg(svgPath, "<html></html>");
+    REQUIRE(picture->load(svgPath, _loaded, &result) != Result::Success);
+    REQUIRE(result == Result::Unknown);
+
+    REQUIRE(picture->load("", _loaded, &result) == Result::InvalidArguments);
+    REQUIRE(picture->load(svgPath, nullptr, &result) == Result::InvalidArguments);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+//Holds the loading thread until it's released.
+struct Blocker
+{
+    std::atomic<bool> released{false};
+    Result result = Result::Unknown;
+};
+
+
+static void _blocked(Picture* picture, Result result, void* data)
+{
+    auto blocker = static_cast<Blocker*>(data);
+    while (!blocker->released) std::this_thread::yield();
+    blocker->result = result;
+}
+
+
+TEST_CASE("Load Cancel", "[tvgPicture]")
+{
+    TempFiles files;
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 1) == Result::Success);
+
+    //Nothing to cancel
+    auto picture = Picture::gen();
+    REQUIRE(picture->cancel() == Result::InsufficientCondition);
+
+#ifdef THORVG_PNG_LOADER_SUPPORT
+    //Images are decoded at once
+    REQUIRE(picture->load(EXAMPLE_DIR"/logo.png") == Result::Success);
+    REQUIRE(picture->cancel() == Result::InsufficientCondition);
+#endif
+
+    //Shared loadings
+    REQUIRE(picture->load(EXAMPLE_DIR"/logo.svg") == Result::Success);
+    REQUIRE(picture->cancel() == Result::InsufficientCondition);
+
+    _writeSvg(svgPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"100\" height=\"100\" fill=\"red\"/></svg>");
+
+    //The only loading thread is held by the first loading, the second one is canceled before it starts.
+    auto busy = Picture::gen();
+    Blocker blocker;
+    REQUIRE(busy->load(svgPath, _blocked, &blocker) == Result::Success);
+
+    auto result = Result::Unknown;
+    REQUIRE(picture->load(svgPath, _loaded, &result) == Result::Success);
+    REQUIRE(picture->cancel() == Result::Success);
+    blocker.released = true;
+
+    //A canceled picture draws nothing, the others are still drawn.
+    auto canvas = SwCanvas::gen();
+    uint32_t buffer[100 * 100] = {0};
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto shape = Shape::gen();
+    REQUIRE(shape->appendRect(0, 0, 50, 100, 0, 0) == Result::Success);
+    REQUIRE(shape->fill(0, 0, 255, 255) == Result::Success);
+
+    REQUIRE(canvas->push(move(picture)) == Result::Success);
+    REQUIRE(canvas->push(move(shape)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    REQUIRE(result == Result::InsufficientCondition);
+    REQUIRE(buffer[0] == 0xff0000ff);
+    REQUIRE(buffer[99] == 0);
+
+    //The other one is drawn
+    REQUIRE(canvas->push(move(busy)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    REQUIRE(blocker.result == Result::Success);
+    REQUIRE(buffer[99] == 0xffff0000);
+
+    REQUIRE(canvas->clear() == Result::Success);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+#ifdef THORVG_PNG_LOADER_SUPPORT
+
+TEST_CASE("Pixels In Level Of Detail", "[tvgPicture]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(EXAMPLE_DIR"/logo.png") == Result::Success);
+
+    float w, h;
+    REQUIRE(picture->size(&w, &h) == Result::Success);
+    REQUIRE(w > 100);
+
+    uint32_t pw, ph;
+    auto pixels = picture->data(&pw, &ph);
+    REQUIRE(pixels);
+    REQUIRE(pw == static_cast<uint32_t>(w));
+    REQUIRE(ph == static_cast<uint32_t>(h));
+    auto center = pixels[ph / 2 * pw + pw / 2];
+
+    //Drawn in a reduced level of detail
+    auto canvas = SwCanvas::gen();
+    uint32_t buffer[100 * 100];
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto p = picture.get();
+    REQUIRE(p->scale(0.1f) == Result::Success);
+    REQUIRE(canvas->push(move(picture)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    //Still in the full size
+    pixels = p->data(&pw, &ph);
+    REQUIRE(pixels);
+    REQUIRE(pw == static_cast<uint32_t>(w));
+    REQUIRE(ph == static_cast<uint32_t>(h));
+    REQUIRE(pixels[ph / 2 * pw + pw / 2] == center);
+    REQUIRE(p->data() == pixels);
+
+    //Back to the full size
+    REQUIRE(p->scale(1.0f) == Result::Success);
+    REQUIRE(canvas->update(p) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(p->data(&pw, &ph));
+    REQUIRE(pw == static_cast<uint32_t>(w));
+
+    REQUIRE(canvas->clear() == Result::Success);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+#endif
+
+
+static void _drawSvg(const char* path, uint32_t* buffer)
+{
+    memset(buffer, 0, 100 * 100 * sizeof(uint32_t));
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(path) == Result::Success);
+    REQUIRE(canvas->push(move(picture)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+}
+
+
+TEST_CASE("Nested Svg Images", "[tvgPicture]")
+{
+    TempFiles files;
+    uint32_t buffer[100 * 100];
+
+    for (uint32_t threads = 0; threads < 2; ++threads) {
+        REQUIRE(Initializer::init(CanvasEngine::Sw, threads) == Result::Success);
+
+        //Refers to itself
+        _writeSvg(svgPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"blue\"/><image href=\"testPicture.svg\" width=\"100\" height=\"100\"/></svg>");
+        _drawSvg(svgPath, buffer);
+        REQUIRE(buffer[0] == 0xff0000ff);
+
+        //Refer to each other
+        _writeSvg(svgPath, "<svg viewBox=\"0 0 100 100\"><image href=\"testPicture2.svg\" width=\"100\" height=\"100\"/></svg>");
+        _writeSvg(otherPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"50\" height=\"50\" fill=\"blue\"/><image href=\"testPicture.svg\" width=\"100\" height=\"100\"/></svg>");
+        _drawSvg(svgPath, buffer);
+        _drawSvg(otherPath, buffer);
+        _drawSvg(svgPath, buffer);
+        REQUIRE(buffer[0] == 0xff0000ff);
+
+        //A document image without cycles is drawn
+        _writeSvg(otherPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"100\" height=\"100\" fill=\"blue\"/></svg>");
+        REQUIRE(Initializer::cache(0) == Result::Success);
+        _drawSvg(svgPath, buffer);
+        REQUIRE(buffer[99 * 100 + 99] == 0xff0000ff);
+
+        REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+    }
+}
+
+
+#ifndef _WIN32
+
+TEST_CASE("Svg Image Paths", "[tvgPicture]")
+{
+    TempFiles files;
+    uint32_t buffer[100 * 100];
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+    REQUIRE(Initializer::cache(0) == Result::Success);
+
+    _writeSvg(otherPath, "<svg viewBox=\"0 0 100 100\"><rect width=\"100\" height=\"100\" fill=\"blue\"/></svg>");
+
+    char cwd[4096];
+    REQUIRE(getcwd(cwd, sizeof(cwd)));
+    std::string dir = cwd;
+    auto name = dir.substr(dir.find_last_of('/') + 1);
+
+    auto draw = [&](const std::string& href) {
+        auto svg = "<svg viewBox=\"0 0 100 100\"><image href=\"" + href + "\" width=\"100\" height=\"100\"/></svg>";
+        _writeSvg(svgPath, svg.c_str());
+        _drawSvg(svgPath, buffer);
+        return buffer[50 * 100 + 50];
+    };
+
+    //In the document directory
+    REQUIRE(draw(otherPath) == 0xff0000ff);
+    REQUIRE(draw(std::string("./") + otherPath) == 0xff0000ff);
+
+    //Elsewhere, even if it's the same file
+    REQUIRE(draw(dir + "/" + otherPath) == 0);
+    REQUIRE(draw("../" + name + "/" + otherPath) == 0);
+    REQUIRE(draw(std::string("file://") + otherPath) == 0);
+    REQUIRE(draw("file://" + dir + "/" + otherPath) == 0);
+
+    //Loaded from the memory, the document has no directory.
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    auto svg = std::string("<svg viewBox=\"0 0 100 100\"><image href=\"") + otherPath + "\" width=\"100\" height=\"100\"/></svg>";
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(svg.data(), svg.size(), true) == Result::Success);
+    REQUIRE(canvas->push(move(picture)) == Result::Success);
+    memset(buffer, 0, sizeof(buffer));
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(buffer[50 * 100 + 50] == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+
+static const char* cacheDir = "testPictureCache";
+
+
+//The only entry of the cache directory, if any.
+static std::string _cacheEntry()
+{
+    std::string entry;
+    if (auto dir = opendir(cacheDir)) {
+        while (auto e = readdir(dir)) {
+            if (e->d_name[0] != '.') entry = std::string(cacheDir) + "/" + e->d_name;
+        }
+        closedir(dir);
+    }
+    return entry;
+}
+
+
+//Removes the cache directory at the end of the test, even if it fails.
+struct TempCache
+{
+    ~TempCache()
+    {
+        if (auto dir = opendir(cacheDir)) {
+            while (auto e = readdir(dir)) {
+                if (e->d_name[0] != '.') remove((std::string(cacheDir) + "/" + e->d_name).c_str());
+            }
+            closedir(dir);
+        }
+        rmdir(cacheDir);
+    }
+};
+
+
+static time_t _mtime(const std::string& path)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return 0;
+    return info.st_mtime;
+}
+
+
+TEST_CASE("Svg Cache", "[tvgPicture]")
+{
+    TempFiles files;
+    TempCache cache;
+
+    REQUIRE(Initializer::cache(std::string(cacheDir)) == Result::InsufficientCondition);
+
+    mkdir(cacheDir, 0755);
+    _writeSvg(svgPath, "<svg viewBox=\"0 0 100 100\"><defs><linearGradient id=\"g\"><stop offset=\"0\" stop-color=\"red\"/><stop offset=\"1\" stop-color=\"blue\"/></linearGradient></defs>"
+                       "<style>.a{fill:blue}</style><rect class=\"a\" width=\"50\" height=\"50\"/><circle cx=\"70\" cy=\"70\" r=\"25\" fill=\"url(#g)\"/></svg>");
+
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+    //Every picture loads the document by itself
+    REQUIRE(Initializer::cache(0) == Result::Success);
+    REQUIRE(Initializer::cache(std::string(cacheDir)) == Result::Success);
+
+    uint32_t first[100 * 100], buffer[100 * 100];
+
+    //Parsed and saved
+    _drawSvg(svgPath, first);
+    auto entry = _cacheEntry();
+    REQUIRE(!entry.empty());
+    std::ifstream saved(entry, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(saved)), std::istreambuf_iterator<char>());
+    REQUIRE(contents.size() > 0);
+
+    //Loaded from the cache, the entry isn't written again
+    struct utimbuf past = {1000000000, 1000000000};
+    REQUIRE(utime(entry.c_str(), &past) == 0);
+    _drawSvg(svgPath, buffer);
+    REQUIRE(memcmp(first, buffer, sizeof(buffer)) == 0);
+    REQUIRE(_mtime(entry) == past.modtime);
+
+    //A corrupted entry falls back to the parsing and it's written again
+    {
+        std::fstream file(entry, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(contents.size() / 2);
+        file.put(contents[contents.size() / 2] ^ 0x5a);
+    }
+    REQUIRE(utime(entry.c_str(), &past) == 0);
+    _drawSvg(svgPath, buffer);
+    REQUIRE(memcmp(first, buffer, sizeof(buffer)) == 0);
+    REQUIRE(_mtime(entry) != past.modtime);
+    std::ifstream rewritten(entry, std::ios::binary);
+    REQUIRE(std::string((std::istreambuf_iterator<char>(rewritten)), std::istreambuf_iterator<char>()) == contents);
+
+    //A truncated one too
+    {
+        std::ofstream file(entry, std::ios::binary | std::ios::trunc);
+        file << contents.substr(0, 16);
+    }
+    _drawSvg(svgPath, buffer);
+    REQUIRE(memcmp(first, buffer, sizeof(buffer)) == 0);
+
+    //Disabled
+    REQUIRE(Initializer::cache(std::string()) == Result::Success);
+    remove(entry.c_str());
+    _drawSvg(svgPath, buffer);
+    REQUIRE(memcmp(first, buffer, sizeof(buffer)) == 0);
+    REQUIRE(_cacheEntry().empty());
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+#endif
+
+#endif
+
+
+#ifdef THORVG_PNG_LOADER_SUPPORT
+
+TEST_CASE("Png Premultiplied", "[tvgPicture]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    //2x2 RGBA: translucent red, opaque green, transparent blue, translucent white
+    static const char png[] = "\x89\x50\x4e\x47\x0d\x0a\x1a\x0a\x00\x00\x00\x0d\x49\x48\x44\x52\x00\x00\x00\x02\x00\x00\x00\x02\x08\x06\x00\x00\x00\x72\xb6\x0d\x24\x00\x00\x00\x16\x49\x44\x41\x54\x78\x9c\x63\xf8\xcf\xc0\xd0\xc0\xf0\x1f\x08\x19\x40\xe4\xff\xff\x0e\x00\x3d\x1c\x07\xba\x75\xad\x79\x51\x00\x00\x00\x00\x49\x45\x4e\x44\xae\x42\x60\x82";
+    //The same in Adam7 interlacing
+    static const char interlaced[] = "\x89\x50\x4e\x47\x0d\x0a\x1a\x0a\x00\x00\x00\x0d\x49\x48\x44\x52\x00\x00\x00\x02\x00\x00\x00\x02\x08\x06\x00\x00\x01\x05\xb1\x3d\xb2\x00\x00\x00\x16\x49\x44\x41\x54\x78\x9c\x63\xf8\xcf\xc0\xd0\xc0\xc0\xf0\x1f\x08\xc1\xe4\xff\xff\x0e\x00\x3e\x9c\x07\xba\xba\x2d\xde\xb0\x00\x00\x00\x00\x49\x45\x4e\x44\xae\x42\x60\x82";
+
+    for (auto data : {std::string(png, sizeof(png) - 1), std::string(interlaced, sizeof(interlaced) - 1)}) {
+        auto picture = Picture::gen();
+        REQUIRE(picture->load(data.data(), data.size(), true) == Result::Success);
+
+        uint32_t w, h;
+        auto pixels = picture->data(&w, &h);
+        REQUIRE(pixels);
+        REQUIRE(w == 2);
+        REQUIRE(h == 2);
+
+        //ARGB8888, the colors are multiplied by the alpha
+        REQUIRE(pixels[0] == 0x80800000);
+        REQUIRE(pixels[1] == 0xff00ff00);
+        REQUIRE(pixels[2] == 0x00000000);
+        REQUIRE(pixels[3] == 0x40404040);
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+#endif
+
+
+#ifdef THORVG_JPG_LOADER_SUPPORT
+
+//16x16, no subsampling: red on the left half, blue on the top right and green on the bottom right quarter.
+static const char jpgBaseline[] =
+        "\xff\xd8\xff\xe0\x00\x10\x4a\x46\x49\x46\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00\xff\xdb\x00\x43\x00\x03\x02\x02\x03\x02\x02\x03\x03\x03\x03\x04\x03\x03\x04\x05"
+        "\x08\x05\x05\x04\x04\x05\x0a\x07\x07\x06\x08\x0c\x0a\x0c\x0c\x0b\x0a\x0b\x0b\x0d\x0e\x12\x10\x0d\x0e\x11\x0e\x0b\x0b\x10\x16\x10\x11\x13\x14\x15\x15\x15\x0c\x0f"
+        "\x17\x18\x16\x14\x18\x12\x14\x15\x14\xff\xdb\x00\x43\x01\x03\x04\x04\x05\x04\x05\x09\x05\x05\x09\x14\x0d\x0b\x0d\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14"
+        "\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\xff\xc0"
+        "\x00\x11\x08\x00\x10\x00\x10\x03\x01\x11\x00\x02\x11\x01\x03\x11\x01\xff\xc4\x00\x15\x00\x01\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x07\x08"
+        "\xff\xc4\x00\x14\x10\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xff\xc4\x00\x16\x01\x01\x01\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+        "\x00\x00\x00\x09\x07\x0a\xff\xc4\x00\x14\x11\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xff\xda\x00\x0c\x03\x01\x00\x02\x11\x03\x11\x00"
+        "\x3f\x00\x9d\x10\xc2\xa6\x02\x38\xc1\xd0\xfa\x0e\x4c\x5a\xc6\x44\x99\x8f\x7f\xff\xd9";
+//The same, progressive: spectral selection and successive approximation scans
+static const char jpgProgressive[] =
+        "\xff\xd8\xff\xe0\x00\x10\x4a\x46\x49\x46\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00\xff\xdb\x00\x43\x00\x03\x02\x02\x03\x02\x02\x03\x03\x03\x03\x04\x03\x03\x04\x05"
+        "\x08\x05\x05\x04\x04\x05\x0a\x07\x07\x06\x08\x0c\x0a\x0c\x0c\x0b\x0a\x0b\x0b\x0d\x0e\x12\x10\x0d\x0e\x11\x0e\x0b\x0b\x10\x16\x10\x11\x13\x14\x15\x15\x15\x0c\x0f"
+        "\x17\x18\x16\x14\x18\x12\x14\x15\x14\xff\xdb\x00\x43\x01\x03\x04\x04\x05\x04\x05\x09\x05\x05\x09\x14\x0d\x0b\x0d\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14"
+        "\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\xff\xc2"
+        "\x00\x11\x08\x00\x10\x00\x10\x03\x01\x11\x00\x02\x11\x01\x03\x11\x01\xff\xc4\x00\x15\x00\x01\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x06\x07"
+        "\xff\xc4\x00\x16\x01\x01\x01\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x08\x06\x09\xff\xda\x00\x0c\x03\x01\x00\x02\x10\x03\x10\x00\x00\x01\x9c\xc2"
+        "\xaa\x40\xb8\xc7\x4f\x83\x8c\x5b\x1c\x4e\x63\xff\x00\xff\xc4\x00\x14\x10\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01"
+        "\x01\x00\x01\x05\x02\x1f\xff\xc4\x00\x14\x11\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01\x03\x01\x01\x3f\x01\x1f\xff"
+        "\xc4\x00\x14\x11\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01\x02\x01\x01\x3f\x01\x1f\xff\xc4\x00\x14\x10\x01\x00\x00"
+        "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01\x01\x00\x06\x3f\x02\x1f\xff\xc4\x00\x14\x10\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+        "\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01\x01\x00\x01\x3f\x21\x1f\xff\xda\x00\x0c\x03\x01\x00\x02\x00\x03\x00\x00\x00\x10\xeb\xdf\xff\xc4\x00\x14\x11\x01"
+        "\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01\x03\x01\x01\x3f\x10\x1f\xff\xc4\x00\x14\x11\x01\x00\x00\x00\x00\x00\x00\x00"
+        "\x00\x00\x00\x00\x00\x00\x00\x00\x20\xff\xda\x00\x08\x01\x02\x01\x01\x3f\x10\x1f\xff\xc4\x00\x14\x10\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00"
+        "\x00\x20\xff\xda\x00\x08\x01\x01\x00\x01\x3f\x10\x1f\xff\xd9";
+//The same, baseline with a restart marker after every mcu
+static const char jpgRestart[] =
+        "\xff\xd8\xff\xe0\x00\x10\x4a\x46\x49\x46\x00\x01\x01\x00\x00\x01\x00\x01\x00\x00\xff\xdb\x00\x43\x00\x03\x02\x02\x03\x02\x02\x03\x03\x03\x03\x04\x03\x03\x04\x05"
+        "\x08\x05\x05\x04\x04\x05\x0a\x07\x07\x06\x08\x0c\x0a\x0c\x0c\x0b\x0a\x0b\x0b\x0d\x0e\x12\x10\x0d\x0e\x11\x0e\x0b\x0b\x10\x16\x10\x11\x13\x14\x15\x15\x15\x0c\x0f"
+        "\x17\x18\x16\x14\x18\x12\x14\x15\x14\xff\xdb\x00\x43\x01\x03\x04\x04\x05\x04\x05\x09\x05\x05\x09\x14\x0d\x0b\x0d\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14"
+        "\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\x14\xff\xc0"
+        "\x00\x11\x08\x00\x10\x00\x10\x03\x01\x11\x00\x02\x11\x01\x03\x11\x01\xff\xc4\x00\x16\x00\x01\x01\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x08\x06"
+        "\x09\xff\xc4\x00\x14\x10\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xff\xc4\x00\x17\x01\x01\x01\x01\x01\x00\x00\x00\x00\x00\x00\x00\x00"
+        "\x00\x00\x00\x00\x09\x07\x06\x08\xff\xc4\x00\x14\x11\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xff\xdd\x00\x04\x00\x01\xff\xda\x00\x0c"
+        "\x03\x01\x00\x02\x11\x03\x11\x00\x3f\x00\x3a\x21\x85\x4d\xff\xd0\xcf\x72\xa6\xc3\xbf\xff\xd1\x3a\x21\x85\x4d\xff\xd2\xbb\x70\xf8\xe2\x7f\xff\xd9";
+
+
+static std::string _jpg(const char* data, size_t size)
+{
+    return std::string(data, size - 1);
+}
+
+
+static size_t _length(const std::string& jpg, size_t pos)
+{
+    return (static_cast<uint8_t>(jpg[pos + 2]) << 8) | static_cast<uint8_t>(jpg[pos + 3]);
+}
+
+
+//Offset of the segment of the marker m, up to the first scan. npos if there is none.
+static size_t _segment(const std::string& jpg, uint8_t m)
+{
+    size_t pos = 2;
+    while (pos + 4 <= jpg.size() && static_cast<uint8_t>(jpg[pos]) == 0xff) {
+        auto marker = static_cast<uint8_t>(jpg[pos + 1]);
+        if (marker == m) return pos;
+        if (marker == 0xda) break;
+        pos += 2 + _length(jpg, pos);
+    }
+    return std::string::npos;
+}
+
+
+//The lossy colors within a few steps
+static bool _near(uint32_t pixel, uint32_t color)
+{
+    for (uint32_t shift = 0; shift < 32; shift += 8) {
+        auto a = (pixel >> shift) & 0xff;
+        auto b = (color >> shift) & 0xff;
+        if ((a > b ? a - b : b - a) > 4) return false;
+    }
+    return true;
+}
+
+
+static bool _loadJpg(Picture* picture, const std::string& jpg)
+{
+    return picture->load(jpg.data(), jpg.size(), true) == Result::Success;
+}
+
+
+//Opaque ARGB8888, as the png loader produces.
+static void _checkQuarters(const uint32_t* pixels, uint32_t w, uint32_t h)
+{
+    REQUIRE(pixels);
+    REQUIRE(w == 16);
+    REQUIRE(h == 16);
+    REQUIRE(_near(pixels[0], 0xffff0000));
+    REQUIRE(_near(pixels[12 * 16 + 4], 0xffff0000));
+    REQUIRE(_near(pixels[15], 0xff0000ff));
+    REQUIRE(_near(pixels[15 * 16 + 15], 0xff00ff00));
+}
+
+
+TEST_CASE("Jpg Decode", "[tvgPicture]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    uint32_t w, h;
+
+    SECTION("Baseline") {
+        auto picture = Picture::gen();
+        REQUIRE(_loadJpg(picture.get(), _jpg(jpgBaseline, sizeof(jpgBaseline))));
+        auto pixels = picture->data(&w, &h);
+        _checkQuarters(pixels, w, h);
+    }
+
+    SECTION("Progressive") {
+        auto picture = Picture::gen();
+        REQUIRE(_loadJpg(picture.get(), _jpg(jpgProgressive, sizeof(jpgProgressive))));
+        auto pixels = picture->data(&w, &h);
+        _checkQuarters(pixels, w, h);
+
+        //The same pixels as the baseline one
+        auto baseline = Picture::gen();
+        REQUIRE(_loadJpg(baseline.get(), _jpg(jpgBaseline, sizeof(jpgBaseline))));
+        REQUIRE(memcmp(pixels, baseline->data(), 16 * 16 * sizeof(uint32_t)) == 0);
+    }
+
+    SECTION("Restart Markers") {
+        auto jpg = _jpg(jpgRestart, sizeof(jpgRestart));
+        auto picture = Picture::gen();
+        REQUIRE(_loadJpg(picture.get(), jpg));
+        _checkQuarters(picture->data(&w, &h), w, h);
+
+        //Broken data of the first mcu: the decoding starts over at the marker, the predictions too.
+        auto sos = _segment(jpg, 0xda);
+        auto rst = jpg.find("\xff\xd0");
+        REQUIRE(sos != std::string::npos);
+        REQUIRE(rst != std::string::npos);
+        for (auto i = sos + 2 + _length(jpg, sos); i < rst; ++i) jpg[i] = '\x5a';
+
+        auto broken = Picture::gen();
+        REQUIRE(_loadJpg(broken.get(), jpg));
+        auto pixels = broken->data(&w, &h);
+        REQUIRE(pixels);
+        REQUIRE(_near(pixels[12 * 16 + 4], 0xffff0000));
+        REQUIRE(_near(pixels[15], 0xff0000ff));
+        REQUIRE(_near(pixels[15 * 16 + 15], 0xff00ff00));
+    }
+
+    SECTION("Drawn") {
+        //The pixels are ARGB8888 regardless of the canvas, like the png ones.
+        uint32_t buffer[16 * 16];
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas->target(buffer, 16, 16, 16, SwCanvas::ARGB8888) == Result::Success);
+
+        for (auto jpg : {_jpg(jpgBaseline, sizeof(jpgBaseline)), _jpg(jpgProgressive, sizeof(jpgProgressive)), _jpg(jpgRestart, sizeof(jpgRestart))}) {
+            memset(buffer, 0, sizeof(buffer));
+            auto picture = Picture::gen();
+            REQUIRE(_loadJpg(picture.get(), jpg));
+            REQUIRE(canvas->push(move(picture)) == Result::Success);
+            REQUIRE(canvas->draw() == Result::Success);
+            REQUIRE(canvas->sync() == Result::Success);
+            REQUIRE(canvas->clear() == Result::Success);
+            _checkQuarters(buffer, 16, 16);
+        }
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+TEST_CASE("Jpg Hostile Data", "[tvgPicture]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    uint32_t w, h;
+
+    SECTION("Huge Size") {
+        for (auto jpg : {_jpg(jpgBaseline, sizeof(jpgBaseline)), _jpg(jpgProgressive, sizeof(jpgProgressive))}) {
+            auto sof = _segment(jpg, 0xc0);
+            if (sof == std::string::npos) sof = _segment(jpg, 0xc2);
+            REQUIRE(sof != std::string::npos);
+            //65535 x 65535, rejected before allocating the samples.
+            for (auto i = sof + 5; i < sof + 9; ++i) jpg[i] = '\xff';
+            auto picture = Picture::gen();
+            REQUIRE(!_loadJpg(picture.get(), jpg));
+        }
+    }
+
+    SECTION("Truncated") {
+        for (auto jpg : {_jpg(jpgBaseline, sizeof(jpgBaseline)), _jpg(jpgProgressive, sizeof(jpgProgressive)), _jpg(jpgRestart, sizeof(jpgRestart))}) {
+            auto scan = _segment(jpg, 0xda);
+            REQUIRE(scan != std::string::npos);
+            //Past the header of the first scan, its entropy coded data
+            scan += 2 + _length(jpg, scan);
+
+            for (size_t size = 0; size < jpg.size(); ++size) {
+                auto picture = Picture::gen();
+                auto loaded = _loadJpg(picture.get(), jpg.substr(0, size));
+                auto pixels = loaded ? picture->data(&w, &h) : nullptr;
+                //The decoded part is shown once the first scan has data.
+                if (size > scan) {
+                    REQUIRE(pixels);
+                    REQUIRE(w == 16);
+                    REQUIRE(h == 16);
+                } else REQUIRE(!pixels);
+            }
+        }
+    }
+
+    SECTION("Corrupt Segments") {
+        auto jpg = _jpg(jpgBaseline, sizeof(jpgBaseline));
+        auto dqt = _segment(jpg, 0xdb);
+        auto dht = _segment(jpg, 0xc4);
+        auto sof = _segment(jpg, 0xc0);
+        auto sos = _segment(jpg, 0xda);
+        REQUIRE(dqt != std::string::npos);
+        REQUIRE(dht != std::string::npos);
+        REQUIRE(sof != std::string::npos);
+        REQUIRE(sos != std::string::npos);
+
+        //offset, the broken byte
+        struct { size_t at; char value; } cases[] = {
+            {dqt + 2, '\x7f'},     //segment length beyond the data
+            {dqt + 4, '\x14'},     //table id 4
+            {dht + 4, '\x24'},     //table class 2
+            {dht + 5, '\xff'},     //more codes of length 1 than the length can have
+            {sof + 4, '\x0c'},     //12 bits precision
+            {sof + 9, '\x02'},     //2 components
+            {sof + 11, '\x55'},    //sampling factors 5
+            {sof + 12, '\x04'},    //quantization table 4
+            {sos + 4, '\x04'},     //4 components in the scan
+            {sos + 6, '\x44'},     //huffman tables 4
+        };
+
+        for (auto& c : cases) {
+            auto broken = jpg;
+            broken[c.at] = c.value;
+            auto picture = Picture::gen();
+            auto loaded = _loadJpg(picture.get(), broken);
+            REQUIRE(!(loaded && picture->data()));
+        }
+
+        //Whatever the broken byte, it's decoded or rejected safely, also in a reduced level of detail.
+        uint32_t buffer[16 * 16];
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas->target(buffer, 16, 16, 16, SwCanvas::ARGB8888) == Result::Success);
+
+        for (auto source : {_jpg(jpgBaseline, sizeof(jpgBaseline)), _jpg(jpgProgressive, sizeof(jpgProgressive)), _jpg(jpgRestart, sizeof(jpgRestart))}) {
+            for (size_t i = 2; i < source.size(); ++i) {
+                for (auto value : {'\x00', '\x01', '\xd9', '\xff'}) {
+                    auto broken = source;
+                    broken[i] = value;
+                    auto picture = Picture::gen();
+                    if (!_loadJpg(picture.get(), broken)) continue;
+                    auto decoded = (picture->data(&w, &h) != nullptr);
+                    picture->scale(0.25f);
+                    REQUIRE(canvas->push(move(picture)) == Result::Success);
+                    //A picture without pixels fails to draw.
+                    REQUIRE((canvas->draw() == Result::Success) == decoded);
+                    if (decoded) REQUIRE(canvas->sync() == Result::Success);
+                    REQUIRE(canvas->clear() == Result::Success);
+                }
+            }
+        }
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+#endif
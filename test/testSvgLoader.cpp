@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2021 Samsung Electronics Co., Ltd. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <thorvg.h>
+#include <cstring>
+#include <cstdlib>
+#include <clocale>
+#include <string>
+#include <algorithm>
+#include "config.h"
+#include "catch.hpp"
+
+using namespace tvg;
+
+#ifdef THORVG_SVG_LOADER_SUPPORT
+
+//Draws the document in 100x100, returns the number of the drawn pixels.
+static uint32_t _draw(const std::string& svg, uint32_t* buffer)
+{
+    memset(buffer, 0, sizeof(uint32_t) * 100 * 100);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(svg.data(), svg.size(), true) == Result::Success);
+    REQUIRE(canvas->push(move(picture)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    uint32_t drawn = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        if (buffer[i]) ++drawn;
+    }
+    return drawn;
+}
+
+
+TEST_CASE("Svg Arena", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100 * 100], buffer2[100 * 100];
+
+    //Ids longer than any fixed buffer, the gradients cloned by the references
+    std::string longId(200, 'g');
+    auto svg = [](const std::string& id) {
+        std::string doc = "<svg xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\"><defs>"
+                          "<linearGradient id=\"" + id + "\"><stop offset=\"0\" stop-color=\"red\"/><stop offset=\"1\" stop-color=\"blue\"/></linearGradient>"
+                          "<linearGradient id=\"" + id + "2\" xlink:href=\"#" + id + "\" x1=\"0\" y1=\"0\" x2=\"0\" y2=\"1\"/>"
+                          "<rect id=\"" + id + "3\" width=\"20\" height=\"20\" fill=\"url(#" + id + "2)\" transform=\"rotate(10)\"/></defs>"
+                          "<use xlink:href=\"#" + id + "3\" x=\"10\" y=\"10\"/><use xlink:href=\"#" + id + "3\" x=\"60\" y=\"10\"/>"
+                          "<polygon points=\"";
+        //Bigger than a block of the arena
+        for (int i = 0; i < 4000; ++i) doc += std::to_string(50 + (i % 40)) + "," + std::to_string(60 + (i % 30)) + " ";
+        doc += "\" fill=\"url(#" + id + ")\"/>";
+        for (int i = 0; i < 2000; ++i) doc += "<rect x=\"" + std::to_string(i % 90) + "\" y=\"95\" width=\"1\" height=\"1\" fill=\"#00ff00\"/>";
+        return doc + "</svg>";
+    };
+
+    auto drawn = _draw(svg("a"), buffer);
+    REQUIRE(drawn > 0);
+
+    //The same document regardless of the lengths of the ids, loaded again and again
+    for (int i = 0; i < 3; ++i) {
+        REQUIRE(_draw(svg(longId), buffer2) == drawn);
+        REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+    }
+
+    //The entities are decoded before the ids are kept.
+    auto entities = std::string("<svg xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\"><defs><rect id=\"a&amp;b\" width=\"50\" height=\"50\" fill=\"#0000ff\"/></defs>"
+                                "<use xlink:href=\"#a&amp;b\"/></svg>");
+    REQUIRE(_draw(entities, buffer) == 50 * 50);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+TEST_CASE("Svg Id References", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100 * 100], buffer2[100 * 100];
+    const std::string head = "<svg xmlns:xlink=\"http://www.w3.org/1999/xlink\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">";
+
+    //Thousands of the ids, the paints defined before or after their references
+    std::string shapes, paints, refs;
+    for (int i = 0; i < 3000; ++i) {
+        auto id = std::to_string(i);
+        paints += "<linearGradient id=\"g" + id + "\"><stop offset=\"0\" stop-color=\"#" + (i % 2 ? "ff0000" : "0000ff") + "\"/><stop offset=\"1\" stop-color=\"#00ff00\"/></linearGradient>";
+        paints += "<clipPath id=\"c" + id + "\"><rect width=\"100\" height=\"" + std::to_string(10 + i % 80) + "\"/></clipPath>";
+        shapes += "<rect id=\"r" + id + "\" x=\"" + std::to_string(i % 100) + "\" y=\"" + std::to_string(90 + (i / 100) % 10) + "\" width=\"1\" height=\"1\"/>";
+        refs += "<rect x=\"" + std::to_string(i % 100) + "\" width=\"1\" height=\"90\" fill=\"url(#g" + id + ")\" clip-path=\"url(#c" + std::to_string((i + 50) % 3000) + ")\"/>";
+        refs += "<use xlink:href=\"#r" + id + "\"/>";
+    }
+
+    //Each column is clipped by the tallest of its clips, plus the anti-aliased row of the edge
+    uint32_t expected = 0;
+    for (int x = 0; x < 100; ++x) {
+        int h = 0;
+        for (int i = x; i < 3000; i += 100) h = std::max(h, 10 + ((i + 50) % 3000) % 80);
+        expected += h + 1 + 10;
+    }
+
+    auto drawn = _draw(head + "<defs>" + paints + shapes + "</defs>" + refs + "</svg>", buffer);
+    REQUIRE(drawn == expected);
+    REQUIRE(_draw(head + "<defs>" + shapes + "</defs>" + refs + "<defs>" + paints + "</defs></svg>", buffer2) == drawn);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    //The first one in the document order is referred by the duplicated ids.
+    const std::string duplicated = "<defs><rect id=\"d\" width=\"50\" height=\"50\" fill=\"#0000ff\"/><g><rect id=\"d\" width=\"100\" height=\"100\" fill=\"#ff0000\"/></g>"
+                                   "<linearGradient id=\"e\"><stop offset=\"0\" stop-color=\"#0000ff\"/></linearGradient><linearGradient id=\"e\"><stop offset=\"0\" stop-color=\"#ff0000\"/></linearGradient></defs>";
+    REQUIRE(_draw(head + duplicated + "<use xlink:href=\"#d\"/></svg>", buffer) == 50 * 50);
+    REQUIRE(buffer[0] == 0xff0000ff);
+    REQUIRE(_draw(head + duplicated + "<rect width=\"10\" height=\"10\" fill=\"url(#e)\"/></svg>", buffer) == 10 * 10);
+    REQUIRE(buffer[0] == 0xff0000ff);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Svg Tokenizer", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100 * 100], buffer2[100 * 100];
+
+    const std::string plain = "<svg width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">"
+                              "<rect x=\"10\" y=\"10\" width=\"30\" height=\"30\" fill=\"#ff0000\"/>"
+                              "<path d=\"M 50 50 L 90 50 L 90 90 Z\" fill=\"#0000ff\" stroke=\"#00ff00\" stroke-width=\"2\"/></svg>";
+    auto drawn = _draw(plain, buffer);
+    REQUIRE(drawn > 0);
+
+    //The same document in the quotes, spaces, tabs and the line breaks, longer than the scanned blocks
+    const std::string blanks = " \t\r\n                    \t\t\n";
+    const std::string formatted = "<svg\twidth = '100'" + blanks + "height\n=\n\"100\"" + blanks + "viewBox= \"0 0 100 100\" >" + blanks +
+                                  "<rect" + blanks + "x='10'\ty=\t'10'" + blanks + "width =\"30\"\r\nheight= '30'" + blanks + "fill='#ff0000'" + blanks + "/>"
+                                  "<path d=\"M 50 50" + blanks + "L 90 50 L 90 90 Z\"" + blanks + "fill  =  \"#0000ff\" stroke='#00ff00'\nstroke-width=2/></svg>";
+    REQUIRE(_draw(formatted, buffer2) == drawn);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Svg Numbers", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    //Correctly rounded as strtof() of the "C" locale, in any locale
+    const char* numbers[] = {"123.456789", "98.7654321", "5.", "0.1", "1e2", "1.5E+1", "16777217", "3.4028234e+38", "1.9478871241e+36", "0.000123456789e6", "2.5000000000000000001"};
+
+    auto test = [&]() {
+        for (auto number : numbers) {
+            std::string svg = std::string("<svg width=\"") + number + "\" height=\"" + number + "\" viewBox=\"0 0 " + number + " " + number + "\"></svg>";
+            auto picture = Picture::gen();
+            REQUIRE(picture->load(svg.data(), svg.size(), true) == Result::Success);
+            float w, h;
+            REQUIRE(picture->size(&w, &h) == Result::Success);
+            auto expected = strtof(number, nullptr);
+            REQUIRE(memcmp(&w, &expected, sizeof(float)) == 0);
+            REQUIRE(memcmp(&h, &expected, sizeof(float)) == 0);
+        }
+    };
+    test();
+
+    //The locales using the comma as the decimal separator
+    auto prev = std::string(setlocale(LC_NUMERIC, nullptr));
+    for (auto locale : {"de_DE.UTF-8", "de_DE", "fr_FR.UTF-8", "ru_RU.UTF-8"}) {
+        if (!setlocale(LC_NUMERIC, locale)) continue;
+        test();
+        break;
+    }
+    setlocale(LC_NUMERIC, prev.c_str());
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Svg Single Pass", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100 * 100], buffer2[100 * 100];
+
+    //Without the references the paints are built while parsing
+    const std::string body = "<svg width=\"100\" height=\"100\" viewBox=\"0 0 200 200\">"
+                             "<g fill=\"#ff0000\" stroke=\"#0000ff\" stroke-width=\"4\" transform=\"translate(10 10)\" opacity=\"0.8\">"
+                             "<rect width=\"60\" height=\"40\" rx=\"8\"/><circle cx=\"100\" cy=\"30\" r=\"25\" style=\"fill:#00ff00; stroke-dasharray:5 3\"/>"
+                             "<g transform=\"rotate(15) scale(1.2)\" fill-opacity=\"0.5\"><ellipse cx=\"50\" cy=\"100\" rx=\"30\" ry=\"15\"/>"
+                             "<polygon points=\"100,80 140,120 90,130\" fill-rule=\"evenodd\"/><polyline points=\"10,150 40,170 70,150\" fill=\"none\"/></g>"
+                             "<line x1=\"0\" y1=\"180\" x2=\"180\" y2=\"180\" stroke-linecap=\"round\"/>"
+                             "<path d=\"M120 140 c10 -20 40 -20 50 0 s-20 40 -25 40 z\" stroke=\"none\"/></g>";
+    auto drawn = _draw(body + "</svg>", buffer);
+    REQUIRE(drawn > 0);
+
+    //The same document through the node tree, forced by the definitions
+    REQUIRE(_draw(body + "<defs></defs></svg>", buffer2) == drawn);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+TEST_CASE("Svg Image Aspect Ratio", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100 * 100];
+
+    //20x10: red on the left, blue on the right half
+    const std::string href = "data:image/svg+xml,%3Csvg xmlns='http://www.w3.org/2000/svg' width='20' height='10'%3E"
+                             "%3Crect width='10' height='10' fill='red'/%3E%3Crect x='10' width='10' height='10' fill='blue'/%3E%3C/svg%3E";
+    auto image = [&](const char* aspect) {
+        return std::string("<svg width=\"100\" height=\"100\"><image width=\"60\" height=\"60\" preserveAspectRatio=\"") + aspect + "\" href=\"" + href + "\"/></svg>";
+    };
+    auto pixel = [&](uint32_t x, uint32_t y) { return buffer[y * 100 + x]; };
+    const uint32_t red = 0xffff0000, blue = 0xff0000ff;
+
+    //60x30, in the middle by default
+    for (auto aspect : {"xMidYMid", "xMidYMid meet", "defer xMidYMid", "xMidYMid bogus", "fill"}) {
+        REQUIRE(_draw(image(aspect), buffer) == 60 * 30);
+        REQUIRE(pixel(10, 30) == red);
+        REQUIRE(pixel(50, 30) == blue);
+        REQUIRE(pixel(10, 10) == 0);
+    }
+
+    REQUIRE(_draw(image("xMinYMin meet"), buffer) == 60 * 30);
+    REQUIRE(pixel(10, 5) == red);
+    REQUIRE(pixel(10, 40) == 0);
+
+    REQUIRE(_draw(image("xMaxYMax"), buffer) == 60 * 30);
+    REQUIRE(pixel(10, 55) == red);
+    REQUIRE(pixel(10, 20) == 0);
+
+    //Stretched
+    REQUIRE(_draw(image("none"), buffer) == 60 * 60);
+    REQUIRE(pixel(10, 5) == red);
+    REQUIRE(pixel(50, 55) == blue);
+
+    //120x60, clipped to the viewport. The rectangle clip rounds its size up by a pixel.
+    REQUIRE(_draw(image("xMidYMid slice"), buffer) <= 61 * 61);
+    REQUIRE(pixel(20, 30) == red);
+    REQUIRE(pixel(40, 30) == blue);
+    REQUIRE(pixel(61, 30) == 0);
+    REQUIRE(pixel(80, 30) == 0);
+
+    REQUIRE(_draw(image("xMinYMax slice"), buffer) <= 61 * 61);
+    REQUIRE(pixel(55, 55) == red);
+    REQUIRE(pixel(61, 55) == 0);
+
+    REQUIRE(_draw(image("xMaxYMin slice"), buffer) <= 61 * 61);
+    REQUIRE(pixel(5, 5) == blue);
+    REQUIRE(pixel(59, 5) == blue);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+
+TEST_CASE("Svg Style Rules", "[tvgSvgLoader]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100 * 100];
+
+    const std::string svg = "<svg width=\"100\" height=\"100\"><style>"
+                            "/* comment { fill: red } */ @media print { rect { fill: red } }"
+                            "rect { fill: #0000ff }"
+                            "#i { fill: #00ff00 } .a { fill: #ff0000 } .b { fill: #ffff00 }"
+                            ".c { fill: #ff0000 } .c { fill: #00ff00 }"
+                            "rect.a.b { fill: #00ffff } .d, .e { fill: #ff00ff }"
+                            "circle { fill: #ff0000 } .bad > rect { fill: #ff0000 }"
+                            "</style>"
+                            "<rect x=\"0\" width=\"10\" height=\"10\"/>"                               //type
+                            "<rect x=\"10\" width=\"10\" height=\"10\" class=\"a\"/>"                   //class over type
+                            "<rect x=\"20\" width=\"10\" height=\"10\" class=\"a\" id=\"i\"/>"          //id over the later class
+                            "<rect x=\"30\" width=\"10\" height=\"10\" class=\"c\"/>"                   //the later rule of the same specificity
+                            "<rect x=\"40\" width=\"10\" height=\"10\" class=\" b  a \"/>"              //compound selector
+                            "<rect x=\"50\" width=\"10\" height=\"10\" class=\"e\"/>"                   //selector list
+                            "<rect x=\"60\" width=\"10\" height=\"10\" id=\"i\" style=\"fill:#ffffff\"/>" //inline style over id
+                            "<rect x=\"70\" width=\"10\" height=\"10\" class=\"a\" fill=\"#00ff00\"/>"  //rule over attribute
+                            "<rect x=\"80\" width=\"10\" height=\"10\" style=\"class:a\"/>"             //not a class
+                            "<g class=\"b\"><rect x=\"90\" width=\"10\" height=\"10\"/></g>"            //inherited below the type rule
+                            "</svg>";
+
+    REQUIRE(_draw(svg, buffer) == 100 * 10);
+
+    const uint32_t expected[] = {0xff0000ff, 0xffff0000, 0xff00ff00, 0xff00ff00, 0xff00ffff, 0xffff00ff, 0xffffffff, 0xffff0000, 0xff0000ff, 0xff0000ff};
+    for (uint32_t i = 0; i < 10; ++i) {
+        REQUIRE(buffer[5 * 100 + i * 10 + 5] == expected[i]);
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+#endif
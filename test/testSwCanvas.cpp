@@ -21,6 +21,8 @@
  */
 
 #include <thorvg.h>
+#include <cmath>
+#include <cstring>
 #include "catch.hpp"
 
 using namespace tvg;
@@ -93,3 +95,754 @@ TEST_CASE("Memory Pool", "[tvgSwCanvas]")
 
     REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
 }
+
+//A convex arc, its length is 333.39 and the area it closes with its chord is 16350.
+static float _drawArc(uint32_t* buffer, float tolerance, float strokeWidth, bool dashed)
+{
+    memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    if (tolerance > 0.0f) REQUIRE(canvas->flatness(tolerance) == Result::Success);
+
+    auto shape = Shape::gen();
+    REQUIRE(shape);
+    REQUIRE(shape->moveTo(20, 190) == Result::Success);
+    REQUIRE(shape->cubicTo(30, 10, 190, 30, 180, 190) == Result::Success);
+    if (strokeWidth > 0.0f) {
+        REQUIRE(shape->stroke(strokeWidth) == Result::Success);
+        REQUIRE(shape->stroke(StrokeCap::Butt) == Result::Success);
+        REQUIRE(shape->stroke(255, 255, 255, 255) == Result::Success);
+        float pattern[] = {20, 20};
+        if (dashed) REQUIRE(shape->stroke(pattern, 2) == Result::Success);
+    } else {
+        REQUIRE(shape->close() == Result::Success);
+        REQUIRE(shape->fill(255, 255, 255, 255) == Result::Success);
+    }
+    REQUIRE(canvas->push(move(shape)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    //The covered area in pixels
+    auto coverage = 0.0f;
+    for (int i = 0; i < 200 * 200; ++i) coverage += (buffer[i] >> 24) / 255.0f;
+    return coverage;
+}
+
+
+//The lengths along the arc where its stroke turns on or off, sampled on its center line.
+static uint32_t _dashEnds(const uint32_t* buffer, float* ends, uint32_t max)
+{
+    const Point pts[] = {{20, 190}, {30, 10}, {190, 30}, {180, 190}};
+    auto cnt = 0U;
+    auto on = true;
+    auto len = 0.0;
+    auto prev = pts[0];
+    for (int i = 1; i <= 10000 && cnt < max; ++i) {
+        auto t = i / 10000.0f;
+        auto mt = 1.0f - t;
+        Point pt = {mt * mt * mt * pts[0].x + 3 * mt * mt * t * pts[1].x + 3 * mt * t * t * pts[2].x + t * t * t * pts[3].x,
+                    mt * mt * mt * pts[0].y + 3 * mt * mt * t * pts[1].y + 3 * mt * t * t * pts[2].y + t * t * t * pts[3].y};
+        len += hypotf(pt.x - prev.x, pt.y - prev.y);
+        prev = pt;
+        auto inked = (buffer[static_cast<int>(pt.y) * 200 + static_cast<int>(pt.x)] >> 24) > 127;
+        if (inked != on) {
+            ends[cnt++] = static_cast<float>(len);
+            on = inked;
+        }
+    }
+    //The end of the last dash
+    if (on && cnt < max) ends[cnt++] = static_cast<float>(len);
+    return cnt;
+}
+
+
+TEST_CASE("Flatness", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[200*200], coarse[200*200], fine[200*200];
+    const auto length = 333.39f;
+
+    //Filled, the rasterizer splits the arc
+    {
+        auto area = 16350.0f;
+        auto cov = _drawArc(buffer, 0.0f, 0.0f, false);
+        REQUIRE(fabsf(cov - area) < length / 6.0f);
+
+        //The chords of a convex arc cut into it, by the tolerance at most.
+        auto coarseCov = _drawArc(coarse, 2.0f, 0.0f, false);
+        REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) != 0);
+        REQUIRE(coarseCov < cov);
+        REQUIRE(area - coarseCov < length * 2.0f);
+
+        auto fineCov = _drawArc(fine, 1.0f / 64.0f, 0.0f, false);
+        REQUIRE(memcmp(buffer, fine, sizeof(buffer)) != 0);
+        REQUIRE(fabsf(fineCov - area) < length / 64.0f);
+    }
+
+    //Stroked, the stroker splits the arc and the rasterizer its borders
+    {
+        auto area = length * 20.0f;
+        auto cov = _drawArc(buffer, 0.0f, 20.0f, false);
+        REQUIRE(fabsf(cov - area) < 2.0f * length / 6.0f);
+
+        auto coarseCov = _drawArc(coarse, 2.0f, 20.0f, false);
+        REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) != 0);
+        REQUIRE(fabsf(coarseCov - area) < 2.0f * length * 2.0f);
+
+        auto fineCov = _drawArc(fine, 1.0f / 64.0f, 20.0f, false);
+        REQUIRE(memcmp(buffer, fine, sizeof(buffer)) != 0);
+        REQUIRE(fabsf(fineCov - area) < 2.0f * length / 64.0f);
+
+        //The rasterizer halves the arc as many times with 1 and 2, the stroker's pieces still differ.
+        _drawArc(buffer, 1.0f, 0.0f, false);
+        _drawArc(coarse, 2.0f, 0.0f, false);
+        REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) == 0);
+        _drawArc(buffer, 1.0f, 20.0f, false);
+        _drawArc(coarse, 2.0f, 20.0f, false);
+        REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) != 0);
+    }
+
+    //Dashed, the dasher measures the arc as well: 173.39 of it is on.
+    {
+        auto area = 173.39f * 20.0f;
+        auto cov = _drawArc(buffer, 0.0f, 20.0f, true);
+        REQUIRE(fabsf(cov - area) < 2.0f * length / 6.0f);
+
+        auto coarseCov = _drawArc(coarse, 2.0f, 20.0f, true);
+        REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) != 0);
+        REQUIRE(fabsf(coarseCov - area) < 2.0f * length * 2.0f);
+
+        auto fineCov = _drawArc(fine, 1.0f / 64.0f, 20.0f, true);
+        REQUIRE(memcmp(buffer, fine, sizeof(buffer)) != 0);
+        REQUIRE(fabsf(fineCov - area) < 2.0f * length / 64.0f);
+
+        //The dashes and the gaps alternate every 20 along the arc, even measured coarsely.
+        for (auto tolerance : {0.0f, 2.0f, 16.0f}) {
+            _drawArc(buffer, tolerance, 4.0f, true);
+            float ends[32];
+            auto cnt = _dashEnds(buffer, ends, 32);
+            REQUIRE(cnt == 17);
+            for (uint32_t i = 0; i < cnt - 1; ++i) {
+                REQUIRE(fabsf(ends[i] - 20.0f * (i + 1)) < 1.0f);
+            }
+        }
+    }
+
+    //Finer than the sub-pixels is clamped
+    _drawArc(fine, 1.0f / 64.0f, 0.0f, false);
+    _drawArc(buffer, 0.000001f, 0.0f, false);
+    REQUIRE(memcmp(buffer, fine, sizeof(buffer)) == 0);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto shape = Shape::gen();
+    REQUIRE(shape);
+    REQUIRE(shape->moveTo(20, 190) == Result::Success);
+    REQUIRE(shape->cubicTo(30, 10, 190, 30, 180, 190) == Result::Success);
+    REQUIRE(shape->close() == Result::Success);
+    REQUIRE(shape->fill(255, 255, 255, 255) == Result::Success);
+    REQUIRE(canvas->push(move(shape)) == Result::Success);
+
+    //Allowed with the paints, they are updated again.
+    _drawArc(coarse, 2.0f, 0.0f, false);
+    memset(buffer, 0, sizeof(buffer));
+    REQUIRE(canvas->flatness(2.0f) == Result::Success);
+    REQUIRE(canvas->update(nullptr) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) == 0);
+
+    //The invalid ones are rejected, the previous one is kept.
+    REQUIRE(canvas->flatness(0.0f) == Result::InvalidArguments);
+    REQUIRE(canvas->flatness(-1.0f) == Result::InvalidArguments);
+    REQUIRE(canvas->flatness(NAN) == Result::InvalidArguments);
+    REQUIRE(canvas->flatness(INFINITY) == Result::InvalidArguments);
+    REQUIRE(canvas->flatness(-INFINITY) == Result::InvalidArguments);
+
+    memset(buffer, 0, sizeof(buffer));
+    REQUIRE(canvas->update(nullptr) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(memcmp(buffer, coarse, sizeof(buffer)) == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Dash Lengths", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[200*200];
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    //A line of 170 along the slope estimated with the largest error
+    const float length = 170.0f;
+    const Point from = {10.0f, 30.0f};
+    Point dir = {1.0f, 0.375f};
+    auto norm = sqrtf(dir.x * dir.x + dir.y * dir.y);
+    dir = {dir.x / norm, dir.y / norm};
+
+    auto shape = Shape::gen();
+    REQUIRE(shape);
+    REQUIRE(shape->moveTo(from.x, from.y) == Result::Success);
+    REQUIRE(shape->lineTo(from.x + dir.x * length, from.y + dir.y * length) == Result::Success);
+    REQUIRE(shape->stroke(4.0f) == Result::Success);
+    REQUIRE(shape->stroke(StrokeCap::Butt) == Result::Success);
+    REQUIRE(shape->stroke(255, 255, 255, 255) == Result::Success);
+    float pattern[] = {20, 20};
+    REQUIRE(shape->stroke(pattern, 2, 5.0f) == Result::Success);
+    REQUIRE(canvas->push(move(shape)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    //The dashes turn on and off every 20 after the offset, to the end of the line.
+    auto on = true;
+    auto cnt = 0;
+    auto misses = 0;
+    for (int i = 1; i < 16900; ++i) {
+        auto len = i / 100.0f;
+        auto inked = (buffer[static_cast<int>(from.y + dir.y * len) * 200 + static_cast<int>(from.x + dir.x * len)] >> 24) > 127;
+        if (inked == on) continue;
+        if (fabsf(len - (15.0f + 20.0f * cnt)) > 1.0f) ++misses;
+        on = inked;
+        ++cnt;
+    }
+    REQUIRE(cnt == 8);
+    REQUIRE(misses == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+//The wavy rings of many points in the view, with the odd counts per contour. The far contour is clipped off.
+static void _drawWavy(uint32_t* buffer, bool far)
+{
+    memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto shape = Shape::gen();
+    REQUIRE(shape);
+    auto failed = 0;
+    for (int c = 0; c < 3; ++c) {
+        auto radius = 40.0f + c * 25.0f;
+        REQUIRE(shape->moveTo(radius, 0.0f) == Result::Success);
+        for (int i = 1; i < 1001 + c * 2; ++i) {
+            auto angle = i * 2.0f * 3.14159265f / (1001 + c * 2);
+            auto r = radius + 7.3f * sinf(angle * 23.0f);
+            if (shape->lineTo(r * cosf(angle), r * sinf(angle)) != Result::Success) ++failed;
+        }
+        REQUIRE(shape->close() == Result::Success);
+    }
+    REQUIRE(failed == 0);
+    REQUIRE(shape->moveTo(5.5f, -3.3f) == Result::Success);
+    REQUIRE(shape->cubicTo(30.3f, 10.7f, -20.1f, 60.9f, -15.5f, 3.3f) == Result::Success);
+    if (far) {
+        REQUIRE(shape->moveTo(5000.0f, 5000.0f) == Result::Success);
+        REQUIRE(shape->lineTo(5100.0f, 5000.0f) == Result::Success);
+        REQUIRE(shape->lineTo(5000.0f, 5100.0f) == Result::Success);
+        REQUIRE(shape->close() == Result::Success);
+    }
+    REQUIRE(shape->fill(FillRule::EvenOdd) == Result::Success);
+    REQUIRE(shape->fill(255, 255, 255, 255) == Result::Success);
+    REQUIRE(shape->stroke(1.7f) == Result::Success);
+    REQUIRE(shape->stroke(255, 0, 0, 128) == Result::Success);
+    REQUIRE(shape->scale(0.93f) == Result::Success);
+    REQUIRE(shape->rotate(17.5f) == Result::Success);
+    REQUIRE(shape->translate(100.4f, 99.7f) == Result::Success);
+    REQUIRE(canvas->push(move(shape)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+}
+
+
+TEST_CASE("Outline Transform", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t batched[200*200], clipped[200*200];
+
+    //The points in the view are transformed at once, the far contour sends all of them to the clipping one by one.
+    _drawWavy(batched, false);
+    _drawWavy(clipped, true);
+
+    auto drawn = 0;
+    for (int i = 0; i < 200 * 200; ++i) {
+        if (batched[i]) ++drawn;
+    }
+    REQUIRE(drawn > 10000);
+    REQUIRE(memcmp(batched, clipped, sizeof(batched)) == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Far Coordinates", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t buffer[100*100];
+
+    //Beyond the 16 bits of the pixels, and beyond the saturation of the 26.6 as well
+    for (auto far : {1.0e5f, 1.0e8f, 1.0e12f}) {
+        memset(buffer, 0, sizeof(buffer));
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas);
+        REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+        //The half plane below the diagonal, its corners are far away.
+        auto plane = Shape::gen();
+        REQUIRE(plane);
+        REQUIRE(plane->moveTo(-far, -far) == Result::Success);
+        REQUIRE(plane->lineTo(far, far) == Result::Success);
+        REQUIRE(plane->lineTo(-far, far) == Result::Success);
+        REQUIRE(plane->close() == Result::Success);
+        REQUIRE(plane->fill(0, 0, 255, 255) == Result::Success);
+        REQUIRE(canvas->push(move(plane)) == Result::Success);
+
+        //A horizontal band of a line from far to far
+        auto line = Shape::gen();
+        REQUIRE(line);
+        REQUIRE(line->moveTo(-far, 20.0f) == Result::Success);
+        REQUIRE(line->lineTo(far, 20.0f) == Result::Success);
+        REQUIRE(line->stroke(10.0f) == Result::Success);
+        REQUIRE(line->stroke(255, 0, 0, 255) == Result::Success);
+        REQUIRE(canvas->push(move(line)) == Result::Success);
+
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+
+        //The edges keep their directions, the pixels off them are filled or not.
+        auto misses = 0;
+        for (int y = 0; y < 100; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                auto color = buffer[y * 100 + x];
+                if (y >= 16 && y < 24) {
+                    if (color != 0xffff0000) ++misses;
+                } else if (y < 14 || y >= 26) {
+                    auto d = y - x;
+                    if (d > 1 && color != 0xff0000ff) ++misses;
+                    if (d < -1 && color != 0) ++misses;
+                }
+            }
+        }
+        REQUIRE(misses == 0);
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Rasterizer", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    uint32_t buffer[3][100*100] = {};
+
+    const SwCanvas::RasterizerPolicy policies[] = {SwCanvas::RasterizerPolicy::Cells, SwCanvas::RasterizerPolicy::Accumulation, SwCanvas::RasterizerPolicy::Aliased};
+
+    for (int i = 0; i < 3; ++i) {
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas);
+        REQUIRE(canvas->target(buffer[i], 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+        REQUIRE(canvas->rasterizer(static_cast<SwCanvas::RasterizerPolicy>(4)) == Result::InvalidArguments);
+        REQUIRE(canvas->rasterizer(SwCanvas::RasterizerPolicy::Auto) == Result::Success);
+
+        //A star of the crossing edges
+        const Point star[] = {{95.0f, 50.0f}, {9.5f, 69.5f}, {78.1f, 14.8f}, {40.0f, 93.9f}, {40.0f, 6.1f}, {78.1f, 85.2f}, {9.5f, 30.5f}};
+        auto shape = Shape::gen();
+        REQUIRE(shape);
+        REQUIRE(shape->moveTo(star[0].x, star[0].y) == Result::Success);
+        for (int j = 1; j < 7; ++j) {
+            REQUIRE(shape->lineTo(star[j].x, star[j].y) == Result::Success);
+        }
+        REQUIRE(shape->close() == Result::Success);
+        REQUIRE(shape->appendCircle(50, 50, 20, 20) == Result::Success);
+        REQUIRE(shape->fill(FillRule::EvenOdd) == Result::Success);
+        REQUIRE(shape->fill(255, 255, 255, 255) == Result::Success);
+        REQUIRE(canvas->push(move(shape)) == Result::Success);
+
+        //Allowed with the paints, they are updated again.
+        REQUIRE(canvas->rasterizer(policies[i]) == Result::Success);
+        REQUIRE(canvas->update(nullptr) == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+    }
+
+    //The engines differ in the rounding only.
+    auto maxDiff = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        auto diff = static_cast<int>(buffer[0][i] & 0xff) - static_cast<int>(buffer[1][i] & 0xff);
+        if (diff < 0) diff = -diff;
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    REQUIRE(maxDiff <= 3);
+
+    //The aliased one fills every pixel the path touches, fully.
+    auto partials = 0;
+    auto misses = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        auto aliased = buffer[2][i] & 0xff;
+        if (aliased != 0 && aliased != 255) ++partials;
+        if ((buffer[0][i] & 0xff) && aliased != 255) ++misses;
+    }
+    REQUIRE(partials == 0);
+    REQUIRE(misses == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Primitives", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    uint32_t buffer[2][100*100] = {};
+
+    const SwCanvas::RasterizerPolicy policies[] = {SwCanvas::RasterizerPolicy::Auto, SwCanvas::RasterizerPolicy::Cells};
+
+    for (int i = 0; i < 2; ++i) {
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas);
+        REQUIRE(canvas->target(buffer[i], 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        REQUIRE(canvas->rasterizer(policies[i]) == Result::Success);
+        REQUIRE(canvas->flatness(0.01f) == Result::Success);
+
+        //The analytic ones with Auto
+        auto rect = Shape::gen();
+        REQUIRE(rect);
+        REQUIRE(rect->appendRect(10.3f, 5.6f, 50.5f, 30.2f, 0.0f, 0.0f) == Result::Success);
+        REQUIRE(rect->fill(255, 255, 255, 255) == Result::Success);
+        REQUIRE(rect->scale(0.9f) == Result::Success);
+        REQUIRE(canvas->push(move(rect)) == Result::Success);
+
+        auto ellipse = Shape::gen();
+        REQUIRE(ellipse);
+        REQUIRE(ellipse->appendRect(65.3f, 5.6f, 30.2f, 20.5f, 15.1f, 10.25f) == Result::Success);
+        REQUIRE(ellipse->fill(255, 255, 255, 255) == Result::Success);
+        REQUIRE(canvas->push(move(ellipse)) == Result::Success);
+
+        auto circle = Shape::gen();
+        REQUIRE(circle);
+        REQUIRE(circle->appendCircle(75.2f, 65.7f, 15.5f, 15.5f) == Result::Success);
+        REQUIRE(circle->fill(255, 255, 255, 255) == Result::Success);
+        REQUIRE(circle->translate(-2.5f, 3.0f) == Result::Success);
+        REQUIRE(canvas->push(move(circle)) == Result::Success);
+
+        //Not a primitive anymore
+        auto path = Shape::gen();
+        REQUIRE(path);
+        REQUIRE(path->appendRect(10.7f, 50.2f, 40.0f, 40.0f, 10.0f, 10.0f) == Result::Success);
+        REQUIRE(path->lineTo(5.0f, 95.0f) == Result::Success);
+        REQUIRE(path->close() == Result::Success);
+        REQUIRE(path->fill(255, 255, 255, 255) == Result::Success);
+        REQUIRE(canvas->push(move(path)) == Result::Success);
+
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+    }
+
+    //The exact arcs differ from the flattened ones a little.
+    auto maxDiff = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        auto diff = static_cast<int>(buffer[0][i] & 0xff) - static_cast<int>(buffer[1][i] & 0xff);
+        if (diff < 0) diff = -diff;
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    REQUIRE(maxDiff <= 12);
+
+    //The rounded corners keep their half radius handles, they are drawn by the path.
+    auto rounded = Shape::gen();
+    REQUIRE(rounded);
+    REQUIRE(rounded->appendRect(10.0f, 20.0f, 50.0f, 40.0f, 8.0f, 6.0f) == Result::Success);
+
+    const Point* pts;
+    REQUIRE(rounded->pathCoords(&pts) == 17);
+    REQUIRE(pts[2].x == 56.0f);
+    REQUIRE(pts[2].y == 20.0f);
+    REQUIRE(pts[3].x == 60.0f);
+    REQUIRE(pts[3].y == 23.0f);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+//The thin strokes: the smooth ones are drawn with the thin lines, the triangle of the sharp joins with the stroker.
+static void _drawThin(uint32_t* buffer, StrokeCap cap)
+{
+    memset(buffer, 0, sizeof(uint32_t) * 100 * 100);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    REQUIRE(canvas->flatness(0.01f) == Result::Success);
+
+    auto wave = Shape::gen();
+    REQUIRE(wave);
+    REQUIRE(wave->moveTo(5.3f, 30.2f) == Result::Success);
+    REQUIRE(wave->cubicTo(30.0f, 15.0f, 60.0f, 40.0f, 95.4f, 28.7f) == Result::Success);
+    REQUIRE(wave->moveTo(20.0f, 40.0f) == Result::Success);
+    REQUIRE(wave->cubicTo(30.0f, 55.0f, 18.0f, 70.0f, 22.0f, 95.0f) == Result::Success);
+    REQUIRE(wave->stroke(1.0f) == Result::Success);
+
+    auto line = Shape::gen();
+    REQUIRE(line);
+    REQUIRE(line->moveTo(40.0f, 95.0f) == Result::Success);
+    REQUIRE(line->lineTo(95.0f, 70.0f) == Result::Success);
+    REQUIRE(line->stroke(1.5f) == Result::Success);
+
+    auto triangle = Shape::gen();
+    REQUIRE(triangle);
+    REQUIRE(triangle->moveTo(55.0f, 50.0f) == Result::Success);
+    REQUIRE(triangle->lineTo(95.0f, 54.0f) == Result::Success);
+    REQUIRE(triangle->lineTo(55.0f, 58.0f) == Result::Success);
+    REQUIRE(triangle->close() == Result::Success);
+    REQUIRE(triangle->stroke(1.5f) == Result::Success);
+    REQUIRE(triangle->stroke(StrokeJoin::Bevel) == Result::Success);
+
+    for (auto shape : {wave.get(), line.get(), triangle.get()}) {
+        REQUIRE(shape->stroke(cap) == Result::Success);
+        REQUIRE(shape->stroke(255, 255, 255, 255) == Result::Success);
+    }
+    REQUIRE(canvas->push(move(wave)) == Result::Success);
+    REQUIRE(canvas->push(move(line)) == Result::Success);
+    REQUIRE(canvas->push(move(triangle)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+}
+
+
+//Paths running far beyond the view: the filled star and curves, the stroked zigzag turns just outside of it.
+static void _drawOffscreen(uint32_t* buffer, uint32_t size, float ox, float oy)
+{
+    memset(buffer, 0, sizeof(uint32_t) * size * size);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    auto star = Shape::gen();
+    REQUIRE(star);
+    const Point pts[] = {{950.0f, 500.0f}, {95.0f, 695.0f}, {781.0f, 148.0f}, {400.0f, 939.0f}, {400.0f, 61.0f}, {781.0f, 852.0f}, {95.0f, 305.0f}};
+    REQUIRE(star->moveTo(pts[0].x, pts[0].y) == Result::Success);
+    for (int i = 1; i < 7; ++i) {
+        REQUIRE(star->lineTo(pts[i].x, pts[i].y) == Result::Success);
+    }
+    REQUIRE(star->fill(FillRule::EvenOdd) == Result::Success);
+    REQUIRE(star->fill(255, 255, 255, 128) == Result::Success);
+    REQUIRE(star->translate(-ox, -oy) == Result::Success);
+    REQUIRE(canvas->push(move(star)) == Result::Success);
+
+    auto blob = Shape::gen();
+    REQUIRE(blob);
+    REQUIRE(blob->moveTo(20, 480) == Result::Success);
+    REQUIRE(blob->cubicTo(300, -200, 980, 300, 520, 470) == Result::Success);
+    REQUIRE(blob->cubicTo(900, 900, 100, 990, 20, 480) == Result::Success);
+    REQUIRE(blob->fill(255, 0, 0, 128) == Result::Success);
+    REQUIRE(blob->translate(-ox, -oy) == Result::Success);
+    REQUIRE(canvas->push(move(blob)) == Result::Success);
+
+    auto zigzag = Shape::gen();
+    REQUIRE(zigzag);
+    REQUIRE(zigzag->moveTo(10, 440) == Result::Success);
+    for (int i = 1; i < 10; ++i) {
+        REQUIRE(zigzag->lineTo(10.0f + i * 100.0f, (i % 2) ? 560.0f : 440.0f) == Result::Success);
+    }
+    REQUIRE(zigzag->stroke(12) == Result::Success);
+    REQUIRE(zigzag->stroke(StrokeJoin::Miter) == Result::Success);
+    REQUIRE(zigzag->stroke(0, 255, 0, 255) == Result::Success);
+    REQUIRE(zigzag->translate(-ox, -oy) == Result::Success);
+    REQUIRE(canvas->push(move(zigzag)) == Result::Success);
+
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+}
+
+
+TEST_CASE("Thin Strokes", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    uint32_t buffer[2][100*100];
+
+    //The round caps are stroked only, compared beside the ends of the open paths.
+    _drawThin(buffer[0], StrokeCap::Butt);
+    _drawThin(buffer[1], StrokeCap::Round);
+
+    const Point ends[] = {{5.3f, 30.2f}, {95.4f, 28.7f}, {20.0f, 40.0f}, {22.0f, 95.0f}, {40.0f, 95.0f}, {95.0f, 70.0f}};
+    auto maxDiff = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        auto cap = false;
+        for (auto& end : ends) {
+            if (fabsf(i % 100 + 0.5f - end.x) < 2.5f && fabsf(i / 100 + 0.5f - end.y) < 2.5f) cap = true;
+        }
+        if (cap) continue;
+        auto diff = static_cast<int>(buffer[0][i] & 0xff) - static_cast<int>(buffer[1][i] & 0xff);
+        if (diff < 0) diff = -diff;
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    REQUIRE(maxDiff <= 8);
+
+    //The square caps of a line, stroked as its filled rectangle
+    const Point from = {10.2f, 20.3f}, to = {85.7f, 60.1f};
+    auto len = sqrtf((to.x - from.x) * (to.x - from.x) + (to.y - from.y) * (to.y - from.y));
+    Point d = {(to.x - from.x) / len * 0.5f, (to.y - from.y) / len * 0.5f};
+
+    for (int i = 0; i < 2; ++i) {
+        memset(buffer[i], 0, sizeof(buffer[i]));
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas);
+        REQUIRE(canvas->target(buffer[i], 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        auto shape = Shape::gen();
+        REQUIRE(shape);
+        if (i == 0) {
+            REQUIRE(shape->moveTo(from.x, from.y) == Result::Success);
+            REQUIRE(shape->lineTo(to.x, to.y) == Result::Success);
+            REQUIRE(shape->stroke(1.0f) == Result::Success);
+            REQUIRE(shape->stroke(StrokeCap::Square) == Result::Success);
+            REQUIRE(shape->stroke(255, 255, 255, 255) == Result::Success);
+        } else {
+            REQUIRE(shape->moveTo(from.x - d.x + d.y, from.y - d.y - d.x) == Result::Success);
+            REQUIRE(shape->lineTo(to.x + d.x + d.y, to.y + d.y - d.x) == Result::Success);
+            REQUIRE(shape->lineTo(to.x + d.x - d.y, to.y + d.y + d.x) == Result::Success);
+            REQUIRE(shape->lineTo(from.x - d.x - d.y, from.y - d.y + d.x) == Result::Success);
+            REQUIRE(shape->close() == Result::Success);
+            REQUIRE(shape->fill(255, 255, 255, 255) == Result::Success);
+        }
+        REQUIRE(canvas->push(move(shape)) == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+    }
+
+    maxDiff = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        auto diff = static_cast<int>(buffer[0][i] & 0xff) - static_cast<int>(buffer[1][i] & 0xff);
+        if (diff < 0) diff = -diff;
+        if (diff > maxDiff) maxDiff = diff;
+    }
+    REQUIRE(maxDiff <= 8);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Offscreen Pre-Clip", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    static uint32_t whole[1000 * 1000], view[100 * 100];
+
+    //The whole paths in the large canvas, mostly clipped in the small one
+    _drawOffscreen(whole, 1000, 0, 0);
+
+    for (auto origin : {Point{450, 450}, Point{60, 250}, Point{900, 430}, Point{60, 380}}) {
+        _drawOffscreen(view, 100, origin.x, origin.y);
+
+        //The visible pieces start at the rounded split points.
+        auto drawn = 0;
+        auto maxDiff = 0;
+        for (int y = 0; y < 100; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                auto a = view[y * 100 + x];
+                auto b = whole[(y + static_cast<int>(origin.y)) * 1000 + x + static_cast<int>(origin.x)];
+                if (a) ++drawn;
+                for (int shift = 0; shift < 32; shift += 8) {
+                    auto diff = abs(static_cast<int>((a >> shift) & 0xff) - static_cast<int>((b >> shift) & 0xff));
+                    if (diff > maxDiff) maxDiff = diff;
+                }
+            }
+        }
+        REQUIRE(drawn > 0);
+        REQUIRE(maxDiff <= 2);
+    }
+
+    //A stroked frame around the view: the clamped edges of its outline are not visible.
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(view, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    memset(view, 0, sizeof(view));
+
+    auto frame = Shape::gen();
+    REQUIRE(frame);
+    REQUIRE(frame->appendRect(-5000, -3000, 12000, 9000, 0, 0) == Result::Success);
+    REQUIRE(frame->stroke(40) == Result::Success);
+    REQUIRE(frame->stroke(255, 255, 255, 255) == Result::Success);
+    REQUIRE(canvas->push(move(frame)) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    auto drawn = 0;
+    for (int i = 0; i < 100 * 100; ++i) {
+        if (view[i]) ++drawn;
+    }
+    REQUIRE(drawn == 0);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+//A tall path of the crossing edges, the curves and the edges through all the rows.
+static void _drawTall(uint32_t* buffer, uint32_t h, float originY)
+{
+    memset(buffer, 0, sizeof(uint32_t) * 100 * h);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, 100, 100, h, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    REQUIRE(canvas->rasterizer(SwCanvas::RasterizerPolicy::Cells) == Result::Success);
+
+    auto shape = Shape::gen();
+    REQUIRE(shape);
+    REQUIRE(shape->moveTo(10.3f, 2.0f) == Result::Success);
+    REQUIRE(shape->cubicTo(90.0f, 1000.0f, -20.0f, 2500.0f, 60.5f, 3998.0f) == Result::Success);
+    REQUIRE(shape->lineTo(95.0f, 3998.0f) == Result::Success);
+    REQUIRE(shape->cubicTo(40.0f, 2500.0f, 120.0f, 1000.0f, 90.2f, 2.0f) == Result::Success);
+    REQUIRE(shape->close() == Result::Success);
+    REQUIRE(shape->moveTo(20.4f, 5.0f) == Result::Success);
+    REQUIRE(shape->lineTo(80.7f, 3990.0f) == Result::Success);
+    REQUIRE(shape->lineTo(30.1f, 3990.0f) == Result::Success);
+    REQUIRE(shape->close() == Result::Success);
+    for (int i = 0; i < 13; ++i) {
+        REQUIRE(shape->appendCircle(50.0f, 150.3f + 300.0f * i, 30.0f, 25.0f) == Result::Success);
+    }
+    REQUIRE(shape->fill(FillRule::EvenOdd) == Result::Success);
+    REQUIRE(shape->fill(255, 255, 255, 255) == Result::Success);
+    REQUIRE(shape->translate(0.0f, -originY) == Result::Success);
+    REQUIRE(canvas->push(move(shape)) == Result::Success);
+
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+}
+
+TEST_CASE("Bands", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(CanvasEngine::Sw, 0) == Result::Success);
+
+    //Taller than the bands can be, the last one takes the rest of the rows.
+    static uint32_t whole[100 * 4000], view[100 * 80];
+
+    _drawTall(whole, 4000, 0);
+
+    //The views are lower than a band, their edges are not bucketed.
+    for (auto originY : {0, 820, 1700, 2950, 3280, 3320, 3920}) {
+        _drawTall(view, 80, originY);
+
+        auto drawn = 0;
+        auto maxDiff = 0;
+        for (int i = 0; i < 100 * 80; ++i) {
+            auto a = view[i] & 0xff;
+            auto b = whole[originY * 100 + i] & 0xff;
+            if (a) ++drawn;
+            auto diff = abs(static_cast<int>(a) - static_cast<int>(b));
+            if (diff > maxDiff) maxDiff = diff;
+        }
+        REQUIRE(drawn > 0);
+        REQUIRE(maxDiff <= 2);
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}